@@ -8,8 +8,11 @@
  */
 
 #include <common.h>
+#include <fdtdec.h>
+#include <malloc.h>
 #include <asm/system.h>
 #include <asm/armv8/mmu.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -417,6 +420,154 @@ __weak void mmu_setup(void)
 	set_sctlr(get_sctlr() | CR_M);
 }
 
+#if CONFIG_IS_ENABLED(ARMV8_EARLY_CACHES)
+/* Most RAM regions taken from the device tree for the early memory map */
+#define EARLY_MAX_RAM_REGIONS	8
+
+#define EARLY_RAM_ATTRS		(PTE_BLOCK_MEMTYPE(MT_NORMAL) | \
+				 PTE_BLOCK_INNER_SHARE)
+
+/* Add the regions in a node's 'reg' property to the map as normal memory */
+static int early_add_ram(const void *blob, int node, struct mm_region *map,
+			 int count, int max)
+{
+	fdt_addr_t addr;
+	fdt_size_t size;
+	u64 start, end;
+	int i;
+
+	for (i = 0; count < max; i++) {
+		addr = fdtdec_get_addr_size_auto_noparent(blob, node, "reg", i,
+							  &size, true);
+		if (addr == FDT_ADDR_T_NONE)
+			break;
+
+		/* Only map whole pages that are inside the region */
+		start = ALIGN((u64)addr, SZ_4K);
+		end = ((u64)addr + size) & ~(u64)(SZ_4K - 1);
+		if (end <= start)
+			continue;
+		map[count].virt = start;
+		map[count].phys = start;
+		map[count].size = end - start;
+		map[count].attrs = EARLY_RAM_ATTRS;
+		debug("Early RAM region %llx-%llx\n", start, end);
+		count++;
+	}
+
+	return count;
+}
+
+/*
+ * The board's memory map, followed by RAM from the device tree. Later
+ * entries take precedence, so SRAM which the board maps as a device is
+ * cached.
+ */
+static struct mm_region *early_get_map(const void *blob)
+{
+	struct mm_region *map;
+	int count, max, node;
+
+	for (count = 0; mem_map[count].size || mem_map[count].attrs; count++)
+		;
+	max = count + EARLY_MAX_RAM_REGIONS;
+	map = malloc((max + 1) * sizeof(*map));
+	if (!map)
+		return NULL;
+	memcpy(map, mem_map, count * sizeof(*map));
+
+	for (node = fdt_node_offset_by_prop_value(blob, -1, "device_type",
+						  "memory", sizeof("memory"));
+	     node >= 0;
+	     node = fdt_node_offset_by_prop_value(blob, node, "device_type",
+						  "memory", sizeof("memory")))
+		count = early_add_ram(blob, node, map, count, max);
+	for (node = fdt_node_offset_by_compatible(blob, -1, "mmio-sram");
+	     node >= 0;
+	     node = fdt_node_offset_by_compatible(blob, node, "mmio-sram"))
+		count = early_add_ram(blob, node, map, count, max);
+	memset(&map[count], '\0', sizeof(*map));
+
+	return map;
+}
+
+int enable_caches_early(void)
+{
+	struct mm_region *board_map = mem_map;
+	u64 one_pt = MAX_PTE_ENTRIES * sizeof(u64);
+	int start_level = 0;
+	u64 va_bits, tcr;
+	ulong size;
+	void *tables;
+	int el;
+
+	/* Leave alone an MMU set up by an earlier stage */
+	if (get_sctlr() & CR_M)
+		return -EALREADY;
+	if (!gd->fdt_blob)
+		return -ENOENT;
+
+	mem_map = early_get_map(gd->fdt_blob);
+	if (!mem_map) {
+		mem_map = board_map;
+		return -ENOMEM;
+	}
+
+	/*
+	 * Only the primary tables are needed, since nothing changes the
+	 * attributes of a region before relocation. Leave a spare table in
+	 * case a region splits a block.
+	 */
+	get_tcr(0, NULL, &va_bits);
+	if (va_bits < 39)
+		start_level = 1;
+	size = one_pt * (count_required_pts(0, start_level - 1,
+					    1ULL << va_bits) + 1);
+	tables = memalign(one_pt, size);
+	if (!tables) {
+		mem_map = board_map;
+		return -ENOMEM;
+	}
+
+	gd->arch.tlb_addr = (ulong)tables;
+	gd->arch.tlb_size = size;
+	gd->arch.tlb_fillptr = gd->arch.tlb_addr;
+	gd->arch.tlb_emerg = 0;
+	setup_pgtables();
+	el = current_el();
+	tcr = get_tcr(el, NULL, NULL);
+	mem_map = board_map;
+
+	invalidate_dcache_all();
+	__asm_invalidate_tlb_all();
+	set_ttbr_tcr_mair(el, gd->arch.tlb_addr, tcr, MEMORY_ATTRIBUTES);
+	gd->arch.tlb_early = gd->arch.tlb_addr;
+	set_sctlr(get_sctlr() | CR_M | CR_C);
+	icache_enable();
+	debug("Early caches on, page tables at %lx size %lx\n",
+	      gd->arch.tlb_addr, size);
+
+	return 0;
+}
+
+/*
+ * Switch away from the early page tables, which may be in memory that is
+ * about to be reused, so that dcache_enable() builds the final ones
+ */
+static void mmu_early_disable(void)
+{
+	set_sctlr(get_sctlr() & ~(CR_C | CR_M));
+	flush_dcache_all();
+	__asm_invalidate_tlb_all();
+	gd->arch.tlb_fillptr = 0;
+	gd->arch.tlb_early = 0;
+}
+#else
+static inline void mmu_early_disable(void)
+{
+}
+#endif
+
 /*
  * Performs a invalidation of the entire data cache at all levels
  */
@@ -471,6 +622,9 @@ void flush_dcache_range(unsigned long start, unsigned long stop)
 
 void dcache_enable(void)
 {
+	if (gd->arch.tlb_early)
+		mmu_early_disable();
+
 	/* The data cache is not active unless the mmu is enabled */
 	if (!(get_sctlr() & CR_M)) {
 		invalidate_dcache_all();
@@ -694,6 +848,11 @@ void mmu_set_region_dcache_behaviour(phys_addr_t start, size_t size,
 {
 }
 
+int enable_caches_early(void)
+{
+	return -ENOTSUPP;
+}
+
 #endif	/* CONFIG_SYS_DCACHE_OFF */
 
 #ifndef CONFIG_SYS_ICACHE_OFF
@@ -12,6 +12,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <smp.h>
 #include <asm/system.h>
 #include <asm/secure.h>
 #include <linux/compiler.h>
@@ -40,6 +41,9 @@ int cleanup_before_linux(void)
 	 */
 	disable_interrupts();
 
+	/* Secondary CPUs need coherent caches to be parked */
+	smp_park_cpus();
+
 	/*
 	 * Turn off I-cache and invalidate it
 	 */
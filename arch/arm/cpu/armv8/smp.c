@@ -0,0 +1,515 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running short jobs on the secondary CPUs in U-Boot proper
+ *
+ * Secondary CPUs normally wait in the spin table, or are held off by PSCI
+ * firmware, until the OS starts them. The first job releases them from the
+ * spin table into smp_secondary_entry, or starts them at smp_psci_entry
+ * with PSCI CPU_ON. Each one switches to its own stack, turns on its MMU
+ * and caches using the boot CPU's page tables and then waits for work in
+ * its mailbox. Before the OS is started they clean their private caches,
+ * turn the MMU off and go back to the spin table or call PSCI CPU_OFF, so
+ * the OS finds them as if they had never left.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <smp.h>
+#include <asm/armv8/mmu.h>
+#include <asm/psci.h>
+#include <asm/spin_table.h>
+#include <asm/system.h>
+#include <dm/ofnode.h>
+#include <linux/arm-smccc.h>
+#include <linux/compiler.h>
+#include <linux/libfdt.h>
+#include <linux/sizes.h>
+#include "smp_v8.h"
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define SMP_STACK_SIZE		SZ_16K
+#define SMP_START_TIMEOUT_MS	100
+#define SMP_PARK_TIMEOUT_MS	100
+#define SMP_JOB_TIMEOUT_MS	1000
+
+/* Values of smp_cpu.gen and smp_cpu.done which are not job numbers */
+#define SMP_NOT_STARTED		(~0UL)
+#define SMP_OFFLINE		(~1UL)
+
+/* Set in smp_boot_table to stop smp_secondary_entry finding a CPU */
+#define SMP_MPIDR_UNLISTED	BIT_ULL(63)
+
+/* Secondary CPUs, not counting the boot CPU */
+#define SMP_MAX_SECONDARY	(CONFIG_SMP_JOBS_MAX_CPUS - 1)
+
+/**
+ * struct smp_boot - Start-up information read by smp_secondary_entry
+ *
+ * This is read with the MMU off, so must be flushed before CPUs are
+ * released. A zero @stack_top ends the table.
+ *
+ * @mpidr:	Affinity fields of the CPU's MPIDR
+ * @stack_top:	Initial stack pointer for the CPU
+ */
+struct smp_boot {
+	u64 mpidr;
+	u64 stack_top;
+};
+
+/**
+ * struct smp_cpu - Mailbox for a secondary CPU
+ *
+ * The boot CPU writes the first cache line and the secondary CPU writes
+ * the second, so neither overwrites the other when lines are flushed.
+ *
+ * @gen:	Number of the job this CPU should run, or SMP_OFFLINE if it
+ *		should park as soon as it sees this
+ * @index:	CPU index to pass to the job function
+ * @method:	How the CPU is started and stopped (SMP_METHOD_...)
+ * @done:	Number of the last job this CPU finished, SMP_NOT_STARTED
+ *		until it starts or SMP_OFFLINE once it has parked itself
+ */
+struct smp_cpu {
+	ulong gen;
+	uint index;
+	uint method;
+	ulong done __aligned(ARCH_DMA_MINALIGN);
+} __aligned(ARCH_DMA_MINALIGN);
+
+/**
+ * struct smp_mmu - MMU settings copied from the boot CPU
+ *
+ * @ttbr:	Translation table base
+ * @tcr:	Translation control
+ * @sctlr:	System control, with the MMU and caches enabled
+ */
+struct smp_mmu {
+	u64 ttbr;
+	u64 tcr;
+	u64 sctlr;
+};
+
+/**
+ * struct smp_job - The job currently being run
+ *
+ * @fn:		Job function, or NULL to park the CPUs
+ * @arg:	Argument for @fn
+ * @ncpus:	Number of CPUs running the job
+ */
+struct smp_job {
+	smp_job_fn fn;
+	void *arg;
+	uint ncpus;
+};
+
+struct smp_boot smp_boot_table[SMP_MAX_SECONDARY + 1]
+	__aligned(ARCH_DMA_MINALIGN);
+gd_t *smp_gd __aligned(ARCH_DMA_MINALIGN);
+static struct smp_mmu smp_mmu __aligned(ARCH_DMA_MINALIGN);
+static struct smp_cpu smp_cpus[SMP_MAX_SECONDARY];
+static struct smp_job smp_job;
+static bool smp_online[SMP_MAX_SECONDARY];
+static void *smp_stacks;
+static uint smp_count;
+static ulong smp_gen;
+static bool smp_started;
+
+void smp_secondary_entry(void);
+void smp_psci_entry(void);
+void smp_dcache_private(int invalidate_only);
+void __noreturn smp_secondary_park(ulong *done, ulong gen, uint method);
+
+static void smp_flush(const void *start, size_t size)
+{
+	ulong base = (ulong)start & ~(ARCH_DMA_MINALIGN - 1);
+
+	flush_dcache_range(base, ALIGN((ulong)start + size, ARCH_DMA_MINALIGN));
+}
+
+static u64 smp_mpidr_aff(u64 mpidr)
+{
+	return mpidr & 0xff00ffffffULL;
+}
+
+void __noreturn smp_secondary_main(uint slot)
+{
+	struct smp_cpu *cpu = &smp_cpus[slot];
+	ulong gen;
+
+	/* Outer cache levels are shared with CPUs which are already running */
+	smp_dcache_private(1);
+	__asm_invalidate_icache_all();
+	__asm_invalidate_tlb_all();
+	set_ttbr_tcr_mair(current_el(), smp_mmu.ttbr, smp_mmu.tcr,
+			  MEMORY_ATTRIBUTES);
+	set_sctlr(smp_mmu.sctlr);
+
+	/* The boot CPU may have given up on us; see smp_set_offline() */
+	gen = READ_ONCE(cpu->gen);
+	if (gen == SMP_OFFLINE)
+		smp_secondary_park(&cpu->done, gen, cpu->method);
+	WRITE_ONCE(cpu->done, gen);
+	dsb();
+	asm volatile("sev");
+
+	for (;;) {
+		while ((gen = READ_ONCE(cpu->gen)) == cpu->done)
+			asm volatile("wfe");
+		dmb();
+		if (gen == SMP_OFFLINE || !smp_job.fn)
+			smp_secondary_park(&cpu->done, gen, cpu->method);
+		smp_job.fn(smp_job.arg, cpu->index, smp_job.ncpus);
+		dmb();
+		WRITE_ONCE(cpu->done, gen);
+		dsb();
+		asm volatile("sev");
+	}
+}
+
+static long smp_psci_call(uint method, ulong fn, ulong arg0, ulong arg1,
+			  ulong arg2)
+{
+	struct arm_smccc_res res;
+
+	if (!IS_ENABLED(CONFIG_ARM_SMCCC))
+		return ARM_PSCI_RET_NI;
+	if (method == SMP_METHOD_PSCI_HVC)
+		arm_smccc_hvc(fn, arg0, arg1, arg2, 0, 0, 0, 0, &res);
+	else
+		arm_smccc_smc(fn, arg0, arg1, arg2, 0, 0, 0, 0, &res);
+
+	return res.a0;
+}
+
+/* Get the PSCI conduit from the device tree, or SMP_METHOD_NONE if none */
+static uint smp_psci_method(void)
+{
+	static const char *const compat[] = {
+		"arm,psci-1.0", "arm,psci-0.2", "arm,psci",
+	};
+	const char *method = NULL;
+	ofnode node;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_ARM_SMCCC))
+		return SMP_METHOD_NONE;
+	for (i = 0; i < ARRAY_SIZE(compat) && !method; i++) {
+		node = ofnode_by_compatible(ofnode_null(), compat[i]);
+		if (ofnode_valid(node))
+			method = ofnode_read_string(node, "method");
+	}
+	if (!method)
+		return SMP_METHOD_NONE;
+	if (!strcmp(method, "smc"))
+		return SMP_METHOD_PSCI_SMC;
+	if (!strcmp(method, "hvc"))
+		return SMP_METHOD_PSCI_HVC;
+
+	return SMP_METHOD_NONE;
+}
+
+/*
+ * Work out how to start a CPU from its enable-method. CPUs which use
+ * neither the spin table nor PSCI are left alone.
+ */
+static uint smp_cpu_method(ofnode node, uint psci)
+{
+	const char *method = ofnode_read_string(node, "enable-method");
+
+	if (!method)
+		return SMP_METHOD_NONE;
+	if (IS_ENABLED(CONFIG_ARMV8_SPIN_TABLE) &&
+	    !strcmp(method, "spin-table"))
+		return SMP_METHOD_SPIN_TABLE;
+	if (!strcmp(method, "psci"))
+		return psci;
+
+	return SMP_METHOD_NONE;
+}
+
+/* Fill in smp_boot_table and the CPU methods from the device tree */
+static int smp_find_cpus(void)
+{
+	u64 self = smp_mpidr_aff(read_mpidr());
+	uint psci = smp_psci_method();
+	ofnode cpus, node;
+	uint count = 0;
+
+	cpus = ofnode_path("/cpus");
+	if (!ofnode_valid(cpus))
+		return -ENOENT;
+
+	ofnode_for_each_subnode(node, cpus) {
+		const char *type = ofnode_read_string(node, "device_type");
+		const fdt32_t *reg;
+		uint method;
+		u64 mpidr;
+		int len;
+
+		if (!type || strcmp(type, "cpu") || !ofnode_is_available(node))
+			continue;
+		reg = ofnode_get_property(node, "reg", &len);
+		if (!reg || len < sizeof(*reg))
+			continue;
+		mpidr = fdt32_to_cpu(reg[0]);
+		if (len >= 2 * sizeof(*reg))
+			mpidr = mpidr << 32 | fdt32_to_cpu(reg[1]);
+		mpidr = smp_mpidr_aff(mpidr);
+		if (mpidr == self)
+			continue;
+		method = smp_cpu_method(node, psci);
+		if (method == SMP_METHOD_NONE) {
+			debug("%s: Cannot start CPU %llx\n", __func__, mpidr);
+			continue;
+		}
+		if (count == SMP_MAX_SECONDARY) {
+			debug("%s: Ignoring CPU %llx\n", __func__, mpidr);
+			continue;
+		}
+		smp_boot_table[count].mpidr = mpidr;
+		smp_cpus[count++].method = method;
+	}
+
+	return count;
+}
+
+/*
+ * Stop using a CPU which did not start or did not finish a job in time.
+ * Whenever it does get to its mailbox it parks itself, so it cannot be
+ * left running with the MMU on when the OS starts. A spin-table CPU is
+ * also taken out of smp_boot_table, so that it waits in
+ * smp_secondary_entry instead of coming straight back.
+ */
+static void smp_set_offline(uint i)
+{
+	smp_online[i] = false;
+	if (smp_cpus[i].method == SMP_METHOD_SPIN_TABLE) {
+		smp_boot_table[i].mpidr |= SMP_MPIDR_UNLISTED;
+		smp_flush(&smp_boot_table[i], sizeof(smp_boot_table[i]));
+	}
+	WRITE_ONCE(smp_cpus[i].gen, SMP_OFFLINE);
+	smp_flush(&smp_cpus[i], sizeof(smp_cpus[i].gen));
+	dsb();
+	asm volatile("sev");
+}
+
+static int smp_start_cpus(void)
+{
+	bool spin_table = false;
+	ulong start;
+	int count;
+	long ret;
+	uint i;
+	int el;
+
+	/* Secondary CPUs rely on coherent caches to see their jobs */
+	if (!dcache_status())
+		return -EPERM;
+
+	memset(smp_boot_table, '\0', sizeof(smp_boot_table));
+	count = smp_find_cpus();
+	if (count <= 0)
+		return count ? count : -ENODEV;
+
+	if (!smp_stacks) {
+		smp_stacks = memalign(ARCH_DMA_MINALIGN,
+				      SMP_MAX_SECONDARY * SMP_STACK_SIZE);
+		if (!smp_stacks)
+			return -ENOMEM;
+	}
+
+	el = current_el();
+	smp_mmu.ttbr = gd->arch.tlb_addr;
+	smp_mmu.tcr = get_tcr(el, NULL, NULL);
+	smp_mmu.sctlr = get_sctlr();
+	smp_gd = (gd_t *)gd;
+	for (i = 0; i < count; i++) {
+		smp_boot_table[i].stack_top = (ulong)smp_stacks +
+			(i + 1) * SMP_STACK_SIZE;
+		smp_cpus[i].gen = 0;
+		smp_cpus[i].done = SMP_NOT_STARTED;
+		smp_online[i] = false;
+	}
+	smp_count = count;
+	smp_gen = 0;
+
+	/* All of this is read with the MMU off, or must not be stale */
+	smp_flush(smp_boot_table, sizeof(smp_boot_table));
+	smp_flush(&smp_gd, sizeof(smp_gd));
+	smp_flush(&smp_mmu, sizeof(smp_mmu));
+	smp_flush(smp_cpus, sizeof(smp_cpus));
+	smp_flush(smp_stacks, count * SMP_STACK_SIZE);
+
+	for (i = 0; i < count; i++) {
+		if (smp_cpus[i].method == SMP_METHOD_SPIN_TABLE) {
+			spin_table = true;
+			continue;
+		}
+		ret = smp_psci_call(smp_cpus[i].method,
+				    ARM_PSCI_0_2_FN64_CPU_ON,
+				    smp_boot_table[i].mpidr,
+				    (ulong)smp_psci_entry, i);
+		if (ret) {
+			debug("%s: CPU %llx: CPU_ON failed: %ld\n", __func__,
+			      smp_boot_table[i].mpidr, ret);
+			smp_cpus[i].method = SMP_METHOD_NONE;
+		}
+	}
+	if (spin_table) {
+		spin_table_cpu_release_addr = (ulong)smp_secondary_entry;
+		smp_flush(&spin_table_cpu_release_addr,
+			  sizeof(spin_table_cpu_release_addr));
+		dsb();
+		asm volatile("sev");
+	}
+	smp_started = true;
+
+	/* CPUs which miss this are not used, and park if they do start */
+	start = get_timer(0);
+	for (i = 0; i < count; i++) {
+		if (smp_cpus[i].method == SMP_METHOD_NONE)
+			continue;
+		while (READ_ONCE(smp_cpus[i].done) &&
+		       get_timer(start) < SMP_START_TIMEOUT_MS)
+			;
+		smp_online[i] = !READ_ONCE(smp_cpus[i].done);
+		if (!smp_online[i]) {
+			debug("%s: CPU %llx did not start\n", __func__,
+			      smp_boot_table[i].mpidr);
+			smp_set_offline(i);
+		}
+	}
+
+	return 0;
+}
+
+/* Post job @gen to all online CPUs */
+static void smp_post(ulong gen)
+{
+	uint index = 1;
+	uint i;
+
+	for (i = 0; i < smp_count; i++) {
+		if (!smp_online[i])
+			continue;
+		smp_cpus[i].index = index++;
+		dmb();
+		WRITE_ONCE(smp_cpus[i].gen, gen);
+	}
+	dsb();
+	asm volatile("sev");
+}
+
+int smp_run_on_cpus(smp_job_fn fn, void *arg)
+{
+	ulong gen, start, timeout;
+	uint ncpus = 1;
+	int ret = 0;
+	uint i;
+
+	if (!smp_started && smp_start_cpus())
+		smp_count = 0;
+	for (i = 0; i < smp_count; i++)
+		ncpus += smp_online[i];
+	if (ncpus == 1) {
+		fn(arg, 0, 1);
+		return 0;
+	}
+
+	smp_job.fn = fn;
+	smp_job.arg = arg;
+	smp_job.ncpus = ncpus;
+	gen = ++smp_gen;
+	smp_post(gen);
+
+	start = get_timer(0);
+	fn(arg, 0, ncpus);
+
+	/*
+	 * The other CPUs have a similar share of the work, so allow them
+	 * several times as long as the boot CPU took before giving up
+	 */
+	timeout = get_timer(start) * 4 + SMP_JOB_TIMEOUT_MS;
+	for (i = 0; i < smp_count; i++) {
+		if (!smp_online[i])
+			continue;
+		while (READ_ONCE(smp_cpus[i].done) != gen &&
+		       get_timer(start) < timeout)
+			;
+		if (READ_ONCE(smp_cpus[i].done) != gen) {
+			printf("CPU %llx did not finish its job\n",
+			       smp_boot_table[i].mpidr);
+			smp_set_offline(i);
+			ret = -ETIMEDOUT;
+		}
+	}
+	dmb();
+
+	return ret;
+}
+
+/* Wait for PSCI to report a CPU as off, so that the OS can start it */
+static void smp_psci_wait_off(uint i, ulong start)
+{
+	long ret;
+
+	do {
+		ret = smp_psci_call(smp_cpus[i].method,
+				    ARM_PSCI_0_2_FN64_AFFINITY_INFO,
+				    smp_boot_table[i].mpidr, 0, 0);
+	} while (ret != PSCI_AFFINITY_LEVEL_OFF && ret >= 0 &&
+		 get_timer(start) < SMP_PARK_TIMEOUT_MS);
+	if (ret != PSCI_AFFINITY_LEVEL_OFF)
+		printf("CPU %llx did not turn off\n", smp_boot_table[i].mpidr);
+}
+
+void smp_park_cpus(void)
+{
+	ulong start, gen;
+	uint i;
+
+	if (!smp_started)
+		return;
+
+	/* Stop parked CPUs from coming straight back */
+	if (IS_ENABLED(CONFIG_ARMV8_SPIN_TABLE)) {
+		spin_table_cpu_release_addr = 0;
+		smp_flush(&spin_table_cpu_release_addr,
+			  sizeof(spin_table_cpu_release_addr));
+	}
+
+	smp_job.fn = NULL;
+	gen = ++smp_gen;
+	smp_post(gen);
+
+	/*
+	 * Parked CPUs report with the MMU off, so read from memory. Offline
+	 * CPUs park themselves when they get to their mailbox, if they ever
+	 * started.
+	 */
+	start = get_timer(0);
+	for (i = 0; i < smp_count; i++) {
+		ulong *done = &smp_cpus[i].done;
+		ulong line = (ulong)done;
+		ulong want = smp_online[i] ? gen : SMP_OFFLINE;
+
+		if (smp_cpus[i].method == SMP_METHOD_NONE)
+			continue;
+		do {
+			invalidate_dcache_range(line, line + ARCH_DMA_MINALIGN);
+		} while (READ_ONCE(*done) != want &&
+			 get_timer(start) < SMP_PARK_TIMEOUT_MS);
+		if (READ_ONCE(*done) == SMP_NOT_STARTED)
+			debug("%s: CPU %llx never started\n", __func__,
+			      smp_mpidr_aff(smp_boot_table[i].mpidr));
+		else if (READ_ONCE(*done) != want)
+			printf("CPU %llx did not stop\n",
+			       smp_mpidr_aff(smp_boot_table[i].mpidr));
+		else if (smp_cpus[i].method != SMP_METHOD_SPIN_TABLE)
+			smp_psci_wait_off(i, start);
+		smp_online[i] = false;
+	}
+	smp_count = 0;
+	smp_started = false;
+}
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Shared between smp.c and smp_v8.S
+ */
+
+#ifndef __ARMV8_SMP_V8_H
+#define __ARMV8_SMP_V8_H
+
+/* How a secondary CPU is started and stopped */
+#define SMP_METHOD_NONE		0	/* Not used for jobs */
+#define SMP_METHOD_SPIN_TABLE	1	/* U-Boot's spin table */
+#define SMP_METHOD_PSCI_SMC	2	/* PSCI CPU_ON / CPU_OFF using SMC */
+#define SMP_METHOD_PSCI_HVC	3	/* PSCI CPU_ON / CPU_OFF using HVC */
+
+#endif
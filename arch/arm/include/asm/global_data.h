@@ -41,6 +41,7 @@ struct arch_global_data {
 #if defined(CONFIG_ARM64)
 	unsigned long tlb_fillptr;
 	unsigned long tlb_emerg;
+	unsigned long tlb_early;	/* page tables set up before reloc */
 #endif
 #endif
 #ifdef CONFIG_SYS_MEM_RESERVE_SECURE
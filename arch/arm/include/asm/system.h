@@ -178,6 +178,7 @@ static inline unsigned long read_mpidr(void)
 
 #define BSP_COREID	0
 
+void __asm_dcache_level(int level, int invalidate_only);
 void __asm_flush_dcache_all(void);
 void __asm_invalidate_dcache_all(void);
 void __asm_flush_dcache_range(u64 start, u64 end);
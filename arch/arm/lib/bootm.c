@@ -16,6 +16,7 @@
 #include <dm.h>
 #include <dm/root.h>
 #include <image.h>
+#include <serial.h>
 #include <u-boot/zlib.h>
 #include <asm/byteorder.h>
 #include <linux/libfdt.h>
@@ -102,6 +103,8 @@ static void announce_and_cleanup(int fake)
 
 	board_quiesce_devices();
 
+	serial_flush();
+
 	/*
 	 * Call remove function of all devices with a removal flag set.
 	 * This may be useful for last-stage operations, like cancelling
@@ -136,6 +136,14 @@ void board_init_f(ulong dummy)
 	/* Init DM early in-order to invoke system controller */
 	spl_early_init();
 
+#if CONFIG_IS_ENABLED(ARMV8_EARLY_CACHES)
+	/*
+	 * Run the rest of SPL cached rather than waiting for board_init_r().
+	 * If this fails we just carry on uncached.
+	 */
+	enable_caches_early();
+#endif
+
 #ifdef CONFIG_K3_EARLY_CONS
 	/*
 	 * Allow establishing an early console as required for example when
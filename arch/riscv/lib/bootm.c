@@ -11,6 +11,7 @@
 #include <dm.h>
 #include <dm/root.h>
 #include <image.h>
+#include <serial.h>
 #include <asm/byteorder.h>
 #include <asm/csr.h>
 #include <dm/device.h>
@@ -51,6 +52,8 @@ static void announce_and_cleanup(int fake)
 
 	board_quiesce_devices();
 
+	serial_flush();
+
 	/*
 	 * Call remove function of all devices with a removal flag set.
 	 * This may be useful for last-stage operations, like cancelling
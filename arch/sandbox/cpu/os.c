@@ -7,6 +7,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -786,3 +787,56 @@ int os_mprotect_allow(void *start, size_t len)
 
 	return mprotect(start, len, PROT_READ | PROT_WRITE);
 }
+
+struct os_thread {
+	pthread_t thread;
+	void (*fn)(void *arg, unsigned int index, unsigned int count);
+	void *arg;
+	unsigned int index;
+	unsigned int count;
+	bool started;
+};
+
+static void *os_thread_start(void *ptr)
+{
+	struct os_thread *thr = ptr;
+
+	thr->fn(thr->arg, thr->index, thr->count);
+
+	return NULL;
+}
+
+int os_run_threads(void (*fn)(void *arg, unsigned int index,
+			      unsigned int count),
+		   void *arg, unsigned int count)
+{
+	struct os_thread *threads;
+	unsigned int i;
+
+	threads = os_malloc(sizeof(*threads) * count);
+	if (!threads)
+		return -ENOMEM;
+
+	for (i = 1; i < count; i++) {
+		struct os_thread *thr = &threads[i];
+
+		thr->fn = fn;
+		thr->arg = arg;
+		thr->index = i;
+		thr->count = count;
+		thr->started = !pthread_create(&thr->thread, NULL,
+					       os_thread_start, thr);
+	}
+	fn(arg, 0, count);
+	for (i = 1; i < count; i++) {
+		struct os_thread *thr = &threads[i];
+
+		if (thr->started)
+			pthread_join(thr->thread, NULL);
+		else
+			fn(arg, i, count);
+	}
+	os_free(threads);
+
+	return 0;
+}
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs on host threads, standing in for secondary CPUs
+ */
+
+#include <common.h>
+#include <os.h>
+#include <smp.h>
+
+int smp_run_on_cpus(smp_job_fn fn, void *arg)
+{
+	return os_run_threads(fn, arg, CONFIG_SMP_JOBS_MAX_CPUS);
+}
+
+void smp_park_cpus(void)
+{
+	/* Threads only exist while a job is running */
+}
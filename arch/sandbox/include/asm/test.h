@@ -161,4 +161,15 @@ int sandbox_get_setup_called(struct udevice *dev);
  */
 int sandbox_get_sound_sum(struct udevice *dev);
 
+/**
+ * sandbox_serial_set_tx_busy() - Make the serial device refuse output
+ *
+ * While busy, the putc() and puts() methods return -EAGAIN, as a UART
+ * does when its transmit FIFO is full.
+ *
+ * @dev: Device to update
+ * @busy: true to refuse output, false to accept it
+ */
+void sandbox_serial_set_tx_busy(struct udevice *dev, bool busy);
+
 #endif
@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <fdt_support.h>
 #include <image.h>
+#include <serial.h>
 #include <u-boot/zlib.h>
 #include <asm/bootparam.h>
 #include <asm/cpu.h>
@@ -39,6 +40,8 @@ void bootm_announce_and_cleanup(void)
 	bootstage_report();
 #endif
 
+	serial_flush();
+
 	/*
 	 * Call remove function of all devices with a removal flag set.
 	 * This may be useful for last-stage operations, like cancelling
@@ -49,6 +49,32 @@ int __weak soc_clk_dump(void)
 #endif
 }
 
+#if CONFIG_IS_ENABLED(CLK_RATE_CACHE)
+static void clk_dump_cache_stats(void)
+{
+	struct clk_cache_stats stats;
+	struct udevice *dev;
+	struct uclass *uc;
+	bool header = false;
+
+	if (uclass_get(UCLASS_CLK, &uc))
+		return;
+
+	uclass_foreach_dev(dev, uc) {
+		if (!device_active(dev) || clk_get_cache_stats(dev, &stats) ||
+		    !(stats.hits + stats.misses))
+			continue;
+		if (!header) {
+			printf("\n%-30.30s   %10s %12s\n", "Rate cache",
+			       "hits", "driver calls");
+			header = true;
+		}
+		printf("%-30.30s : %10u %12u\n", dev->name, stats.hits,
+		       stats.misses);
+	}
+}
+#endif
+
 static int do_clk_dump(cmd_tbl_t *cmdtp, int flag, int argc,
 		       char *const argv[])
 {
@@ -59,6 +85,9 @@ static int do_clk_dump(cmd_tbl_t *cmdtp, int flag, int argc,
 		printf("Clock dump error %d\n", ret);
 		ret = CMD_RET_FAILURE;
 	}
+#if CONFIG_IS_ENABLED(CLK_RATE_CACHE)
+	clk_dump_cache_stats();
+#endif
 
 	return ret;
 }
@@ -89,7 +118,7 @@ static int do_clk(cmd_tbl_t *cmdtp, int flag, int argc,
 
 #ifdef CONFIG_SYS_LONGHELP
 static char clk_help_text[] =
-	"dump - Print clock frequencies";
+	"dump - Print clock frequencies (and rate-cache statistics)";
 #endif
 
 U_BOOT_CMD(clk, 2, 1, do_clk, "CLK sub-system", clk_help_text);
@@ -18,6 +18,7 @@
 #include <elf.h>
 #include <environment.h>
 #include <net.h>
+#include <smp.h>
 #include <vxworks.h>
 #ifdef CONFIG_X86
 #include <vbe.h>
@@ -234,6 +235,9 @@ static unsigned long do_bootelf_exec(ulong (*entry)(int, char * const[]),
 {
 	unsigned long ret;
 
+	/* The image may be an OS which starts the secondary CPUs itself */
+	smp_park_cpus();
+
 	/*
 	 * pass address parameter as argv[0] (aka command name),
 	 * and all remaining args
@@ -508,6 +512,8 @@ int do_bootvx(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 
 	printf("## Starting vxWorks at 0x%08lx ...\n", addr);
 
+	/* Secondary CPUs need coherent caches to be parked */
+	smp_park_cpus();
 	dcache_disable();
 #if defined(CONFIG_ARM64) && defined(CONFIG_ARMV8_PSCI)
 	armv8_setup_psci();
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show malloc() statistics
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+
+static void malloc_show_slab(const struct malloc_stats *stats)
+{
+	const struct malloc_slab_info *info;
+	int i;
+
+	printf("slab:       %#lx bytes, %#lx in use, %u pages free\n",
+	       stats->slab_size, stats->slab_in_use, stats->slab_free_pages);
+	printf("misses:     %lu\n", stats->slab_misses);
+	if (!stats->slab_size)
+		return;
+	printf("   size  pages   objs     allocs\n");
+	for (i = 0; i < MALLOC_SLAB_CLASSES; i++) {
+		info = &stats->slab[i];
+		printf("%7u %6u %6u %10lu\n", info->size, info->pages,
+		       info->objs, info->allocs);
+	}
+}
+
+static void malloc_show_hist(const struct malloc_stats *stats)
+{
+	ulong size = 16;
+	int i;
+
+	printf("request size     allocs\n");
+	for (i = 0; i < MALLOC_HIST_BUCKETS - 1; i++, size <<= 1) {
+		if (stats->hist[i])
+			printf("  <= %-7lu %10lu\n", size, stats->hist[i]);
+	}
+	if (stats->hist[i])
+		printf("   > %-7lu %10lu\n", size >> 1, stats->hist[i]);
+}
+
+static int do_malloc_info(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	struct malloc_stats stats;
+	uint frag = 0;
+
+	malloc_get_stats(&stats);
+	if (stats.heap_free)
+		frag = 100 - stats.largest_free * 100 / stats.heap_free;
+
+	printf("heap:       %#lx bytes, %#lx free in %u blocks\n",
+	       stats.heap_size, stats.heap_free, stats.free_blocks);
+	printf("largest:    %#lx bytes free, %u%% fragmented\n",
+	       stats.largest_free, frag);
+	printf("in use:     %#lx bytes, peak %#lx\n", stats.in_use, stats.peak);
+	printf("calls:      %lu malloc, %lu free\n", stats.allocs, stats.frees);
+	malloc_show_slab(&stats);
+	malloc_show_hist(&stats);
+
+	return 0;
+}
+
+static cmd_tbl_t malloc_sub[] = {
+	U_BOOT_CMD_MKENT(info, 1, 1, do_malloc_info, "", ""),
+};
+
+static int do_malloc(cmd_tbl_t *cmdtp, int flag, int argc,
+		     char * const argv[])
+{
+	cmd_tbl_t *cp;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* drop initial "malloc" arg */
+	argc--;
+	argv++;
+
+	cp = find_cmd_tbl(argv[0], malloc_sub, ARRAY_SIZE(malloc_sub));
+	if (cp)
+		return cp->cmd(cmdtp, flag, argc, argv);
+
+	return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(
+	malloc, 2, 1, do_malloc,
+	"malloc() statistics",
+	"info - show heap usage, fragmentation and allocation sizes"
+);
@@ -18,9 +18,12 @@
 #include <console.h>
 #include <hash.h>
 #include <mapmem.h>
+#include <smp.h>
 #include <watchdog.h>
 #include <asm/io.h>
 #include <linux/compiler.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -849,9 +852,248 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+#if CONFIG_IS_ENABLED(SMP_JOBS)
+#define MEM_TEST_MAX_CPUS	CONFIG_SMP_JOBS_MAX_CPUS
+#else
+#define MEM_TEST_MAX_CPUS	1
+#endif
+
+/* Amount of memory given to the CPUs at once, between console checks */
+#define MEM_TEST_CHUNK		SZ_64M
+
+/* Each CPU's part of a chunk starts on a multiple of this many words */
+#define MEM_TEST_LINE_WORDS	16
+
+enum mem_test_pass {
+	MEM_TEST_WALKING_ONES,
+	MEM_TEST_MOVING_INV,
+	MEM_TEST_ADDRESS,
+	MEM_TEST_RANDOM,
+
+	MEM_TEST_PASS_COUNT,
+};
+
+/* Name of each pass, and how many times it reads or writes each word */
+static const struct {
+	const char *name;
+	uint accesses;
+} mem_test_passes[MEM_TEST_PASS_COUNT] = {
+	[MEM_TEST_WALKING_ONES]	= { "Walking ones", 2 },
+	[MEM_TEST_MOVING_INV]	= { "Moving inversions", 5 },
+	[MEM_TEST_ADDRESS]	= { "Address", 4 },
+	[MEM_TEST_RANDOM]	= { "Random", 2 },
+};
+
+/**
+ * struct mem_test_result - What one CPU found in its part of a chunk
+ *
+ * @errs:	Number of reads which did not return the expected value
+ * @lanes:	Bits which were wrong in any of those reads
+ * @offset:	Byte offset within the chunk of the first bad read
+ * @expect:	Value expected by the first bad read
+ * @found:	Value returned by the first bad read
+ */
+struct mem_test_result {
+	ulong errs;
+	u64 lanes;
+	ulong offset;
+	u64 expect;
+	u64 found;
+};
+
+/**
+ * struct mem_test_job - One pass over a chunk of memory, shared by the CPUs
+ *
+ * @buf:	Start of the chunk
+ * @words:	Number of 64-bit words in the chunk
+ * @addr:	Address of the chunk, for the address pass
+ * @pass:	Pass to run
+ * @pattern:	Starting pattern; also the walking-ones offset and random seed
+ * @ncpus:	Returns the number of CPUs which ran the pass
+ * @res:	Returns what each CPU found
+ */
+struct mem_test_job {
+	volatile u64 *buf;
+	ulong words;
+	ulong addr;
+	enum mem_test_pass pass;
+	u64 pattern;
+	uint ncpus;
+	struct mem_test_result res[MEM_TEST_MAX_CPUS];
+};
+
+static noinline void mem_test_fail(struct mem_test_result *res, ulong i,
+				   u64 expect, u64 found)
+{
+	if (!res->errs++) {
+		res->offset = i * sizeof(u64);
+		res->expect = expect;
+		res->found = found;
+	}
+	res->lanes |= expect ^ found;
+}
+
+static inline void mem_test_check(struct mem_test_result *res,
+				  volatile u64 *buf, ulong i, u64 expect)
+{
+	u64 found = buf[i];
+
+	if (found != expect)
+		mem_test_fail(res, i, expect, found);
+}
+
+static inline u64 mem_test_random(u64 *state)
+{
+	/* xorshift64, a full-period linear-feedback generator */
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+/*
+ * Run one pass over this CPU's part of the chunk. Each CPU takes a separate
+ * run of whole cache lines, so that no two CPUs write to the same line.
+ */
+static void mem_test_run(void *arg, uint cpu, uint ncpus)
+{
+	struct mem_test_job *job = arg;
+	volatile u64 *buf = job->buf;
+	struct mem_test_result *res;
+	u64 pat = job->pattern;
+	ulong per, first, end, i;
+	u64 state, val;
+
+	if (cpu >= MEM_TEST_MAX_CPUS)
+		return;
+	res = &job->res[cpu];
+	memset(res, '\0', sizeof(*res));
+	if (!cpu)
+		job->ncpus = ncpus;
+
+	per = roundup(DIV_ROUND_UP(job->words, ncpus), MEM_TEST_LINE_WORDS);
+	first = min(job->words, cpu * per);
+	end = min(job->words, first + per);
+
+	switch (job->pass) {
+	case MEM_TEST_WALKING_ONES:
+		for (i = first; i < end; i++)
+			buf[i] = 1ULL << ((i + pat) & 63);
+		for (i = first; i < end; i++)
+			mem_test_check(res, buf, i, 1ULL << ((i + pat) & 63));
+		break;
+	case MEM_TEST_MOVING_INV:
+		for (i = first; i < end; i++)
+			buf[i] = pat;
+		for (i = first; i < end; i++) {
+			mem_test_check(res, buf, i, pat);
+			buf[i] = ~pat;
+		}
+		for (i = end; i-- > first;) {
+			mem_test_check(res, buf, i, ~pat);
+			buf[i] = pat;
+		}
+		break;
+	case MEM_TEST_ADDRESS:
+		for (i = first; i < end; i++)
+			buf[i] = job->addr + i * sizeof(u64);
+		for (i = first; i < end; i++) {
+			val = job->addr + i * sizeof(u64);
+			mem_test_check(res, buf, i, val);
+			buf[i] = ~val;
+		}
+		for (i = first; i < end; i++) {
+			val = job->addr + i * sizeof(u64);
+			mem_test_check(res, buf, i, ~val);
+		}
+		break;
+	case MEM_TEST_RANDOM:
+		state = (pat ^ (job->addr + first)) | 1;
+		for (i = first; i < end; i++)
+			buf[i] = mem_test_random(&state);
+		state = (pat ^ (job->addr + first)) | 1;
+		for (i = first; i < end; i++)
+			mem_test_check(res, buf, i, mem_test_random(&state));
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Test memory with 64-bit accesses spread over all CPUs. Each pass is run
+ * on MEM_TEST_CHUNK bytes at a time, so that the console and watchdog are
+ * looked after. This prints the throughput of each pass and, at the end,
+ * which bits of each byte lane of a 64-bit word were seen to fail.
+ */
+static ulong mem_test_fast(ulong start_addr, ulong end_addr, ulong pattern,
+			   int iteration)
+{
+	struct mem_test_job job;
+	struct mem_test_result *res;
+	ulong addr, len, ms, errs = 0;
+	u64 lanes = 0, bytes;
+	int pass, ret, lane;
+	ulong base;
+	uint cpu;
+
+	start_addr = ALIGN(start_addr, sizeof(u64));
+	end_addr &= ~(sizeof(u64) - 1);
+	for (pass = 0; pass < MEM_TEST_PASS_COUNT; pass++) {
+		printf("\n%-18s", mem_test_passes[pass].name);
+		base = get_timer(0);
+		for (addr = start_addr; addr < end_addr; addr += len) {
+			len = min_t(ulong, end_addr - addr, MEM_TEST_CHUNK);
+			job.buf = map_sysmem(addr, len);
+			job.words = len / sizeof(u64);
+			job.addr = addr;
+			job.pass = pass;
+			job.pattern = pattern + iteration;
+			job.ncpus = 0;
+			ret = smp_run_on_cpus(mem_test_run, &job);
+			unmap_sysmem((void *)job.buf);
+			if (ret) {
+				printf("\nCannot run test (err=%d)\n", ret);
+				return -1;
+			}
+
+			for (cpu = 0; cpu < job.ncpus &&
+			     cpu < MEM_TEST_MAX_CPUS; cpu++) {
+				res = &job.res[cpu];
+				if (!res->errs)
+					continue;
+				printf("\nMem error @ 0x%08lX: found %016llX, expected %016llX (%lu errors on CPU %u)",
+				       addr + res->offset, res->found,
+				       res->expect, res->errs, cpu);
+				errs += res->errs;
+				lanes |= res->lanes;
+			}
+			WATCHDOG_RESET();
+			if (ctrlc())
+				return -1;
+		}
+		ms = max(get_timer(base), 1UL);
+		bytes = (u64)(end_addr - start_addr) *
+			mem_test_passes[pass].accesses;
+		printf(" %8llu MiB/s on %u CPU(s)", div_u64(bytes, ms) * 1000 >>
+		       20, job.ncpus);
+	}
+	putc('\n');
+
+	for (lane = 0; lane < sizeof(u64); lane++) {
+		if ((lanes >> (lane * 8)) & 0xff)
+			printf("Byte lane %d: failing bits %02llx\n", lane,
+			       (lanes >> (lane * 8)) & 0xff);
+	}
+
+	return errs;
+}
+
 /*
  * Perform a memory test. A more complete alternative test can be
- * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
+ * configured using CONFIG_SYS_ALT_MEMTEST, or a faster test using all
+ * CPUs with CONFIG_SYS_FAST_MEMTEST. The complete test loops until
  * interrupted by ctrl-c or by a failure of one of the sub-tests.
  */
 static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
@@ -910,7 +1152,9 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
-		if (alt_test) {
+		if (IS_ENABLED(CONFIG_SYS_FAST_MEMTEST)) {
+			errs = mem_test_fast(start, end, pattern, iteration);
+		} else if (alt_test) {
 			errs = mem_test_alt(buf, start, end, dummy);
 		} else {
 			errs = mem_test_quick(buf, start, end, pattern,
@@ -58,6 +58,8 @@ static int bloblist_addrec(uint tag, int size, struct bloblist_rec **recp)
 	struct bloblist_rec *rec;
 	int new_alloced;
 
+	if (!hdr)
+		return log_msg_ret("bloblist add", -ENOENT);
 	new_alloced = hdr->alloced + sizeof(*rec) +
 			ALIGN(size, BLOBLIST_ALIGN);
 	if (new_alloced >= hdr->size) {
@@ -449,9 +449,97 @@ static int reserve_trace(void)
 	return 0;
 }
 
+#ifdef CONFIG_SKIP_RELOCATE
+/*
+ * Work out the space needed below U-Boot by the reservations which follow
+ * reserve_uboot() in init_sequence_f[], plus the stack itself. This must
+ * be kept in step with those functions.
+ */
+static ulong reserve_below_uboot_size(void)
+{
+	ulong size = TOTAL_MALLOC_LEN;
+
+	if (!gd->bd)
+		size += sizeof(bd_t);
+	size += sizeof(gd_t);
+#ifndef CONFIG_OF_EMBED
+	if (gd->fdt_blob)
+		size += ALIGN(fdt_totalsize(gd->fdt_blob) + 0x1000, 32);
+#endif
+#ifdef CONFIG_BOOTSTAGE
+	size += bootstage_get_size();
+#endif
+#ifdef CONFIG_BLOBLIST
+	size += CONFIG_BLOBLIST_SIZE;
+#endif
+	/* Stack alignment and the abort stack, see arch_reserve_stacks() */
+	size += 16 + 128;
+	size += CONFIG_SKIP_RELOCATE_STACK_SIZE;
+
+	return size;
+}
+
+/*
+ * Check if the areas reserved below U-Boot would overlap the early stack,
+ * global data and malloc() pool, which are still in use until relocation.
+ * Some boards put these immediately below U-Boot's load address.
+ */
+static bool reserve_below_uboot_in_use(ulong base, ulong top)
+{
+#ifdef CONFIG_SYS_INIT_SP_ADDR
+	/* The stack grows down from here, below gd and the malloc() pool */
+	ulong early_base = (ulong)&base;
+	ulong early_top = CONFIG_SYS_INIT_SP_ADDR;
+
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	early_base = min(early_base, gd->malloc_base);
+#endif
+	early_base = min(early_base, (ulong)gd);
+
+	return base <= early_top && top > early_base;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Leave U-Boot where it was loaded, if that is in RAM below the areas
+ * reserved so far and there is room for everything else underneath.
+ * Setting the relocation address to U-Boot's own address makes
+ * relocate_code() skip both the copy and the fixups.
+ */
+static bool reserve_uboot_in_place(void)
+{
+	ulong start = (ulong)__image_copy_start;
+	ulong size = reserve_below_uboot_size();
+
+	if (start < gd->ram_base || start + gd->mon_len > gd->relocaddr ||
+	    start - gd->ram_base < size) {
+		debug("U-Boot at %08lx does not fit below %08lx, relocating\n",
+		      start, gd->relocaddr);
+		return false;
+	}
+	if (reserve_below_uboot_in_use(start - size, start)) {
+		debug("Early memory is in use below %08lx, relocating\n",
+		      start);
+		return false;
+	}
+	gd->relocaddr = start;
+	debug("Leaving %ldk for U-Boot in place at: %08lx\n",
+	      gd->mon_len >> 10, gd->relocaddr);
+
+	return true;
+}
+#else
+static inline bool reserve_uboot_in_place(void)
+{
+	return false;
+}
+#endif
+
 static int reserve_uboot(void)
 {
-	if (!(gd->flags & GD_FLG_SKIP_RELOC)) {
+	if (!(gd->flags & GD_FLG_SKIP_RELOC) && !reserve_uboot_in_place()) {
 		/*
 		 * reserve memory for U-Boot code, data & bss
 		 * round down to next 4 kB limit
@@ -834,6 +922,20 @@ __weak int arch_cpu_init_dm(void)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(ARMV8_EARLY_CACHES)
+static int initf_caches(void)
+{
+	int ret;
+
+	/* Run the rest of board_init_f() cached if possible */
+	ret = enable_caches_early();
+	if (ret)
+		debug("Early caches not enabled (err=%d)\n", ret);
+
+	return 0;
+}
+#endif
+
 static const init_fnc_t init_sequence_f[] = {
 	setup_mon_len,
 #ifdef CONFIG_OF_CONTROL
@@ -843,6 +945,9 @@ static const init_fnc_t init_sequence_f[] = {
 	trace_early_init,
 #endif
 	initf_malloc,
+#if CONFIG_IS_ENABLED(ARMV8_EARLY_CACHES)
+	initf_caches,
+#endif
 	log_init,
 	initf_bootstage,	/* uses its own timer, so does not need DM */
 #ifdef CONFIG_BLOBLIST
@@ -299,6 +299,13 @@ static int initr_dm(void)
 }
 #endif
 
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+static int initr_dm_preload(void)
+{
+	return dm_probe_preload();
+}
+#endif
+
 static int initr_bootstage(void)
 {
 	bootstage_mark_name(BOOTSTAGE_ID_START_UBOOT_R, "board_init_r");
@@ -402,7 +409,8 @@ static int initr_onenand(void)
 #ifdef CONFIG_MMC
 static int initr_mmc(void)
 {
-	puts("MMC:   ");
+	if (!CONFIG_IS_ENABLED(DM_DEFERRED_PROBE))
+		puts("MMC:   ");
 	mmc_initialize(gd->bd);
 	return 0;
 }
@@ -721,6 +729,9 @@ static init_fnc_t init_sequence_r[] = {
 	arch_early_init_r,
 #endif
 	power_init_board,
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+	initr_dm_preload,
+#endif
 #ifdef CONFIG_MTD_NOR_FLASH
 	initr_flash,
 #endif
@@ -18,6 +18,7 @@
 #include <lzma/LzmaTypes.h>
 #include <lzma/LzmaDec.h>
 #include <lzma/LzmaTools.h>
+#include <u-boot/zstd.h>
 #if defined(CONFIG_CMD_USB)
 #include <usb.h>
 #endif
@@ -381,7 +382,7 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 		break;
 #ifdef CONFIG_GZIP
 	case IH_COMP_GZIP: {
-		ret = gunzip(load_buf, unc_len, image_buf, &image_len);
+		ret = gunzip_exact(load_buf, unc_len, image_buf, &image_len);
 		break;
 	}
 #endif /* CONFIG_GZIP */
@@ -429,6 +430,15 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 		break;
 	}
 #endif /* CONFIG_LZ4 */
+#ifdef CONFIG_ZSTD
+	case IH_COMP_ZSTD: {
+		size_t size = unc_len;
+
+		ret = zstd_decompress(image_buf, image_len, load_buf, &size);
+		image_len = ret == -ENOBUFS ? unc_len : size;
+		break;
+	}
+#endif /* CONFIG_ZSTD */
 	default:
 		printf("Unimplemented compression type %d\n", comp);
 		return BOOTM_ERR_UNIMPLEMENTED;
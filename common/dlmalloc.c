@@ -600,6 +600,9 @@ void *sbrk(ptrdiff_t increment)
 
 void mem_malloc_init(ulong start, ulong size)
 {
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	size -= malloc_slab_init(start, size);
+#endif
 	mem_malloc_start = start;
 	mem_malloc_end = start + size;
 	mem_malloc_brk = start;
@@ -2251,6 +2254,36 @@ size_t malloc_usable_size(mem) Void_t* mem;
   }
 }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+void malloc_heap_info(struct malloc_stats *stats)
+{
+	ulong avail, largest, size;
+	uint count;
+	mchunkptr p;
+	mbinptr b;
+	int i;
+
+	/* Memory not yet taken with sbrk() extends the top chunk */
+	largest = chunksize(top) + mem_malloc_end - mem_malloc_brk;
+	avail = largest;
+	count = largest ? 1 : 0;
+	for (i = 1; i < NAV; ++i) {
+		b = bin_at(i);
+		for (p = last(b); p != b; p = p->bk) {
+			size = chunksize(p);
+			avail += size;
+			largest = max(largest, size);
+			count++;
+		}
+	}
+
+	stats->heap_size = mem_malloc_end - mem_malloc_start;
+	stats->heap_free = avail;
+	stats->largest_free = largest;
+	stats->free_blocks = count;
+}
+#endif
+
 
 
 
@@ -2337,8 +2370,14 @@ void malloc_stats()
 #ifdef DEBUG
 struct mallinfo mALLINFo()
 {
+  struct mallinfo mi;
+
   malloc_update_mallinfo();
-  return current_mallinfo;
+  mi = current_mallinfo;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  malloc_slab_mallinfo(&mi);
+#endif
+  return mi;
 }
 #endif	/* DEBUG */
 
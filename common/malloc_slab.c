@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Slab front-end for small malloc() allocations, with malloc() statistics
+ *
+ * Driver model makes many small allocations of a few common sizes: private
+ * and platform data, uclass data and list nodes. With dlmalloc each of these
+ * is a chunk with its own header, split from and merged back into the free
+ * bins, so a bind/probe/remove cycle leaves the heap fragmented. Here,
+ * requests of up to 512 bytes are served from pages holding objects of a
+ * single size, in an arena at the top of the malloc() region. When the arena
+ * is full, or for anything larger, dlmalloc is used as before.
+ *
+ * Only allocations made after relocation go through the slab and are
+ * counted; malloc_simple() handles those before.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <linux/bitops.h>
+#include <linux/list.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define SLAB_PAGE_SIZE		SZ_4K
+#define SLAB_ALIGN		16
+#define SLAB_MAX_SIZE		512
+#define SLAB_MAX_PAGES		(CONFIG_SYS_MALLOC_SLAB_LEN / SLAB_PAGE_SIZE)
+#define SLAB_NO_CLASS		0xff
+
+/**
+ * struct slab_page - Descriptor for one page of the slab arena
+ *
+ * Objects are handed out from the start of the page until it is used up, and
+ * after that from the list of freed objects. The first word of each freed
+ * object points to the next one.
+ *
+ * @list:	Link in the partial list of the size class, or in the list of
+ *		free pages. Full pages are not on any list.
+ * @free:	First freed object, or NULL if none
+ * @used:	Number of bytes handed out from the start of the page
+ * @inuse:	Number of objects currently allocated
+ * @cls:	Size class, or SLAB_NO_CLASS if the page is free
+ */
+struct slab_page {
+	struct list_head list;
+	void **free;
+	u16 used;
+	u16 inuse;
+	u8 cls;
+};
+
+static const u16 slab_sizes[MALLOC_SLAB_CLASSES] = {
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+/* Size class for each multiple of SLAB_ALIGN, up to SLAB_MAX_SIZE */
+static u8 slab_class_of[SLAB_MAX_SIZE / SLAB_ALIGN + 1];
+
+static struct slab_page slab_pages[SLAB_MAX_PAGES];
+static struct list_head slab_partial[MALLOC_SLAB_CLASSES];
+static struct list_head slab_free_pages;
+static ulong slab_base;
+static uint slab_npages;
+static struct malloc_stats stats;
+
+/* Both the slab and the statistics live in BSS, only valid after relocation */
+static inline bool malloc_ready(void)
+{
+	return gd->flags & GD_FLG_FULL_MALLOC_INIT;
+}
+
+static inline bool slab_owns(const void *ptr)
+{
+	return (ulong)ptr - slab_base < (ulong)slab_npages * SLAB_PAGE_SIZE;
+}
+
+static inline struct slab_page *slab_page_of(const void *ptr)
+{
+	return &slab_pages[((ulong)ptr - slab_base) / SLAB_PAGE_SIZE];
+}
+
+static inline void *slab_page_addr(struct slab_page *page)
+{
+	return (void *)(slab_base + (page - slab_pages) * SLAB_PAGE_SIZE);
+}
+
+static uint malloc_hist_bucket(size_t bytes)
+{
+	uint bucket;
+
+	if (bytes <= SLAB_ALIGN)
+		return 0;
+	bucket = fls_long(bytes - 1) - 4;
+
+	return min(bucket, (uint)MALLOC_HIST_BUCKETS - 1);
+}
+
+static void malloc_account(void *ptr, size_t bytes, size_t size)
+{
+	if (!ptr)
+		return;
+	stats.allocs++;
+	stats.hist[malloc_hist_bucket(bytes)]++;
+	stats.in_use += size;
+	if (stats.in_use > stats.peak)
+		stats.peak = stats.in_use;
+}
+
+static void *slab_alloc(size_t bytes)
+{
+	struct slab_page *page;
+	struct list_head *head;
+	void **obj;
+	uint size;
+	uint cls;
+
+	if (bytes > SLAB_MAX_SIZE || !slab_npages)
+		return NULL;
+	cls = slab_class_of[(bytes + SLAB_ALIGN - 1) / SLAB_ALIGN];
+	size = slab_sizes[cls];
+	head = &slab_partial[cls];
+	if (list_empty(head)) {
+		if (list_empty(&slab_free_pages)) {
+			stats.slab_misses++;
+			return NULL;
+		}
+		page = list_first_entry(&slab_free_pages, struct slab_page,
+					list);
+		list_move(&page->list, head);
+		page->free = NULL;
+		page->used = 0;
+		page->cls = cls;
+	} else {
+		page = list_first_entry(head, struct slab_page, list);
+	}
+
+	if (page->free) {
+		obj = page->free;
+		page->free = *obj;
+	} else {
+		obj = slab_page_addr(page) + page->used;
+		page->used += size;
+	}
+	page->inuse++;
+	if (!page->free && page->used + size > SLAB_PAGE_SIZE)
+		list_del_init(&page->list);
+
+	stats.slab[cls].allocs++;
+	stats.slab_in_use += size;
+	malloc_account(obj, bytes, size);
+
+	return obj;
+}
+
+static void slab_free(void *mem)
+{
+	struct slab_page *page = slab_page_of(mem);
+	uint size = slab_sizes[page->cls];
+	void **obj = mem;
+
+	/* A full page goes back on the partial list */
+	if (list_empty(&page->list))
+		list_add(&page->list, &slab_partial[page->cls]);
+	*obj = page->free;
+	page->free = obj;
+	if (!--page->inuse) {
+		page->cls = SLAB_NO_CLASS;
+		list_move(&page->list, &slab_free_pages);
+	}
+
+	stats.slab_in_use -= size;
+	stats.in_use -= size;
+	stats.frees++;
+}
+
+void *malloc(size_t bytes)
+{
+	void *ptr;
+
+	if (!malloc_ready())
+		return dlmalloc(bytes);
+	ptr = slab_alloc(bytes);
+	if (ptr)
+		return ptr;
+	ptr = dlmalloc(bytes);
+	malloc_account(ptr, bytes, malloc_usable_size(ptr));
+
+	return ptr;
+}
+
+void free(void *mem)
+{
+	if (!malloc_ready() || !mem) {
+		dlfree(mem);
+		return;
+	}
+	if (slab_owns(mem)) {
+		slab_free(mem);
+		return;
+	}
+
+	/* Ignore blocks from before relocation, which dlfree() ignores too */
+	if ((ulong)mem - mem_malloc_start < mem_malloc_end - mem_malloc_start) {
+		stats.in_use -= malloc_usable_size(mem);
+		stats.frees++;
+	}
+	dlfree(mem);
+}
+
+void *calloc(size_t n, size_t elem_size)
+{
+	size_t bytes = n * elem_size;
+	void *ptr;
+
+	if (!malloc_ready())
+		return dlcalloc(n, elem_size);
+	if (elem_size && bytes / elem_size != n)
+		return NULL;
+	ptr = slab_alloc(bytes);
+	if (ptr) {
+		memset(ptr, '\0', bytes);
+		return ptr;
+	}
+	ptr = dlcalloc(n, elem_size);
+	malloc_account(ptr, bytes, malloc_usable_size(ptr));
+
+	return ptr;
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	size_t old;
+	void *ptr;
+
+	if (!oldmem)
+		return malloc(bytes);
+	if (!malloc_ready())
+		return dlrealloc(oldmem, bytes);
+
+	if (!slab_owns(oldmem)) {
+		old = malloc_usable_size(oldmem);
+		ptr = dlrealloc(oldmem, bytes);
+		if (ptr) {
+			stats.in_use += malloc_usable_size(ptr) - old;
+			if (stats.in_use > stats.peak)
+				stats.peak = stats.in_use;
+		}
+		return ptr;
+	}
+
+	/* Stay in the same object unless it is too small */
+	old = slab_sizes[slab_page_of(oldmem)->cls];
+	if (bytes <= old)
+		return oldmem;
+	ptr = malloc(bytes);
+	if (!ptr)
+		return NULL;
+	memcpy(ptr, oldmem, old);
+	slab_free(oldmem);
+
+	return ptr;
+}
+
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *ptr;
+
+	if (!malloc_ready())
+		return dlmemalign(alignment, bytes);
+	if (alignment <= SLAB_ALIGN) {
+		ptr = slab_alloc(bytes);
+		if (ptr)
+			return ptr;
+	}
+	ptr = dlmemalign(alignment, bytes);
+	malloc_account(ptr, bytes, malloc_usable_size(ptr));
+
+	return ptr;
+}
+
+ulong malloc_slab_init(ulong start, ulong size)
+{
+	ulong len, end;
+	uint cls, i;
+
+	memset(&stats, '\0', sizeof(stats));
+	INIT_LIST_HEAD(&slab_free_pages);
+	for (cls = 0; cls < MALLOC_SLAB_CLASSES; cls++)
+		INIT_LIST_HEAD(&slab_partial[cls]);
+	for (cls = 0, i = 0; i < ARRAY_SIZE(slab_class_of); i++) {
+		if (i * SLAB_ALIGN > slab_sizes[cls])
+			cls++;
+		slab_class_of[i] = cls;
+	}
+
+	/* Leave most of a small region to dlmalloc */
+	len = min((ulong)CONFIG_SYS_MALLOC_SLAB_LEN, size / 4);
+	len &= ~(SLAB_PAGE_SIZE - 1);
+	end = (start + size) & ~(SLAB_PAGE_SIZE - 1);
+	slab_npages = len / SLAB_PAGE_SIZE;
+	if (!slab_npages)
+		return 0;
+	slab_base = end - len;
+	for (i = 0; i < slab_npages; i++) {
+		slab_pages[i].cls = SLAB_NO_CLASS;
+		list_add_tail(&slab_pages[i].list, &slab_free_pages);
+	}
+#ifdef CONFIG_SYS_MALLOC_CLEAR_ON_INIT
+	memset((void *)slab_base, '\0', len);
+#endif
+	debug("using memory %#lx-%#lx for the malloc() slab\n", slab_base, end);
+
+	return start + size - slab_base;
+}
+
+void malloc_slab_mallinfo(struct mallinfo *mi)
+{
+	ulong len = (ulong)slab_npages * SLAB_PAGE_SIZE;
+
+	mi->arena += len;
+	mi->uordblks += stats.slab_in_use;
+	mi->fordblks += len - stats.slab_in_use;
+}
+
+void malloc_get_stats(struct malloc_stats *st)
+{
+	struct slab_page *page;
+	uint cls;
+
+	*st = stats;
+	malloc_heap_info(st);
+	st->slab_size = (ulong)slab_npages * SLAB_PAGE_SIZE;
+	for (cls = 0; cls < MALLOC_SLAB_CLASSES; cls++) {
+		st->slab[cls].size = slab_sizes[cls];
+		st->slab[cls].pages = 0;
+		st->slab[cls].objs = 0;
+	}
+	for (page = slab_pages; page < slab_pages + slab_npages; page++) {
+		if (page->cls == SLAB_NO_CLASS) {
+			st->slab_free_pages++;
+			continue;
+		}
+		st->slab[page->cls].pages++;
+		st->slab[page->cls].objs += page->inuse;
+	}
+}
@@ -11,6 +11,7 @@
 #include <linux/libfdt.h>
 #include <malloc.h>
 #include <spl.h>
+#include <u-boot/zstd.h>
 
 #ifndef CONFIG_SYS_BOOTM_LEN
 #define CONFIG_SYS_BOOTM_LEN	(64 << 20)
@@ -203,19 +204,23 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 	ulong overhead;
 	int nr_sectors;
 	int align_len = ARCH_DMA_MINALIGN - 1;
+	int ret;
 	uint8_t image_comp = -1, type = -1;
 	const void *data;
 	bool external_data = false;
+	bool decomp = IS_ENABLED(CONFIG_SPL_GZIP) ||
+		      IS_ENABLED(CONFIG_SPL_ZSTD);
+	void *zstd_buf = NULL;
 
 	if (IS_ENABLED(CONFIG_SPL_FPGA_SUPPORT) ||
-	    (IS_ENABLED(CONFIG_SPL_OS_BOOT) && IS_ENABLED(CONFIG_SPL_GZIP))) {
+	    (IS_ENABLED(CONFIG_SPL_OS_BOOT) && decomp)) {
 		if (fit_image_get_type(fit, node, &type))
 			puts("Cannot get image type.\n");
 		else
 			debug("%s ", genimg_get_type_name(type));
 	}
 
-	if (IS_ENABLED(CONFIG_SPL_OS_BOOT) && IS_ENABLED(CONFIG_SPL_GZIP)) {
+	if (IS_ENABLED(CONFIG_SPL_OS_BOOT) && decomp) {
 		if (fit_image_get_comp(fit, node, &image_comp))
 			puts("Cannot get image compression format.\n");
 		else
@@ -243,10 +248,21 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 		overhead = get_aligned_image_overhead(info, offset);
 		nr_sectors = get_aligned_image_size(info, length, offset);
 
+		/* zstd cannot decompress in place, so load it elsewhere */
+		if (IS_ENABLED(CONFIG_SPL_ZSTD) && image_comp == IH_COMP_ZSTD) {
+			zstd_buf = memalign(ARCH_DMA_MINALIGN,
+					    nr_sectors * info->bl_len);
+			if (!zstd_buf)
+				return -ENOMEM;
+			load_ptr = (ulong)zstd_buf;
+		}
+
 		if (info->read(info,
 			       sector + get_aligned_image_offset(info, offset),
-			       nr_sectors, (void *)load_ptr) != nr_sectors)
+			       nr_sectors, (void *)load_ptr) != nr_sectors) {
+			free(zstd_buf);
 			return -EIO;
+		}
 
 		debug("External data: dst=%lx, offset=%x, size=%lx\n",
 		      load_ptr, offset, (unsigned long)length);
@@ -266,8 +282,10 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 	printf("## Checking hash(es) for Image %s ... ",
 	       fit_get_name(fit, node, NULL));
 	if (!fit_image_verify_with_data(fit, node,
-					 src, length))
+					 src, length)) {
+		free(zstd_buf);
 		return -EPERM;
+	}
 	puts("OK\n");
 #endif
 
@@ -277,12 +295,21 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 
 	if (IS_ENABLED(CONFIG_SPL_GZIP) && image_comp == IH_COMP_GZIP) {
 		size = length;
-		if (gunzip((void *)load_addr, CONFIG_SYS_BOOTM_LEN,
-			   src, &size)) {
+		if (gunzip_exact((void *)load_addr, CONFIG_SYS_BOOTM_LEN,
+				 src, &size)) {
 			puts("Uncompressing error\n");
 			return -EIO;
 		}
 		length = size;
+	} else if (IS_ENABLED(CONFIG_SPL_ZSTD) && image_comp == IH_COMP_ZSTD) {
+		size = CONFIG_SYS_BOOTM_LEN;
+		ret = zstd_decompress(src, length, (void *)load_addr, &size);
+		free(zstd_buf);
+		if (ret) {
+			printf("Uncompressing error %d\n", ret);
+			return -EIO;
+		}
+		length = size;
 	} else {
 		memcpy((void *)load_addr, src, length);
 	}
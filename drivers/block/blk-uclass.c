@@ -457,6 +457,8 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	fs_dcache_invalidate(block_dev);
+	efi_disk_invalidate(block_dev);
 	return ops->write(dev, start, blkcnt, buffer);
 }
 
@@ -470,6 +472,8 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	fs_dcache_invalidate(block_dev);
+	efi_disk_invalidate(block_dev);
 	return ops->erase(dev, start, blkcnt);
 }
 
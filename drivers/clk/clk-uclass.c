@@ -14,11 +14,91 @@
 #include <dt-structs.h>
 #include <errno.h>
 
+/* Number of rates cached for each clock device, must be a power of two */
+#define CLK_RATE_CACHE_SIZE	16
+
+/**
+ * struct clk_rate_entry - A clock rate remembered by clk_get_rate()
+ *
+ * @id: Clock ID, as in struct clk
+ * @data: Clock data, as in struct clk
+ * @rate: Rate returned by the driver
+ * @gen: Value of clk_uc_priv.gen when the rate was read, 0 if unused
+ */
+struct clk_rate_entry {
+	ulong id;
+	ulong data;
+	ulong rate;
+	uint gen;
+};
+
+/**
+ * struct clk_dev_priv - Uclass-private data for each clock device
+ *
+ * @cache: Rates recently returned by the driver
+ * @stats: Statistics for @cache
+ */
+struct clk_dev_priv {
+	struct clk_rate_entry cache[CLK_RATE_CACHE_SIZE];
+	struct clk_cache_stats stats;
+};
+
+/**
+ * struct clk_uc_priv - Uclass-private data for clocks
+ *
+ * @gen: Generation of the cached rates. This changes whenever a rate or
+ *	parent is set, since that may affect any clock downstream, perhaps
+ *	in another device. All cached rates are then out of date.
+ */
+struct clk_uc_priv {
+	uint gen;
+};
+
 static inline const struct clk_ops *clk_dev_ops(struct udevice *dev)
 {
 	return (const struct clk_ops *)dev->driver->ops;
 }
 
+/* Get the cache entry for a clock, or NULL if rates are not cached */
+static struct clk_rate_entry *clk_rate_entry(struct clk *clk)
+{
+	struct clk_dev_priv *priv;
+
+	if (!CONFIG_IS_ENABLED(CLK_RATE_CACHE))
+		return NULL;
+	priv = dev_get_uclass_priv(clk->dev);
+	if (!priv)
+		return NULL;
+
+	return &priv->cache[(clk->id * 31 + clk->data) &
+			    (CLK_RATE_CACHE_SIZE - 1)];
+}
+
+static void clk_rate_invalidate(struct clk *clk)
+{
+	struct clk_uc_priv *uc_priv;
+
+	if (!CONFIG_IS_ENABLED(CLK_RATE_CACHE))
+		return;
+	uc_priv = clk->dev->uclass->priv;
+	if (!++uc_priv->gen)
+		uc_priv->gen = 1;
+}
+
+int clk_get_cache_stats(struct udevice *dev, struct clk_cache_stats *stats)
+{
+	struct clk_dev_priv *priv;
+
+	if (!CONFIG_IS_ENABLED(CLK_RATE_CACHE))
+		return -ENOSYS;
+	priv = dev_get_uclass_priv(dev);
+	if (!priv)
+		return -ENOSYS;
+	*stats = priv->stats;
+
+	return 0;
+}
+
 #if CONFIG_IS_ENABLED(OF_CONTROL)
 # if CONFIG_IS_ENABLED(OF_PLATDATA)
 int clk_get_by_index_platdata(struct udevice *dev, int index,
@@ -331,13 +411,38 @@ int clk_free(struct clk *clk)
 ulong clk_get_rate(struct clk *clk)
 {
 	const struct clk_ops *ops = clk_dev_ops(clk->dev);
+	struct clk_rate_entry *entry;
+	struct clk_dev_priv *priv;
+	struct clk_uc_priv *uc_priv;
+	ulong rate;
 
 	debug("%s(clk=%p)\n", __func__, clk);
 
 	if (!ops->get_rate)
 		return -ENOSYS;
 
-	return ops->get_rate(clk);
+	entry = clk_rate_entry(clk);
+	if (!entry)
+		return ops->get_rate(clk);
+
+	priv = dev_get_uclass_priv(clk->dev);
+	uc_priv = clk->dev->uclass->priv;
+	if (entry->gen == uc_priv->gen && entry->id == clk->id &&
+	    entry->data == clk->data) {
+		priv->stats.hits++;
+		return entry->rate;
+	}
+
+	priv->stats.misses++;
+	rate = ops->get_rate(clk);
+	if (!IS_ERR_VALUE(rate)) {
+		entry->id = clk->id;
+		entry->data = clk->data;
+		entry->rate = rate;
+		entry->gen = uc_priv->gen;
+	}
+
+	return rate;
 }
 
 ulong clk_set_rate(struct clk *clk, ulong rate)
@@ -349,19 +454,27 @@ ulong clk_set_rate(struct clk *clk, ulong rate)
 	if (!ops->set_rate)
 		return -ENOSYS;
 
-	return ops->set_rate(clk, rate);
+	/* Even a failed attempt may have changed something */
+	rate = ops->set_rate(clk, rate);
+	clk_rate_invalidate(clk);
+
+	return rate;
 }
 
 int clk_set_parent(struct clk *clk, struct clk *parent)
 {
 	const struct clk_ops *ops = clk_dev_ops(clk->dev);
+	int ret;
 
 	debug("%s(clk=%p, parent=%p)\n", __func__, clk, parent);
 
 	if (!ops->set_parent)
 		return -ENOSYS;
 
-	return ops->set_parent(clk, parent);
+	ret = ops->set_parent(clk, parent);
+	clk_rate_invalidate(clk);
+
+	return ret;
 }
 
 int clk_enable(struct clk *clk)
@@ -427,7 +540,23 @@ bool clk_is_match(const struct clk *p, const struct clk *q)
 	return false;
 }
 
+static int clk_uclass_init(struct uclass *uc)
+{
+	struct clk_uc_priv *uc_priv = uc->priv;
+
+	/* Generation 0 marks unused cache entries */
+	if (uc_priv)
+		uc_priv->gen = 1;
+
+	return 0;
+}
+
 UCLASS_DRIVER(clk) = {
 	.id		= UCLASS_CLK,
 	.name		= "clk",
+	.init		= clk_uclass_init,
+#if CONFIG_IS_ENABLED(CLK_RATE_CACHE)
+	.priv_auto_alloc_size		= sizeof(struct clk_uc_priv),
+	.per_device_auto_alloc_size	= sizeof(struct clk_dev_priv),
+#endif
 };
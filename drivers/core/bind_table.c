@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Looking up device tree information in the table generated at build time
+ *
+ * The table lets driver model find the subnodes of a node, the drivers for
+ * a node, phandles and translated addresses without walking the device
+ * tree or the driver list. It is only used while the control device tree
+ * is the one it was generated from.
+ */
+
+#include <common.h>
+#include <dm/bind-table.h>
+#include <u-boot/crc.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/*
+ * The last device tree checked against the table, and the result. These are
+ * in .data since they may be set before relocation.
+ */
+static const void *checked_blob __section(".data");
+static bool checked_valid __section(".data");
+
+static bool dm_bind_table_check(const void *blob)
+{
+	const struct dm_bind_table *table = &dm_bind_table;
+	u32 crc;
+
+	if (fdt_totalsize(blob) != table->fdt_size ||
+	    fdt_size_dt_struct(blob) != table->struct_size ||
+	    fdt_size_dt_strings(blob) != table->strings_size)
+		return false;
+
+	/*
+	 * A tree of the same size may still differ, e.g. if a property value
+	 * was changed in place, so check the contents too
+	 */
+	crc = crc32(0, blob + fdt_off_dt_struct(blob), table->struct_size);
+	crc = crc32(crc, blob + fdt_off_dt_strings(blob), table->strings_size);
+	if (crc != table->crc) {
+		debug("Device tree does not match the bind table\n");
+		return false;
+	}
+
+	return true;
+}
+
+bool dm_bind_table_valid(const void *blob)
+{
+	if (!blob || blob != gd->fdt_blob)
+		return false;
+
+	/* Only check the contents once for each tree */
+	if (blob != checked_blob) {
+		checked_valid = dm_bind_table_check(blob);
+		checked_blob = blob;
+	}
+
+	return checked_valid;
+}
+
+const struct dm_bind_node *dm_bind_table_find(int offset)
+{
+	const struct dm_bind_node *nodes = dm_bind_table.nodes;
+	int low = 0, high = dm_bind_table.num_nodes - 1;
+
+	while (low <= high) {
+		int mid = (low + high) / 2;
+
+		if (nodes[mid].offset == offset)
+			return &nodes[mid];
+		if (nodes[mid].offset < offset)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return NULL;
+}
+
+int dm_bind_table_phandle(u32 phandle)
+{
+	const struct dm_bind_phandle *phandles = dm_bind_table.phandles;
+	int low = 0, high = dm_bind_table.num_phandles - 1;
+
+	while (low <= high) {
+		int mid = (low + high) / 2;
+
+		if (phandles[mid].phandle == phandle)
+			return phandles[mid].offset;
+		if (phandles[mid].phandle < phandle)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+fdt_addr_t dm_bind_table_addr(const void *blob, int offset)
+{
+	const struct dm_bind_node *node;
+
+	if (!dm_bind_table_valid(blob))
+		return FDT_ADDR_T_NONE;
+	node = dm_bind_table_find(offset);
+
+	return node ? node->addr : FDT_ADDR_T_NONE;
+}
@@ -170,6 +170,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		*devp = dev;
 
 	dev->flags |= DM_FLAG_BOUND;
+	uclass_index_device(dev);
 
 	return 0;
 
@@ -375,7 +376,7 @@ int device_probe(struct udevice *dev)
 		ret = seq;
 		goto fail;
 	}
-	dev->seq = seq;
+	uclass_set_seq(dev, seq);
 
 	dev->flags |= DM_FLAG_ACTIVATED;
 
@@ -438,7 +439,7 @@ fail_uclass:
 fail:
 	dev->flags &= ~DM_FLAG_ACTIVATED;
 
-	dev->seq = -1;
+	uclass_set_seq(dev, -1);
 	device_free(dev);
 
 	return ret;
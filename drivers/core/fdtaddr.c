@@ -12,6 +12,7 @@
 #include <dm.h>
 #include <fdt_support.h>
 #include <asm/io.h>
+#include <dm/bind-table.h>
 #include <dm/device-internal.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -50,11 +51,18 @@ fdt_addr_t devfdt_get_addr_index(struct udevice *dev, int index)
 
 		if (ns) {
 			/*
-			 * Use the full-fledged translate function for complex
-			 * bus setups.
+			 * The first address may have been translated at build
+			 * time. If not, use the full-fledged translate function
+			 * for complex bus setups.
 			 */
-			addr = fdt_translate_address((void *)gd->fdt_blob,
-						     dev_of_offset(dev), reg);
+			addr = FDT_ADDR_T_NONE;
+			if (!index)
+				addr = dm_bind_table_addr(gd->fdt_blob,
+							  dev_of_offset(dev));
+			if (addr == FDT_ADDR_T_NONE)
+				addr = fdt_translate_address(
+						(void *)gd->fdt_blob,
+						dev_of_offset(dev), reg);
 		} else {
 			/* Non translatable if #size-cells == 0 */
 			addr = fdt_read_number(reg, na);
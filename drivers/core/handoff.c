@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Passing device state from one boot phase to the next
+ *
+ * All state is kept in a single bloblist record of CONFIG_DM_HANDOFF_SIZE
+ * bytes: a header followed by a packed list of per-device records.
+ */
+
+#include <common.h>
+#include <bloblist.h>
+#include <dm.h>
+#include <dm/handoff.h>
+
+enum {
+	DEV_HANDOFF_MAGIC	= 0xde7a0ff5,
+	DEV_HANDOFF_ALIGN	= 4,
+};
+
+/**
+ * struct dev_handoff_hdr - Header of the bloblist record
+ *
+ * @magic: DEV_HANDOFF_MAGIC
+ * @used: Number of bytes used by the records following this header
+ */
+struct dev_handoff_hdr {
+	u32 magic;
+	u32 used;
+};
+
+/**
+ * struct dev_handoff_rec - State saved for one device
+ *
+ * The state follows this header and is padded to DEV_HANDOFF_ALIGN bytes
+ *
+ * @key: Identifies the device, see dev_handoff_key()
+ * @tag: Kind of state (enum dev_handoff_tag)
+ * @size: Size of the state in bytes
+ */
+struct dev_handoff_rec {
+	u32 key;
+	u16 tag;
+	u16 size;
+};
+
+#define DEV_HANDOFF_SPACE (CONFIG_DM_HANDOFF_SIZE - \
+			   (int)sizeof(struct dev_handoff_hdr))
+
+static int dev_handoff_rec_len(struct dev_handoff_rec *rec)
+{
+	return sizeof(*rec) + ALIGN(rec->size, DEV_HANDOFF_ALIGN);
+}
+
+/*
+ * Hash the uclass and the names of the device and its parents. Device
+ * pointers and sequence numbers are not the same in each phase, but names
+ * normally are.
+ */
+static u32 dev_handoff_key(struct udevice *dev)
+{
+	u32 hash = 2166136261u;
+	const char *name;
+
+	hash = (hash ^ device_get_uclass_id(dev)) * 16777619u;
+	for (; dev; dev = dev->parent) {
+		for (name = dev->name; *name; name++)
+			hash = (hash ^ (u8)*name) * 16777619u;
+		hash = (hash ^ '/') * 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * dev_handoff_hdr() - Get the bloblist record holding the device state
+ *
+ * @create: true to create the record if it does not exist or is not valid
+ * @return pointer to the record, or NULL if none
+ */
+static struct dev_handoff_hdr *dev_handoff_hdr(bool create)
+{
+	struct dev_handoff_hdr *hdr;
+	void *blob;
+
+	if (create) {
+		if (bloblist_ensure_size(BLOBLISTT_DM_HANDOFF,
+					 CONFIG_DM_HANDOFF_SIZE, &blob))
+			return NULL;
+		hdr = blob;
+	} else {
+		hdr = bloblist_find(BLOBLISTT_DM_HANDOFF,
+				    CONFIG_DM_HANDOFF_SIZE);
+		if (!hdr)
+			return NULL;
+	}
+	if (hdr->magic == DEV_HANDOFF_MAGIC && hdr->used <= DEV_HANDOFF_SPACE)
+		return hdr;
+	if (!create)
+		return NULL;
+	hdr->magic = DEV_HANDOFF_MAGIC;
+	hdr->used = 0;
+
+	return hdr;
+}
+
+static struct dev_handoff_rec *dev_handoff_find_rec(struct dev_handoff_hdr *hdr,
+						    u32 key, uint tag)
+{
+	void *ptr = hdr + 1;
+	void *end = ptr + hdr->used;
+	struct dev_handoff_rec *rec;
+
+	while (ptr + sizeof(*rec) <= end) {
+		rec = ptr;
+		if (ptr + dev_handoff_rec_len(rec) > end)
+			break;
+		if (rec->key == key && rec->tag == tag)
+			return rec;
+		ptr += dev_handoff_rec_len(rec);
+	}
+
+	return NULL;
+}
+
+static void dev_handoff_remove_rec(struct dev_handoff_hdr *hdr,
+				   struct dev_handoff_rec *rec)
+{
+	void *end = (void *)(hdr + 1) + hdr->used;
+	int len = dev_handoff_rec_len(rec);
+
+	memmove(rec, (void *)rec + len, end - ((void *)rec + len));
+	hdr->used -= len;
+}
+
+int dev_handoff_save(struct udevice *dev, uint tag, const void *data,
+		     int size)
+{
+	struct dev_handoff_hdr *hdr;
+	struct dev_handoff_rec *rec;
+	u32 key;
+
+	if (size < 0 || size > U16_MAX)
+		return -EINVAL;
+	hdr = dev_handoff_hdr(true);
+	if (!hdr)
+		return -ENOENT;
+
+	key = dev_handoff_key(dev);
+	rec = dev_handoff_find_rec(hdr, key, tag);
+	if (rec) {
+		if (rec->size == size) {
+			memcpy(rec + 1, data, size);
+			return 0;
+		}
+		dev_handoff_remove_rec(hdr, rec);
+	}
+
+	if (hdr->used + sizeof(*rec) + ALIGN(size, DEV_HANDOFF_ALIGN) >
+	    DEV_HANDOFF_SPACE) {
+		debug("%s: No space for state %u (%d bytes)\n", dev->name,
+		      tag, size);
+		return -ENOSPC;
+	}
+	rec = (void *)(hdr + 1) + hdr->used;
+	rec->key = key;
+	rec->tag = tag;
+	rec->size = size;
+	memcpy(rec + 1, data, size);
+	hdr->used += dev_handoff_rec_len(rec);
+
+	return 0;
+}
+
+const void *dev_handoff_find(struct udevice *dev, uint tag, int size)
+{
+	struct dev_handoff_hdr *hdr;
+	struct dev_handoff_rec *rec;
+
+	hdr = dev_handoff_hdr(false);
+	if (!hdr)
+		return NULL;
+	rec = dev_handoff_find_rec(hdr, dev_handoff_key(dev), tag);
+	if (!rec || rec->size != size)
+		return NULL;
+
+	return rec + 1;
+}
+
+void dev_handoff_drop(struct udevice *dev, uint tag)
+{
+	struct dev_handoff_hdr *hdr;
+	struct dev_handoff_rec *rec;
+
+	hdr = dev_handoff_hdr(false);
+	if (!hdr)
+		return;
+	rec = dev_handoff_find_rec(hdr, dev_handoff_key(dev), tag);
+	if (rec)
+		dev_handoff_remove_rec(hdr, rec);
+}
@@ -8,6 +8,7 @@
 
 #include <common.h>
 #include <errno.h>
+#include <dm/bind-table.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -15,8 +16,11 @@
 #include <dm/uclass.h>
 #include <dm/util.h>
 #include <fdtdec.h>
+#include <malloc.h>
 #include <linux/compiler.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 struct driver *lists_driver_lookup_name(const char *name)
 {
 	struct driver *drv =
@@ -122,11 +126,170 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   bool pre_reloc_only)
+#if CONFIG_IS_ENABLED(OF_INDEX)
+/**
+ * struct compat_entry - Entry in the driver compatible-string index
+ *
+ * @of_id:	of_match entry containing the compatible string
+ * @drv:	Driver which owns the of_match entry
+ * @next:	Index of the next entry in the same hash bucket, or -1
+ */
+struct compat_entry {
+	const struct udevice_id *of_id;
+	struct driver *drv;
+	int next;
+};
+
+/* These are in .data since they may be set before relocation */
+static struct compat_entry *compat_index __section(".data");
+static int *compat_buckets __section(".data");
+static uint compat_bucket_mask __section(".data");
+/* true if the index is in the full malloc() area, false if in the early one */
+static bool compat_index_full __section(".data");
+/* true if the early malloc() area had no room for the index */
+static bool compat_index_no_room __section(".data");
+
+/* FNV-1a, which is small and spreads compatible strings well enough */
+static uint compat_hash(const char *str)
+{
+	uint hash = 2166136261u;
+
+	while (*str)
+		hash = (hash ^ (u8)*str++) * 16777619u;
+
+	return hash;
+}
+
+static int compat_index_find(const char *compat)
+{
+	int i;
+
+	for (i = compat_buckets[compat_hash(compat) & compat_bucket_mask];
+	     i != -1; i = compat_index[i].next) {
+		if (!strcmp(compat_index[i].of_id->compatible, compat))
+			return i;
+	}
+
+	return -1;
+}
+
+/**
+ * lists_build_compat_index() - Hash every compatible string of every driver
+ *
+ * Drivers are added in linker-list order and only the first driver to
+ * claim a compatible string is recorded, so lookups give the same answer
+ * as a linear scan of the driver list.
+ *
+ * Before full malloc() is ready, the index is only built if it takes no
+ * more than a quarter of what is left of the early malloc() area, which
+ * cannot be freed and is needed for the devices themselves.
+ *
+ * @full:	true if full malloc() is ready
+ * @return 0 if OK, -ENOMEM if out of memory or there is not enough room
+ */
+static int lists_build_compat_index(bool full)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_id;
+	struct driver *entry;
+	int count = 0, nbuckets, i, slot;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_id = entry->of_match; of_id && of_id->compatible;
+		     of_id++)
+			count++;
+	}
+	for (nbuckets = 16; nbuckets < count; nbuckets <<= 1)
+		;
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	if (!full && (count * sizeof(*compat_index) +
+		      nbuckets * sizeof(*compat_buckets)) * 4 >
+		     gd->malloc_limit - gd->malloc_ptr)
+		return -ENOMEM;
+#endif
+
+	compat_index = malloc(count * sizeof(*compat_index));
+	compat_buckets = malloc(nbuckets * sizeof(*compat_buckets));
+	if (!compat_index || !compat_buckets) {
+		free(compat_index);
+		free(compat_buckets);
+		compat_index = NULL;
+		compat_buckets = NULL;
+		return -ENOMEM;
+	}
+	compat_bucket_mask = nbuckets - 1;
+	compat_index_full = full;
+	for (i = 0; i < nbuckets; i++)
+		compat_buckets[i] = -1;
+
+	i = 0;
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_id = entry->of_match; of_id && of_id->compatible;
+		     of_id++) {
+			if (compat_index_find(of_id->compatible) != -1)
+				continue;
+			slot = compat_hash(of_id->compatible) &
+				compat_bucket_mask;
+			compat_index[i].of_id = of_id;
+			compat_index[i].drv = entry;
+			compat_index[i].next = compat_buckets[slot];
+			compat_buckets[slot] = i++;
+		}
+	}
+	debug("%s: %d compatible strings in %d buckets\n", __func__, i,
+	      nbuckets);
+
+	return 0;
+}
+#endif
+
+/**
+ * lists_driver_lookup_compat() - Find the driver for a compatible string
+ *
+ * @compat:	Compatible string to look up
+ * @of_idp:	Returns the of_match entry that was found
+ * @return driver, or NULL if no driver matches
+ */
+static struct driver *lists_driver_lookup_compat(const char *compat,
+					const struct udevice_id **of_idp)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	bool full = gd->flags & GD_FLG_FULL_MALLOC_INIT;
+	int i;
+
+	/*
+	 * An index in the early malloc() area is lost once full malloc() is
+	 * ready, e.g. on relocation, so build it again there. If the early
+	 * area has no room, do not try for every compatible string.
+	 */
+	if (compat_index && compat_index_full != full)
+		compat_index = NULL;
+	if (!compat_index && (full || !compat_index_no_room))
+		compat_index_no_room = lists_build_compat_index(full) != 0;
+	if (compat_index) {
+		i = compat_index_find(compat);
+		if (i == -1)
+			return NULL;
+		*of_idp = compat_index[i].of_id;
+
+		return compat_index[i].drv;
+	}
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, of_idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -163,13 +326,8 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		pr_debug("   - attempt to match compatible string '%s'\n",
 			 compat);
 
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
-		}
-		if (entry == driver + n_ents)
+		entry = lists_driver_lookup_compat(compat, &id);
+		if (!entry)
 			continue;
 
 		if (pre_reloc_only) {
@@ -202,4 +360,55 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 
 	return result;
 }
+
+#if CONFIG_IS_ENABLED(OF_BIND_TABLE)
+int lists_bind_table(struct udevice *parent, const struct dm_bind_node *bnode,
+		     bool pre_reloc_only)
+{
+	const struct dm_bind_driver *bdrv, *end;
+	ofnode node = offset_to_ofnode(bnode->offset);
+	const struct udevice_id *id;
+	struct udevice *dev;
+	int compat_idx = -1;
+	int ret;
+
+	bdrv = &dm_bind_table.drivers[bnode->first_driver];
+	end = bdrv + bnode->num_drivers;
+	for (; bdrv < end; bdrv++) {
+		struct driver *entry = bdrv->drv;
+
+		/*
+		 * Drivers for each compatible string are in linker-list order,
+		 * so as with lists_bind_fdt() only the first one built in is
+		 * tried. Its of_match entry may be compiled out, so check.
+		 */
+		if (!entry || bdrv->compat_idx == compat_idx)
+			continue;
+		if (driver_check_compatible(entry->of_match, &id, bdrv->compat))
+			continue;
+		compat_idx = bdrv->compat_idx;
+
+		if (pre_reloc_only && !(bnode->flags & DM_BIND_PRE_RELOC) &&
+		    !(entry->flags & DM_FLAG_PRE_RELOC))
+			return 0;
+
+		pr_debug("   - found match at '%s'\n", entry->name);
+		ret = device_bind_with_driver_data(parent, entry,
+						   ofnode_get_name(node),
+						   id->data, node, &dev);
+		if (ret == -ENODEV) {
+			pr_debug("Driver '%s' refuses to bind\n", entry->name);
+			continue;
+		}
+		if (ret) {
+			dm_warn("Error binding driver '%s': %d\n", entry->name,
+				ret);
+			return ret;
+		}
+		break;
+	}
+
+	return 0;
+}
+#endif
 #endif
@@ -43,6 +43,21 @@ static struct device_node *of_stdout;
 /* pointer to options given after the alias (separated by :) or NULL if none */
 static const char *of_stdout_options;
 
+#if CONFIG_IS_ENABLED(OF_INDEX)
+/*
+ * Largest phandle value we are prepared to index. dtc allocates phandles
+ * densely from 1, so this is only hit by hand-written trees using sparse
+ * values, which then fall back to a linear search.
+ */
+#define OF_PHANDLE_CACHE_MAX	0x10000
+
+/* table of nodes indexed by phandle value */
+static struct device_node **of_phandle_cache;
+
+/* number of entries in of_phandle_cache */
+static phandle of_phandle_cache_size;
+#endif
+
 /**
  * struct alias_prop - Alias property in 'aliases' node
  *
@@ -410,6 +425,13 @@ struct device_node *of_find_node_by_phandle(phandle handle)
 	if (!handle)
 		return NULL;
 
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	if (handle < of_phandle_cache_size) {
+		np = of_phandle_cache[handle];
+		if (np && np->phandle == handle)
+			return of_node_get(np);
+	}
+#endif
 	for_each_of_allnodes(np)
 		if (np->phandle == handle)
 			break;
@@ -816,3 +838,35 @@ struct device_node *of_get_stdout(void)
 {
 	return of_stdout;
 }
+
+#if CONFIG_IS_ENABLED(OF_INDEX)
+int of_populate_phandle_cache(void)
+{
+	struct device_node *np;
+	phandle max = 0;
+
+	free(of_phandle_cache);
+	of_phandle_cache = NULL;
+	of_phandle_cache_size = 0;
+
+	for_each_of_allnodes(np) {
+		if (np->phandle > max)
+			max = np->phandle;
+	}
+	if (!max || max >= OF_PHANDLE_CACHE_MAX)
+		return 0;
+
+	of_phandle_cache = calloc(max + 1, sizeof(*of_phandle_cache));
+	if (!of_phandle_cache)
+		return -ENOMEM;
+	of_phandle_cache_size = max + 1;
+
+	for_each_of_allnodes(np) {
+		if (np->phandle)
+			of_phandle_cache[np->phandle] = np;
+	}
+	debug("%s: indexed %u phandles\n", __func__, max);
+
+	return 0;
+}
+#endif
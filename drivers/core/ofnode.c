@@ -8,6 +8,7 @@
 #include <dm.h>
 #include <fdtdec.h>
 #include <fdt_support.h>
+#include <malloc.h>
 #include <linux/libfdt.h>
 #include <dm/of_access.h>
 #include <dm/of_addr.h>
@@ -226,8 +227,8 @@ ofnode ofnode_get_by_phandle(uint phandle)
 	if (of_live_active())
 		node = np_to_ofnode(of_find_node_by_phandle(phandle));
 	else
-		node.of_offset = fdt_node_offset_by_phandle(gd->fdt_blob,
-							    phandle);
+		node.of_offset = fdtdec_node_offset_by_phandle(gd->fdt_blob,
+							       phandle);
 
 	return node;
 }
@@ -404,8 +405,119 @@ int ofnode_count_phandle_with_args(ofnode node, const char *list_name,
 				0, -1, NULL);
 }
 
+#if CONFIG_IS_ENABLED(OF_INDEX)
+#define OFNODE_PATH_CACHE_SIZE	8
+
+/**
+ * struct ofnode_path_entry - A recently resolved absolute path
+ *
+ * @path:	Copy of the path that was looked up
+ * @node:	Node that it resolved to
+ */
+struct ofnode_path_entry {
+	char *path;
+	ofnode node;
+};
+
+static struct ofnode_path_entry ofnode_path_cache[OFNODE_PATH_CACHE_SIZE];
+static int ofnode_path_next;
+
+/* tree (live root or flat blob) which the cache entries refer to */
+static const void *ofnode_path_tree;
+
+/**
+ * ofnode_path_entry_valid() - Check a cached flat-tree node is still there
+ *
+ * Offsets in a flat tree move if the tree is edited, so check that the
+ * node at the cached offset still has the cached path. Each component must
+ * match, allowing for an omitted unit address as libfdt does.
+ */
+static bool ofnode_path_entry_valid(struct ofnode_path_entry *entry)
+{
+	const char *want = entry->path, *have;
+	char buf[256];
+	int wlen, hlen;
+
+	if (of_live_active())
+		return true;
+	if (fdt_get_path(gd->fdt_blob, ofnode_to_offset(entry->node), buf,
+			 sizeof(buf)))
+		return false;
+
+	have = buf;
+	while (*want == '/' && *have == '/') {
+		want++;
+		have++;
+		wlen = strchrnul(want, '/') - want;
+		hlen = strchrnul(have, '/') - have;
+		if (strncmp(have, want, wlen))
+			return false;
+		if (hlen != wlen &&
+		    (have[wlen] != '@' || memchr(want, '@', wlen)))
+			return false;
+		want += wlen;
+		have += hlen;
+	}
+
+	return !*want && !*have;
+}
+
+static ofnode ofnode_path_lookup(const char *path)
+{
+	struct ofnode_path_entry *entry;
+	const void *tree;
+	ofnode node;
+	int i;
+
+	tree = gd->fdt_blob;
+#ifdef CONFIG_OF_LIVE
+	if (of_live_active())
+		tree = gd->of_root;
+#endif
+	if (tree != ofnode_path_tree) {
+		for (i = 0; i < OFNODE_PATH_CACHE_SIZE; i++) {
+			free(ofnode_path_cache[i].path);
+			ofnode_path_cache[i].path = NULL;
+		}
+		ofnode_path_tree = tree;
+	}
+
+	for (i = 0; i < OFNODE_PATH_CACHE_SIZE; i++) {
+		entry = &ofnode_path_cache[i];
+		if (entry->path && !strcmp(entry->path, path)) {
+			if (ofnode_path_entry_valid(entry))
+				return entry->node;
+			break;
+		}
+	}
+
+	if (of_live_active())
+		node = np_to_ofnode(of_find_node_by_path(path));
+	else
+		node = offset_to_ofnode(fdt_path_offset(gd->fdt_blob, path));
+	if (!ofnode_valid(node))
+		return node;
+
+	if (i == OFNODE_PATH_CACHE_SIZE) {
+		i = ofnode_path_next;
+		ofnode_path_next = (i + 1) % OFNODE_PATH_CACHE_SIZE;
+		entry = &ofnode_path_cache[i];
+		free(entry->path);
+		entry->path = strdup(path);
+	}
+	entry->node = node;
+
+	return node;
+}
+#endif
+
 ofnode ofnode_path(const char *path)
 {
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	/* Only absolute paths are cached, as aliases can be changed */
+	if (*path == '/' && !strchr(path, ':') && (gd->flags & GD_FLG_RELOC))
+		return ofnode_path_lookup(path);
+#endif
 	if (of_live_active())
 		return np_to_ofnode(of_find_node_by_path(path));
 	else
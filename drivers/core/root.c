@@ -11,6 +11,7 @@
 #include <fdtdec.h>
 #include <malloc.h>
 #include <linux/libfdt.h>
+#include <dm/bind-table.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -192,6 +193,82 @@ int dm_uninit(void)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+/* How far to follow provider references from a preloaded device */
+#define DM_PRELOAD_MAX_DEPTH	4
+
+/* Provider properties whose targets are probed before a preloaded device */
+static const struct {
+	const char *list_name;
+	const char *cells_name;
+} dm_preload_deps[] = {
+	{ "power-domains", "#power-domain-cells" },
+	{ "clocks", "#clock-cells" },
+	{ "resets", "#reset-cells" },
+};
+
+static int dm_probe_node(ofnode node, int depth)
+{
+	struct ofnode_phandle_args args;
+	struct udevice *dev;
+	int i, j, ret;
+
+	if (depth > DM_PRELOAD_MAX_DEPTH)
+		return -ELOOP;
+
+	for (i = 0; i < ARRAY_SIZE(dm_preload_deps); i++) {
+		for (j = 0; ; j++) {
+			ret = ofnode_parse_phandle_with_args(node,
+					dm_preload_deps[i].list_name,
+					dm_preload_deps[i].cells_name, 0, j,
+					&args);
+			if (ret)
+				break;
+			/* A provider may be bound under a different node */
+			ret = dm_probe_node(args.node, depth + 1);
+			if (ret && ret != -ENODEV)
+				debug("%s: provider %s: err=%d\n", __func__,
+				      ofnode_get_name(args.node), ret);
+		}
+	}
+
+	return device_get_global_by_ofnode(node, &dev);
+}
+
+int dm_probe_preload(void)
+{
+	struct ofnode_phandle_args args;
+	const char *prop = "u-boot,dm-preload";
+	char name[64];
+	ofnode chosen;
+	int count, i, ret;
+
+	chosen = ofnode_path("/chosen");
+	if (!ofnode_valid(chosen))
+		return 0;
+	if (*CONFIG_DM_PRELOAD_PROFILE) {
+		snprintf(name, sizeof(name), "%s-%s", prop,
+			 CONFIG_DM_PRELOAD_PROFILE);
+		if (ofnode_read_bool(chosen, name))
+			prop = name;
+	}
+
+	count = ofnode_count_phandle_with_args(chosen, prop, NULL);
+	for (i = 0; i < count; i++) {
+		ret = ofnode_parse_phandle_with_args(chosen, prop, NULL, 0, i,
+						     &args);
+		if (ret)
+			continue;
+		ret = dm_probe_node(args.node, 0);
+		if (ret)
+			dm_warn("Cannot preload device '%s': err=%d\n",
+				ofnode_get_name(args.node), ret);
+	}
+
+	return 0;
+}
+#endif
+
 #if CONFIG_IS_ENABLED(DM_DEVICE_REMOVE)
 int dm_remove_devices_flags(uint flags)
 {
@@ -253,6 +330,51 @@ static int dm_scan_fdt_live(struct udevice *parent,
 #endif /* CONFIG_IS_ENABLED(OF_LIVE) */
 
 #if CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)
+#if CONFIG_IS_ENABLED(OF_BIND_TABLE)
+/**
+ * dm_scan_bind_table() - Bind drivers for the subnodes of a bind-table node
+ *
+ * This does the same as dm_scan_fdt_node() but uses the table generated at
+ * build time, so does not need to look at the device tree or driver list.
+ *
+ * @parent: Parent device for the devices that will be created
+ * @bnode: Bind-table entry of the node to scan
+ * @pre_reloc_only: If true, bind only drivers with the DM_FLAG_PRE_RELOC
+ * flag. If false bind all drivers.
+ * @return 0 if OK, -ve on error
+ */
+static int dm_scan_bind_table(struct udevice *parent,
+			      const struct dm_bind_node *bnode,
+			      bool pre_reloc_only)
+{
+	const struct dm_bind_node *nodes = dm_bind_table.nodes;
+	int ret = 0, err;
+	int i;
+
+	for (i = bnode->first_child; i >= 0; i = nodes[i].next_sibling) {
+		const struct dm_bind_node *child = &nodes[i];
+
+		if (child->flags & DM_BIND_CONTAINER) {
+			err = dm_scan_bind_table(parent, child, pre_reloc_only);
+			if (err && !ret)
+				ret = err;
+			continue;
+		}
+		if (child->flags & DM_BIND_DISABLED)
+			continue;
+		err = lists_bind_table(parent, child, pre_reloc_only);
+		if (err && !ret) {
+			ret = err;
+			debug("%s: ret=%d\n", fdt_get_name(gd->fdt_blob,
+							   child->offset, NULL),
+			      ret);
+		}
+	}
+
+	return ret;
+}
+#endif
+
 /**
  * dm_scan_fdt_node() - Scan the device tree and bind drivers for a node
  *
@@ -271,6 +393,19 @@ static int dm_scan_fdt_node(struct udevice *parent, const void *blob,
 {
 	int ret = 0, err;
 
+#if CONFIG_IS_ENABLED(OF_BIND_TABLE)
+	if (dm_bind_table_valid(blob)) {
+		const struct dm_bind_node *bnode = dm_bind_table_find(offset);
+
+		if (bnode) {
+			ret = dm_scan_bind_table(parent, bnode, pre_reloc_only);
+			if (ret)
+				dm_warn("Some drivers failed to bind\n");
+			return ret;
+		}
+	}
+#endif
+
 	for (offset = fdt_first_subnode(blob, offset);
 	     offset > 0;
 	     offset = fdt_next_subnode(blob, offset)) {
@@ -19,6 +19,260 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/* log2 of the number of hash buckets for a new uclass */
+#define UCLASS_INDEX_MIN_BITS	2
+
+/* Number of sequence numbers to allow for in a new uclass */
+#define UCLASS_INDEX_MIN_SEQ	8
+
+/**
+ * struct uclass_index - Lookup tables for the devices in a uclass
+ *
+ * Devices are hashed by name and by device tree node once they are bound.
+ * Some drivers change these, or their requested sequence number, later
+ * on. So a hit in @name_hash, @node_hash or @req_seq is always checked
+ * against the device and a miss falls back to walking the uclass.
+ * Sequence numbers of probed devices are only set through
+ * uclass_set_seq(), so @seq is exact.
+ *
+ * Devices are added to the front of the hash chains in the order they are
+ * bound, so the last match in a chain is the first match in the uclass.
+ *
+ * @name_hash:	Devices by name, linked through udevice->name_hnode
+ * @node_hash:	Devices by node, linked through udevice->node_hnode
+ * @hash_bits:	log2 of the number of buckets in each hash table
+ * @count:	Number of devices in the hash tables
+ * @seq:	Probed device with each sequence number, or NULL
+ * @req_seq:	Device requesting each sequence number, or NULL
+ * @seq_size:	Number of entries in @seq and @req_seq
+ */
+struct uclass_index {
+	struct hlist_head *name_hash;
+	struct hlist_head *node_hash;
+	uint hash_bits;
+	uint count;
+	struct udevice **seq;
+	struct udevice **req_seq;
+	int seq_size;
+};
+
+/* FNV-1a, as used for the compatible-string index */
+static uint uclass_hash_name(const char *name, uint bits)
+{
+	uint hash = 2166136261u;
+
+	while (*name)
+		hash = (hash ^ (u8)*name++) * 16777619u;
+
+	return hash & ((1 << bits) - 1);
+}
+
+/* Offsets and pointers are aligned, so use the top bits of the product */
+static uint uclass_hash_node(ofnode node, uint bits)
+{
+	return ((u32)node.of_offset * 0x9e3779b9u) >> (32 - bits);
+}
+
+static void uclass_index_hash(struct uclass_index *idx, struct udevice *dev)
+{
+	uint bits = idx->hash_bits;
+
+	hlist_add_head(&dev->name_hnode,
+		       &idx->name_hash[uclass_hash_name(dev->name, bits)]);
+	if (ofnode_valid(dev->node))
+		hlist_add_head(&dev->node_hnode,
+			       &idx->node_hash[uclass_hash_node(dev->node,
+								bits)]);
+	idx->count++;
+}
+
+/* Drop the index after running out of memory, so lookups walk the uclass */
+static void uclass_index_free(struct uclass *uc)
+{
+	struct uclass_index *idx = uc->index;
+	struct udevice *dev;
+
+	if (!idx)
+		return;
+	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+		INIT_HLIST_NODE(&dev->name_hnode);
+		INIT_HLIST_NODE(&dev->node_hnode);
+	}
+	free(idx->name_hash);
+	free(idx->node_hash);
+	free(idx->seq);
+	free(idx->req_seq);
+	free(idx);
+	uc->index = NULL;
+}
+
+/*
+ * Move every device in the uclass to new hash tables. This includes any
+ * which are still being bound, in the order they were bound.
+ */
+static int uclass_index_rehash(struct uclass *uc, uint bits)
+{
+	struct uclass_index *idx = uc->index;
+	struct hlist_head *name_hash, *node_hash;
+	struct udevice *dev;
+
+	name_hash = calloc(1 << bits, sizeof(*name_hash));
+	node_hash = calloc(1 << bits, sizeof(*node_hash));
+	if (!name_hash || !node_hash) {
+		free(name_hash);
+		free(node_hash);
+		return -ENOMEM;
+	}
+	free(idx->name_hash);
+	free(idx->node_hash);
+	idx->name_hash = name_hash;
+	idx->node_hash = node_hash;
+	idx->hash_bits = bits;
+	idx->count = 0;
+	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+		INIT_HLIST_NODE(&dev->name_hnode);
+		INIT_HLIST_NODE(&dev->node_hnode);
+		uclass_index_hash(idx, dev);
+	}
+
+	return 0;
+}
+
+/* Make sure that the sequence tables have an entry for @seq */
+static int uclass_index_grow_seq(struct uclass_index *idx, int seq)
+{
+	struct udevice **seqs, **req_seqs;
+	int size;
+
+	if (seq < idx->seq_size)
+		return 0;
+	size = max3(idx->seq_size * 2, seq + 1, UCLASS_INDEX_MIN_SEQ);
+	size = min(size, DM_MAX_SEQ + 1);
+
+	/* realloc() is not available before relocation */
+	seqs = calloc(size, sizeof(*seqs));
+	req_seqs = calloc(size, sizeof(*req_seqs));
+	if (!seqs || !req_seqs) {
+		free(seqs);
+		free(req_seqs);
+		return -ENOMEM;
+	}
+	if (idx->seq_size) {
+		memcpy(seqs, idx->seq, idx->seq_size * sizeof(*seqs));
+		memcpy(req_seqs, idx->req_seq,
+		       idx->seq_size * sizeof(*req_seqs));
+	}
+	free(idx->seq);
+	free(idx->req_seq);
+	idx->seq = seqs;
+	idx->req_seq = req_seqs;
+	idx->seq_size = size;
+
+	return 0;
+}
+
+static bool uclass_index_valid_seq(int seq)
+{
+	return seq >= 0 && seq <= DM_MAX_SEQ;
+}
+
+void uclass_index_device(struct udevice *dev)
+{
+	struct uclass *uc = dev->uclass;
+	struct uclass_index *idx = uc->index;
+	int ret = 0;
+
+	if (!idx)
+		return;
+	if (hlist_unhashed(&dev->name_hnode)) {
+		if (idx->count >= 1 << idx->hash_bits)
+			ret = uclass_index_rehash(uc, idx->hash_bits + 1);
+		else
+			uclass_index_hash(idx, dev);
+	}
+	if (!ret && uclass_index_valid_seq(dev->req_seq)) {
+		ret = uclass_index_grow_seq(idx, dev->req_seq);
+		if (!ret && !idx->req_seq[dev->req_seq])
+			idx->req_seq[dev->req_seq] = dev;
+	}
+	if (ret)
+		uclass_index_free(uc);
+}
+
+static void uclass_index_remove(struct udevice *dev)
+{
+	struct uclass_index *idx = dev->uclass->index;
+	int i;
+
+	if (!idx)
+		return;
+	if (!hlist_unhashed(&dev->name_hnode))
+		idx->count--;
+	hlist_del_init(&dev->name_hnode);
+	hlist_del_init(&dev->node_hnode);
+
+	/* The driver may have changed the requested sequence number */
+	for (i = 0; i < idx->seq_size; i++) {
+		if (idx->seq[i] == dev)
+			idx->seq[i] = NULL;
+		if (idx->req_seq[i] == dev)
+			idx->req_seq[i] = NULL;
+	}
+}
+
+static struct udevice *uclass_index_find_name(struct uclass_index *idx,
+					      const char *name)
+{
+	struct udevice *dev, *found = NULL;
+	struct hlist_node *pos;
+	uint hash = uclass_hash_name(name, idx->hash_bits);
+
+	hlist_for_each_entry(dev, pos, &idx->name_hash[hash], name_hnode) {
+		if (!strcmp(dev->name, name))
+			found = dev;
+	}
+
+	return found;
+}
+
+static struct udevice *uclass_index_find_node(struct uclass_index *idx,
+					      ofnode node)
+{
+	struct udevice *dev, *found = NULL;
+	struct hlist_node *pos;
+	uint hash = uclass_hash_node(node, idx->hash_bits);
+
+	hlist_for_each_entry(dev, pos, &idx->node_hash[hash], node_hnode) {
+		if (ofnode_equal(dev->node, node))
+			found = dev;
+	}
+
+	return found;
+}
+#endif
+
+void uclass_set_seq(struct udevice *dev, int seq)
+{
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct uclass *uc = dev->uclass;
+	struct uclass_index *idx = uc->index;
+
+	if (idx) {
+		if (uclass_index_valid_seq(dev->seq) &&
+		    dev->seq < idx->seq_size && idx->seq[dev->seq] == dev)
+			idx->seq[dev->seq] = NULL;
+		if (uclass_index_valid_seq(seq)) {
+			if (uclass_index_grow_seq(idx, seq))
+				uclass_index_free(uc);
+			else
+				idx->seq[seq] = dev;
+		}
+	}
+#endif
+	dev->seq = seq;
+}
+
 struct uclass *uclass_find(enum uclass_id key)
 {
 	struct uclass *uc;
@@ -80,6 +334,16 @@ static int uclass_add(enum uclass_id id, struct uclass **ucp)
 	INIT_LIST_HEAD(&uc->dev_head);
 	list_add(&uc->sibling_node, &DM_UCLASS_ROOT_NON_CONST);
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	/* Without the index, lookups walk the uclass, so ignore errors */
+	if (gd->flags & GD_FLG_FULL_MALLOC_INIT) {
+		uc->index = calloc(1, sizeof(*uc->index));
+		if (uc->index &&
+		    uclass_index_rehash(uc, UCLASS_INDEX_MIN_BITS))
+			uclass_index_free(uc);
+	}
+#endif
+
 	if (uc_drv->init) {
 		ret = uc_drv->init(uc);
 		if (ret)
@@ -90,6 +354,9 @@ static int uclass_add(enum uclass_id id, struct uclass **ucp)
 
 	return 0;
 fail:
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	uclass_index_free(uc);
+#endif
 	if (uc_drv->priv_auto_alloc_size) {
 		free(uc->priv);
 		uc->priv = NULL;
@@ -127,6 +394,9 @@ int uclass_destroy(struct uclass *uc)
 	uc_drv = uc->uc_drv;
 	if (uc_drv->destroy)
 		uc_drv->destroy(uc);
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	uclass_index_free(uc);
+#endif
 	list_del(&uc->sibling_node);
 	if (uc_drv->priv_auto_alloc_size)
 		free(uc->priv);
@@ -259,14 +529,24 @@ int uclass_find_device_by_name(enum uclass_id id, const char *name,
 	if (ret)
 		return ret;
 
+	/* An exact match takes priority; otherwise use the first prefix */
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	if (uc->index) {
+		*devp = uclass_index_find_name(uc->index, name);
+		if (*devp)
+			return 0;
+	}
+#endif
 	uclass_foreach_dev(dev, uc) {
-		if (!strncmp(dev->name, name, strlen(name))) {
+		if (!strcmp(dev->name, name)) {
 			*devp = dev;
 			return 0;
 		}
+		if (!*devp && !strncmp(dev->name, name, strlen(name)))
+			*devp = dev;
 	}
 
-	return -ENODEV;
+	return *devp ? 0 : -ENODEV;
 }
 
 #if !CONFIG_IS_ENABLED(OF_CONTROL) || CONFIG_IS_ENABLED(OF_PLATDATA)
@@ -308,6 +588,26 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq_or_req_seq,
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	if (uc->index && uclass_index_valid_seq(seq_or_req_seq)) {
+		struct uclass_index *idx = uc->index;
+
+		if (seq_or_req_seq >= idx->seq_size)
+			dev = NULL;
+		else if (find_req_seq)
+			dev = idx->req_seq[seq_or_req_seq];
+		else
+			dev = idx->seq[seq_or_req_seq];
+		if (dev && find_req_seq && dev->req_seq != seq_or_req_seq)
+			dev = NULL;
+		/* Only the probed sequence numbers are known to be exact */
+		if (dev || !find_req_seq) {
+			*devp = dev;
+			debug("   - %s\n", dev ? "found" : "not found");
+			return dev ? 0 : -ENODEV;
+		}
+	}
+#endif
 	uclass_foreach_dev(dev, uc) {
 		debug("   - %d %d '%s'\n", dev->req_seq, dev->seq, dev->name);
 		if ((find_req_seq ? dev->req_seq : dev->seq) ==
@@ -361,6 +661,13 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	if (uc->index) {
+		*devp = uclass_index_find_node(uc->index, node);
+		if (*devp)
+			goto done;
+	}
+#endif
 	uclass_foreach_dev(dev, uc) {
 		log(LOGC_DM, LOGL_DEBUG_CONTENT, "      - checking %s\n",
 		    dev->name);
@@ -663,6 +970,9 @@ int uclass_unbind_device(struct udevice *dev)
 			return ret;
 	}
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	uclass_index_remove(dev);
+#endif
 	list_del(&dev->uclass_node);
 	return 0;
 }
@@ -483,6 +483,55 @@ static int davinci_gpio_set_value(struct udevice *dev, unsigned int offset,
 	return 0;
 }
 
+/* Get the 32 bits of a GPIO bitmap which belong to the bank at 'offset' */
+static u32 davinci_gpio_bits(const ulong *map, unsigned int offset)
+{
+	return map[BIT_WORD(offset)] >> (offset % BITS_PER_LONG);
+}
+
+static int davinci_gpio_get_values(struct udevice *dev, const ulong *mask,
+				   ulong *values)
+{
+	struct gpio_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct davinci_gpio *base;
+	unsigned int offset;
+
+	memset(values, '\0',
+	       BITS_TO_LONGS(uc_priv->gpio_count) * sizeof(ulong));
+	for (offset = 0; offset < uc_priv->gpio_count; offset += 32) {
+		if (!davinci_gpio_bits(mask, offset))
+			continue;
+		base = davinci_get_gpio_bank(dev, offset);
+		values[BIT_WORD(offset)] |= (ulong)in_le32(&base->in_data) <<
+			(offset % BITS_PER_LONG);
+	}
+
+	return 0;
+}
+
+static int davinci_gpio_set_values(struct udevice *dev, const ulong *mask,
+				   const ulong *values)
+{
+	struct gpio_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct davinci_gpio *base;
+	unsigned int offset;
+	u32 bits, val;
+
+	for (offset = 0; offset < uc_priv->gpio_count; offset += 32) {
+		bits = davinci_gpio_bits(mask, offset);
+		if (!bits)
+			continue;
+		base = davinci_get_gpio_bank(dev, offset);
+		val = davinci_gpio_bits(values, offset);
+		if (bits & val)
+			out_le32(&base->set_data, bits & val);
+		if (bits & ~val)
+			out_le32(&base->clr_data, bits & ~val);
+	}
+
+	return 0;
+}
+
 static int davinci_gpio_get_function(struct udevice *dev, unsigned int offset)
 {
 	unsigned int dir;
@@ -515,6 +564,8 @@ static const struct dm_gpio_ops gpio_davinci_ops = {
 	.set_value		= davinci_gpio_set_value,
 	.get_function		= davinci_gpio_get_function,
 	.xlate			= davinci_gpio_xlate,
+	.get_values		= davinci_gpio_get_values,
+	.set_values		= davinci_gpio_set_values,
 };
 
 static int davinci_gpio_probe(struct udevice *dev)
@@ -15,6 +15,30 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Number of entries in the GPIO name cache, must be a power of two */
+#define GPIO_NAME_CACHE_SIZE	16
+
+/* Space for a cached GPIO name, including the terminator */
+#define GPIO_NAME_CACHE_LEN	16
+
+/* Largest bank which dm_gpios_get/set_values() pass to the driver as a whole */
+#define GPIO_BULK_MAX		256
+
+/**
+ * struct gpio_name_entry - A remembered result of dm_gpio_lookup_name()
+ *
+ * The cache is held in the uclass-private data, allocated after relocation.
+ *
+ * @name: Name that was looked up, or an empty string if the entry is unused
+ * @dev: GPIO device which the name refers to
+ * @offset: Offset of the GPIO within @dev
+ */
+struct gpio_name_entry {
+	char name[GPIO_NAME_CACHE_LEN];
+	struct udevice *dev;
+	uint offset;
+};
+
 /**
  * gpio_to_device() - Convert global GPIO number to device, number
  *
@@ -49,14 +73,68 @@ static int gpio_to_device(unsigned int gpio, struct gpio_desc *desc)
 	return ret ? ret : -ENOENT;
 }
 
+/**
+ * gpio_name_entry() - Find the name-cache entry to use for a GPIO name
+ *
+ * This allocates the cache the first time it is needed.
+ *
+ * @name:	GPIO name to look up
+ * @return cache entry for @name (which may hold a different name), or NULL
+ * if the name cannot be cached
+ */
+static struct gpio_name_entry *gpio_name_entry(const char *name)
+{
+	struct uclass *uc;
+	const char *p;
+	uint hash;
+
+	if (!CONFIG_IS_ENABLED(GPIO_NAME_CACHE) || !(gd->flags & GD_FLG_RELOC))
+		return NULL;
+	if (strlen(name) >= GPIO_NAME_CACHE_LEN || uclass_get(UCLASS_GPIO, &uc))
+		return NULL;
+	if (!uc->priv) {
+		uc->priv = calloc(GPIO_NAME_CACHE_SIZE,
+				  sizeof(struct gpio_name_entry));
+		if (!uc->priv)
+			return NULL;
+	}
+
+	/* FNV-1a */
+	hash = 2166136261u;
+	for (p = name; *p; p++)
+		hash = (hash ^ (u8)*p) * 16777619;
+
+	return (struct gpio_name_entry *)uc->priv +
+		(hash & (GPIO_NAME_CACHE_SIZE - 1));
+}
+
+/*
+ * Empty the name cache. This is needed whenever a bank is probed or removed,
+ * since that changes the GPIO numbering and which banks can match a name.
+ */
+static void gpio_name_cache_flush(struct udevice *dev)
+{
+	if (dev->uclass->priv)
+		memset(dev->uclass->priv, '\0',
+		       GPIO_NAME_CACHE_SIZE * sizeof(struct gpio_name_entry));
+}
+
 int dm_gpio_lookup_name(const char *name, struct gpio_desc *desc)
 {
 	struct gpio_dev_priv *uc_priv = NULL;
+	struct gpio_name_entry *entry;
 	struct udevice *dev;
 	ulong offset;
 	int numeric;
 	int ret;
 
+	entry = gpio_name_entry(name);
+	if (entry && !strcmp(entry->name, name)) {
+		desc->dev = entry->dev;
+		desc->offset = entry->offset;
+		return 0;
+	}
+
 	numeric = isdigit(*name) ? simple_strtoul(name, NULL, 10) : -1;
 	for (ret = uclass_first_device(UCLASS_GPIO, &dev);
 	     dev;
@@ -84,6 +162,11 @@ int dm_gpio_lookup_name(const char *name, struct gpio_desc *desc)
 
 	desc->dev = dev;
 	desc->offset = offset;
+	if (entry) {
+		strcpy(entry->name, name);
+		entry->dev = dev;
+		entry->offset = offset;
+	}
 
 	return 0;
 }
@@ -365,6 +448,161 @@ int dm_gpio_set_value(const struct gpio_desc *desc, int value)
 	return 0;
 }
 
+/**
+ * gpio_bulk_mask() - Find the GPIOs in a list which share a device
+ *
+ * @desc_list:	List of GPIOs
+ * @count:	Number of GPIOs in @desc_list
+ * @first:	Index of the first GPIO to consider; its device is the one
+ *		collected
+ * @mask:	Returns a bitmap of the offsets of the GPIOs within the device
+ * @return bitmap of the indexes in @desc_list of the GPIOs which were found
+ */
+static ulong gpio_bulk_mask(const struct gpio_desc *desc_list, int count,
+			    int first, ulong *mask)
+{
+	struct udevice *dev = desc_list[first].dev;
+	ulong found = 0;
+	uint offset;
+	int i;
+
+	memset(mask, '\0', BITS_TO_LONGS(GPIO_BULK_MAX) * sizeof(ulong));
+	for (i = first; i < count; i++) {
+		if (desc_list[i].dev != dev)
+			continue;
+		offset = desc_list[i].offset;
+		mask[BIT_WORD(offset)] |= BIT_MASK(offset);
+		found |= BIT(i);
+	}
+
+	return found;
+}
+
+/* Check that a list of GPIOs can be used with dm_gpios_get/set_values() */
+static int gpio_bulk_check(const struct gpio_desc *desc_list, int count,
+			   const char *func)
+{
+	int ret, i;
+
+	if (count < 0 || count > BITS_PER_LONG)
+		return -EINVAL;
+	for (i = 0; i < count; i++) {
+		ret = check_reserved(&desc_list[i], func);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Check whether a GPIO's bank should be passed to the driver as a whole */
+static bool gpio_bulk_ok(const struct gpio_desc *desc, bool set)
+{
+	struct dm_gpio_ops *ops = gpio_get_ops(desc->dev);
+	struct gpio_dev_priv *uc_priv = dev_get_uclass_priv(desc->dev);
+
+	if (uc_priv->gpio_count > GPIO_BULK_MAX)
+		return false;
+
+	return set ? ops->set_values != NULL : ops->get_values != NULL;
+}
+
+int dm_gpios_get_values(const struct gpio_desc *desc_list, int count,
+			ulong *valuesp)
+{
+	ulong mask[BITS_TO_LONGS(GPIO_BULK_MAX)];
+	ulong bits[BITS_TO_LONGS(GPIO_BULK_MAX)];
+	const struct gpio_desc *desc;
+	ulong values = 0, done = 0, group;
+	struct dm_gpio_ops *ops;
+	int ret, value, i, j;
+
+	ret = gpio_bulk_check(desc_list, count, "get_values");
+	if (ret)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		desc = &desc_list[i];
+		if (done & BIT(i))
+			continue;
+		ops = gpio_get_ops(desc->dev);
+		if (!gpio_bulk_ok(desc, false)) {
+			value = ops->get_value(desc->dev, desc->offset);
+			if (value < 0)
+				return value;
+			if (!value != !(desc->flags & GPIOD_ACTIVE_LOW))
+				values |= BIT(i);
+			continue;
+		}
+
+		group = gpio_bulk_mask(desc_list, count, i, mask);
+		ret = ops->get_values(desc->dev, mask, bits);
+		if (ret)
+			return ret;
+		for (j = i; j < count; j++) {
+			uint offset = desc_list[j].offset;
+
+			if (!(group & BIT(j)))
+				continue;
+			value = !!(bits[BIT_WORD(offset)] & BIT_MASK(offset));
+			if (!value != !(desc_list[j].flags & GPIOD_ACTIVE_LOW))
+				values |= BIT(j);
+		}
+		done |= group;
+	}
+	*valuesp = values;
+
+	return 0;
+}
+
+int dm_gpios_set_values(const struct gpio_desc *desc_list, int count,
+			ulong values)
+{
+	ulong mask[BITS_TO_LONGS(GPIO_BULK_MAX)];
+	ulong bits[BITS_TO_LONGS(GPIO_BULK_MAX)];
+	const struct gpio_desc *desc;
+	ulong done = 0, group;
+	struct dm_gpio_ops *ops;
+	int ret, value, i, j;
+
+	ret = gpio_bulk_check(desc_list, count, "set_values");
+	if (ret)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		desc = &desc_list[i];
+		if (done & BIT(i))
+			continue;
+		ops = gpio_get_ops(desc->dev);
+		if (!gpio_bulk_ok(desc, true)) {
+			value = !(values & BIT(i)) ==
+				!(desc->flags & GPIOD_ACTIVE_LOW);
+			ret = ops->set_value(desc->dev, desc->offset, value);
+			if (ret)
+				return ret;
+			continue;
+		}
+
+		group = gpio_bulk_mask(desc_list, count, i, mask);
+		memset(bits, '\0', sizeof(bits));
+		for (j = i; j < count; j++) {
+			uint offset = desc_list[j].offset;
+
+			if (!(group & BIT(j)))
+				continue;
+			if (!(values & BIT(j)) != !(desc_list[j].flags &
+						     GPIOD_ACTIVE_LOW))
+				bits[BIT_WORD(offset)] |= BIT_MASK(offset);
+		}
+		ret = ops->set_values(desc->dev, mask, bits);
+		if (ret)
+			return ret;
+		done |= group;
+	}
+
+	return 0;
+}
+
 int dm_gpio_get_open_drain(struct gpio_desc *desc)
 {
 	struct dm_gpio_ops *ops = gpio_get_ops(desc->dev);
@@ -624,20 +862,17 @@ int gpio_get_values_as_int(const int *gpio_list)
 
 int dm_gpio_get_values_as_int(const struct gpio_desc *desc_list, int count)
 {
-	unsigned bitmask = 1;
-	unsigned vector = 0;
-	int ret, i;
+	ulong values;
+	int ret;
 
-	for (i = 0; i < count; i++) {
-		ret = dm_gpio_get_value(&desc_list[i]);
-		if (ret < 0)
-			return ret;
-		else if (ret)
-			vector |= bitmask;
-		bitmask <<= 1;
-	}
+	/* Only as many GPIOs as fit in an unsigned int can be returned */
+	ret = dm_gpios_get_values(desc_list,
+				  min_t(int, count, sizeof(uint) * 8),
+				  &values);
+	if (ret)
+		return ret;
 
-	return vector;
+	return (uint)values;
 }
 
 static int gpio_request_tail(int ret, ofnode node,
@@ -836,6 +1071,7 @@ static int gpio_post_probe(struct udevice *dev)
 	uc_priv->name = calloc(uc_priv->gpio_count, sizeof(char *));
 	if (!uc_priv->name)
 		return -ENOMEM;
+	gpio_name_cache_flush(dev);
 
 	return gpio_renumber(NULL);
 }
@@ -850,10 +1086,20 @@ static int gpio_pre_remove(struct udevice *dev)
 			free(uc_priv->name[i]);
 	}
 	free(uc_priv->name);
+	gpio_name_cache_flush(dev);
 
 	return gpio_renumber(dev);
 }
 
+static int gpio_uclass_destroy(struct uclass *uc)
+{
+	/* The name cache is allocated by gpio_name_entry() */
+	free(uc->priv);
+	uc->priv = NULL;
+
+	return 0;
+}
+
 static int gpio_post_bind(struct udevice *dev)
 {
 #if defined(CONFIG_NEEDS_MANUAL_RELOC)
@@ -881,6 +1127,10 @@ static int gpio_post_bind(struct udevice *dev)
 			ops->get_function += gd->reloc_off;
 		if (ops->xlate)
 			ops->xlate += gd->reloc_off;
+		if (ops->get_values)
+			ops->get_values += gd->reloc_off;
+		if (ops->set_values)
+			ops->set_values += gd->reloc_off;
 
 		reloc_done++;
 	}
@@ -895,5 +1145,6 @@ UCLASS_DRIVER(gpio) = {
 	.post_probe	= gpio_post_probe,
 	.post_bind	= gpio_post_bind,
 	.pre_remove	= gpio_pre_remove,
+	.destroy	= gpio_uclass_destroy,
 	.per_device_auto_alloc_size = sizeof(struct gpio_dev_priv),
 };
@@ -264,6 +264,36 @@ static int omap_gpio_set_value(struct udevice *dev, unsigned offset,
 	return 0;
 }
 
+/* read the GPIOs in 'mask', using DATAOUT for outputs as get_value() does */
+static int omap_gpio_get_values(struct udevice *dev, const ulong *mask,
+				ulong *values)
+{
+	struct gpio_bank *bank = dev_get_priv(dev);
+	u32 oe;
+
+	oe = __raw_readl(bank->base + OMAP_GPIO_OE);
+	values[0] = (__raw_readl(bank->base + OMAP_GPIO_DATAIN) & oe) |
+		(__raw_readl(bank->base + OMAP_GPIO_DATAOUT) & ~oe);
+
+	return 0;
+}
+
+/* write the GPIOs in 'mask' with one access to each of SET/CLEARDATAOUT */
+static int omap_gpio_set_values(struct udevice *dev, const ulong *mask,
+				const ulong *values)
+{
+	struct gpio_bank *bank = dev_get_priv(dev);
+	u32 set = mask[0] & values[0];
+	u32 clear = mask[0] & ~values[0];
+
+	if (set)
+		__raw_writel(set, bank->base + OMAP_GPIO_SETDATAOUT);
+	if (clear)
+		__raw_writel(clear, bank->base + OMAP_GPIO_CLEARDATAOUT);
+
+	return 0;
+}
+
 static int omap_gpio_get_function(struct udevice *dev, unsigned offset)
 {
 	struct gpio_bank *bank = dev_get_priv(dev);
@@ -281,6 +311,8 @@ static const struct dm_gpio_ops gpio_omap_ops = {
 	.get_value		= omap_gpio_get_value,
 	.set_value		= omap_gpio_set_value,
 	.get_function		= omap_gpio_get_function,
+	.get_values		= omap_gpio_get_values,
+	.set_values		= omap_gpio_set_values,
 };
 
 static int omap_gpio_probe(struct udevice *dev)
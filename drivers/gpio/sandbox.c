@@ -156,6 +156,50 @@ static int sb_gpio_set_open_drain(struct udevice *dev, unsigned offset, int valu
 	return sandbox_gpio_set_open_drain(dev, offset, value);
 }
 
+/* read GPIO IN values of the ports in 'mask' */
+static int sb_gpio_get_values(struct udevice *dev, const ulong *mask,
+			      ulong *values)
+{
+	struct gpio_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+	uint offset;
+
+	for (offset = 0; offset < uc_priv->gpio_count; offset++) {
+		if (!(mask[BIT_WORD(offset)] & BIT_MASK(offset)))
+			continue;
+		if (sandbox_gpio_get_value(dev, offset))
+			values[BIT_WORD(offset)] |= BIT_MASK(offset);
+		else
+			values[BIT_WORD(offset)] &= ~BIT_MASK(offset);
+	}
+
+	return 0;
+}
+
+/* write GPIO OUT values to the ports in 'mask', all or none */
+static int sb_gpio_set_values(struct udevice *dev, const ulong *mask,
+			      const ulong *values)
+{
+	struct gpio_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+	uint offset;
+
+	for (offset = 0; offset < uc_priv->gpio_count; offset++) {
+		if ((mask[BIT_WORD(offset)] & BIT_MASK(offset)) &&
+		    !sandbox_gpio_get_direction(dev, offset)) {
+			printf("sandbox_gpio: error: set_values on input gpio %u\n",
+			       offset);
+			return -1;
+		}
+	}
+	for (offset = 0; offset < uc_priv->gpio_count; offset++) {
+		if (mask[BIT_WORD(offset)] & BIT_MASK(offset))
+			sandbox_gpio_set_value(dev, offset,
+					       !!(values[BIT_WORD(offset)] &
+						  BIT_MASK(offset)));
+	}
+
+	return 0;
+}
+
 static int sb_gpio_get_function(struct udevice *dev, unsigned offset)
 {
 	if (get_gpio_flag(dev, offset, GPIOF_OUTPUT))
@@ -190,6 +234,8 @@ static const struct dm_gpio_ops gpio_sandbox_ops = {
 	.set_open_drain		= sb_gpio_set_open_drain,
 	.get_function		= sb_gpio_get_function,
 	.xlate			= sb_gpio_xlate,
+	.get_values		= sb_gpio_get_values,
+	.set_values		= sb_gpio_set_values,
 };
 
 static int sandbox_gpio_ofdata_to_platdata(struct udevice *dev)
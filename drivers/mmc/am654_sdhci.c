@@ -30,6 +30,12 @@
 #define PHY_STAT1	0x130
 #define PHY_STAT2	0x134
 
+#define ITAPDLYSEL_SHIFT	0
+#define ITAPDLYSEL_MASK		GENMASK(4, 0)
+#define ITAPDLYENA_SHIFT	8
+#define ITAPDLYENA_MASK		BIT(ITAPDLYENA_SHIFT)
+#define ITAPCHGWIN_SHIFT	9
+#define ITAPCHGWIN_MASK		BIT(ITAPCHGWIN_SHIFT)
 #define IOMUX_ENABLE_SHIFT	31
 #define IOMUX_ENABLE_MASK	BIT(IOMUX_ENABLE_SHIFT)
 #define OTAPDLYENA_SHIFT	20
@@ -67,6 +73,9 @@
 
 #define SDHCI_TUNING_LOOP_COUNT	40
 
+/* Number of input tap delays to try when tuning */
+#define AM654_SDHCI_ITAP_COUNT	32
+
 struct am654_sdhci_plat {
 	struct mmc_config cfg;
 	struct mmc mmc;
@@ -75,9 +84,101 @@ struct am654_sdhci_plat {
 	u32 otap_del_sel;
 	u32 trm_icp;
 	u32 drv_strength;
+	u32 itap_del_sel;
 	bool dll_on;
 };
 
+#if CONFIG_IS_ENABLED(MMC_TUNING_HANDOFF)
+/* Select an input tap delay, or turn it off if @enable is false */
+static void am654_sdhci_write_itapdly(struct am654_sdhci_plat *plat,
+				      bool enable, u32 itap)
+{
+	u32 val = enable ? ITAPDLYENA_MASK | (itap << ITAPDLYSEL_SHIFT) : 0;
+
+	/* The tap can only be changed with the change window open */
+	regmap_update_bits(plat->base, PHY_CTRL4, ITAPCHGWIN_MASK,
+			   ITAPCHGWIN_MASK);
+	regmap_update_bits(plat->base, PHY_CTRL4,
+			   ITAPDLYENA_MASK | ITAPDLYSEL_MASK, val);
+	regmap_update_bits(plat->base, PHY_CTRL4, ITAPCHGWIN_MASK, 0);
+}
+
+/*
+ * Try each input tap delay and use the one in the middle of the longest run
+ * of taps which read the tuning block correctly. Recording the tap (rather
+ * than using the controller's own tuning) lets a later boot phase restore it
+ * with am654_sdhci_set_tuning().
+ */
+static int am654_sdhci_execute_tuning(struct mmc *mmc, u8 opcode)
+{
+	struct am654_sdhci_plat *plat = dev_get_platdata(mmc->dev);
+	int start = -1, best = 0, best_len = 0;
+	int itap;
+
+	debug("%s\n", __func__);
+
+	for (itap = 0; itap < AM654_SDHCI_ITAP_COUNT; itap++) {
+		am654_sdhci_write_itapdly(plat, true, itap);
+		if (mmc_send_tuning(mmc, opcode, NULL)) {
+			start = -1;
+			continue;
+		}
+		if (start < 0)
+			start = itap;
+		if (itap - start + 1 > best_len) {
+			best = start;
+			best_len = itap - start + 1;
+		}
+	}
+
+	if (!best_len) {
+		/* Do not leave the last tap tried in place for other modes */
+		am654_sdhci_write_itapdly(plat, false, 0);
+		printf("%s:Tuning failed\n", __func__);
+		return -EIO;
+	}
+
+	plat->itap_del_sel = best + best_len / 2;
+	am654_sdhci_write_itapdly(plat, true, plat->itap_del_sel);
+
+	return 0;
+}
+
+static int am654_sdhci_get_tuning(struct mmc *mmc, u32 *data)
+{
+	struct am654_sdhci_plat *plat = dev_get_platdata(mmc->dev);
+
+	data[0] = plat->itap_del_sel;
+
+	return 0;
+}
+
+static int am654_sdhci_set_tuning(struct mmc *mmc, const u32 *data)
+{
+	struct am654_sdhci_plat *plat = dev_get_platdata(mmc->dev);
+
+	if (data[0] >= AM654_SDHCI_ITAP_COUNT)
+		return -EINVAL;
+	plat->itap_del_sel = data[0];
+	am654_sdhci_write_itapdly(plat, true, plat->itap_del_sel);
+
+	return 0;
+}
+
+/* Turn off the input tap delay for modes which are not tuned */
+static void am654_sdhci_check_itapdly(struct am654_sdhci_plat *plat,
+				      enum bus_mode mode)
+{
+	switch (mode) {
+	case MMC_HS_200:
+	case MMC_HS_400:
+	case UHS_SDR104:
+		break;
+	default:
+		am654_sdhci_write_itapdly(plat, false, 0);
+	}
+}
+#else
 static int am654_sdhci_execute_tuning(struct mmc *mmc, u8 opcode)
 {
 	struct mmc_cmd cmd;
@@ -147,6 +248,12 @@ static int am654_sdhci_execute_tuning(struct mmc *mmc, u8 opcode)
 	return 0;
 }
 
+static inline void am654_sdhci_check_itapdly(struct am654_sdhci_plat *plat,
+					     enum bus_mode mode)
+{
+}
+#endif
+
 static void am654_sdhci_set_control_reg(struct sdhci_host *host)
 {
 	struct mmc *mmc = (struct mmc *)host->mmc;
@@ -237,6 +344,7 @@ static int am654_sdhci_set_ios_post(struct sdhci_host *host)
 
 		plat->dll_on = true;
 	}
+	am654_sdhci_check_itapdly(plat, host->mmc->selected_mode);
 
 	return 0;
 }
@@ -245,6 +353,10 @@ const struct sdhci_ops am654_sdhci_ops = {
 	.set_ios_post		= &am654_sdhci_set_ios_post,
 	.set_control_reg	= &am654_sdhci_set_control_reg,
 	.platform_execute_tuning = &am654_sdhci_execute_tuning,
+#if CONFIG_IS_ENABLED(MMC_TUNING_HANDOFF)
+	.platform_get_tuning	= &am654_sdhci_get_tuning,
+	.platform_set_tuning	= &am654_sdhci_set_tuning,
+#endif
 };
 
 int am654_sdhci_init(struct am654_sdhci_plat *plat)
@@ -118,6 +118,24 @@ int mmc_execute_tuning(struct mmc *mmc, uint opcode)
 {
 	return dm_mmc_execute_tuning(mmc->dev, opcode);
 }
+
+int dm_mmc_get_tuning(struct udevice *dev, u32 *data)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->get_tuning)
+		return -ENOSYS;
+	return ops->get_tuning(dev, data);
+}
+
+int dm_mmc_set_tuning(struct udevice *dev, const u32 *data)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->set_tuning)
+		return -ENOSYS;
+	return ops->set_tuning(dev, data);
+}
 #endif
 
 int mmc_of_parse(struct udevice *dev, struct mmc_config *cfg)
@@ -200,6 +218,11 @@ struct mmc *find_mmc_device(int dev_num)
 	}
 
 	mmc_dev = dev_get_parent(dev);
+	ret = device_probe(mmc_dev);
+	if (ret) {
+		debug("%s: probe failed: %d\n", mmc_dev->name, ret);
+		return NULL;
+	}
 
 	struct mmc *mmc = mmc_get_mmc_dev(mmc_dev);
 
@@ -8,6 +8,7 @@
 
 #include <config.h>
 #include <common.h>
+#include <bloblist.h>
 #include <command.h>
 #include <dm.h>
 #include <dm/device-internal.h>
@@ -1843,8 +1844,24 @@ static const struct ext_csd_bus_width {
 	{MMC_MODE_1BIT, false, EXT_CSD_BUS_WIDTH_1},
 };
 
+#ifdef MMC_SUPPORTS_TUNING
+/*
+ * Tune the host for the current mode, or restore the tuning data in @rec if
+ * it is not NULL
+ */
+static int mmc_tune(struct mmc *mmc, uint opcode,
+		    const struct mmc_tuning_rec *rec)
+{
+#if CONFIG_IS_ENABLED(MMC_TUNING_HANDOFF)
+	if (rec)
+		return dm_mmc_set_tuning(mmc->dev, rec->data);
+#endif
+	return mmc_execute_tuning(mmc, opcode);
+}
+#endif
+
 #if CONFIG_IS_ENABLED(MMC_HS400_SUPPORT)
-static int mmc_select_hs400(struct mmc *mmc)
+static int mmc_select_hs400(struct mmc *mmc, const struct mmc_tuning_rec *rec)
 {
 	int err;
 
@@ -1858,7 +1875,7 @@ static int mmc_select_hs400(struct mmc *mmc)
 	mmc_set_clock(mmc, mmc->tran_speed, false);
 
 	/* execute tuning if needed */
-	err = mmc_execute_tuning(mmc, MMC_CMD_SEND_TUNING_BLOCK_HS200);
+	err = mmc_tune(mmc, MMC_CMD_SEND_TUNING_BLOCK_HS200, rec);
 	if (err) {
 		debug("tuning failed\n");
 		return err;
@@ -1885,7 +1902,7 @@ static int mmc_select_hs400(struct mmc *mmc)
 	return 0;
 }
 #else
-static int mmc_select_hs400(struct mmc *mmc)
+static int mmc_select_hs400(struct mmc *mmc, const struct mmc_tuning_rec *rec)
 {
 	return -ENOTSUPP;
 }
@@ -1897,6 +1914,279 @@ static int mmc_select_hs400(struct mmc *mmc)
 	    ecbv++) \
 		if ((ddr == ecbv->is_ddr) && (caps & ecbv->cap))
 
+/**
+ * mmc_try_mode_and_width() - Switch to a bus mode and width and check it
+ *
+ * On failure the card and host are put back into legacy mode with a 1-bit
+ * bus.
+ *
+ * @mmc:	MMC device to set up
+ * @mwt:	Mode to use
+ * @ecbw:	Bus width to use
+ * @rec:	Tuning data to restore, or NULL to tune the host if the mode
+ *		needs it
+ * @return 0 if OK, -ve on error
+ */
+static int mmc_try_mode_and_width(struct mmc *mmc,
+				  const struct mode_width_tuning *mwt,
+				  const struct ext_csd_bus_width *ecbw,
+				  const struct mmc_tuning_rec *rec)
+{
+	enum mmc_voltage old_voltage;
+	int err;
+
+	pr_debug("trying mode %s width %d (at %d MHz)\n",
+		 mmc_mode_name(mwt->mode), bus_width(ecbw->cap),
+		 mmc_mode2freq(mmc, mwt->mode) / 1000000);
+	old_voltage = mmc->signal_voltage;
+	err = mmc_set_lowest_voltage(mmc, mwt->mode, MMC_ALL_SIGNAL_VOLTAGE);
+	if (err)
+		return err;
+
+	/* configure the bus width (card + host) */
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_BUS_WIDTH,
+			 ecbw->ext_csd_bits & ~EXT_CSD_DDR_FLAG);
+	if (err)
+		goto error;
+	mmc_set_bus_width(mmc, bus_width(ecbw->cap));
+
+	if (mwt->mode == MMC_HS_400) {
+		err = mmc_select_hs400(mmc, rec);
+		if (err) {
+			printf("Select HS400 failed %d\n", err);
+			goto error;
+		}
+	} else {
+		/* configure the bus speed (card) */
+		err = mmc_set_card_speed(mmc, mwt->mode);
+		if (err)
+			goto error;
+
+		/*
+		 * configure the bus width AND the ddr mode (card). The host
+		 * side will be taken care of in the next step
+		 */
+		if (ecbw->ext_csd_bits & EXT_CSD_DDR_FLAG) {
+			err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
+					 EXT_CSD_BUS_WIDTH, ecbw->ext_csd_bits);
+			if (err)
+				goto error;
+		}
+
+		/* configure the bus mode (host) */
+		mmc_select_mode(mmc, mwt->mode);
+		mmc_set_clock(mmc, mmc->tran_speed, MMC_CLK_ENABLE);
+#ifdef MMC_SUPPORTS_TUNING
+
+		/* execute tuning if needed */
+		if (mwt->tuning) {
+			err = mmc_tune(mmc, mwt->tuning, rec);
+			if (err) {
+				pr_debug("tuning failed\n");
+				goto error;
+			}
+		}
+#endif
+	}
+
+	/* do a transfer to check the configuration */
+	err = mmc_read_and_compare_ext_csd(mmc);
+	if (!err)
+		return 0;
+error:
+	mmc_set_signal_voltage(mmc, old_voltage);
+	/* if an error occurred, revert to a safer bus mode */
+	mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
+		   EXT_CSD_BUS_WIDTH, EXT_CSD_BUS_WIDTH_1);
+	mmc_select_mode(mmc, MMC_LEGACY);
+	mmc_set_bus_width(mmc, 1);
+
+	return err;
+}
+
+#if CONFIG_IS_ENABLED(MMC_TUNING_HANDOFF)
+/**
+ * mmc_tuning_handoff() - Find the tuning results from earlier boot phases
+ *
+ * @create: true to create the record in the bloblist if it does not exist,
+ *	or has an unexpected layout
+ * @return pointer to the record, or NULL if none
+ */
+static struct mmc_tuning_handoff *mmc_tuning_handoff(bool create)
+{
+	struct mmc_tuning_handoff *ho;
+
+	if (create)
+		ho = bloblist_ensure(BLOBLISTT_MMC_TUNING, sizeof(*ho));
+	else
+		ho = bloblist_find(BLOBLISTT_MMC_TUNING, sizeof(*ho));
+	if (!ho)
+		return NULL;
+	if (ho->version != MMC_TUNING_VERSION || ho->count > MMC_TUNING_MAX) {
+		if (!create)
+			return NULL;
+		memset(ho, '\0', sizeof(*ho));
+		ho->version = MMC_TUNING_VERSION;
+	}
+
+	return ho;
+}
+
+/* Find the record for a card, whatever the host capabilities */
+static struct mmc_tuning_rec *mmc_tuning_find_cid(struct mmc_tuning_handoff *ho,
+						  struct mmc *mmc)
+{
+	int i;
+
+	for (i = 0; i < ho->count; i++) {
+		if (!memcmp(ho->rec[i].cid, mmc->cid, sizeof(mmc->cid)))
+			return &ho->rec[i];
+	}
+
+	return NULL;
+}
+
+struct mmc_tuning_rec *mmc_tuning_find(struct mmc *mmc)
+{
+	struct mmc_tuning_handoff *ho;
+	struct mmc_tuning_rec *rec;
+
+	ho = mmc_tuning_handoff(false);
+	if (!ho)
+		return NULL;
+	rec = mmc_tuning_find_cid(ho, mmc);
+	if (!rec || rec->host_caps != mmc->host_caps)
+		return NULL;
+
+	return rec;
+}
+
+int mmc_tuning_put(struct mmc *mmc, uint mode, uint ext_csd_bits,
+		   const u32 *data)
+{
+	struct mmc_tuning_handoff *ho;
+	struct mmc_tuning_rec *rec;
+
+	ho = mmc_tuning_handoff(true);
+	if (!ho)
+		return -ENOENT;
+	rec = mmc_tuning_find_cid(ho, mmc);
+	if (!rec) {
+		if (ho->count == MMC_TUNING_MAX)
+			return -ENOSPC;
+		rec = &ho->rec[ho->count++];
+	}
+
+	memset(rec, '\0', sizeof(*rec));
+	memcpy(rec->cid, mmc->cid, sizeof(rec->cid));
+	rec->host_caps = mmc->host_caps;
+	rec->mode = mode;
+	rec->ext_csd_bits = ext_csd_bits;
+	if (data) {
+		memcpy(rec->data, data, sizeof(rec->data));
+		rec->flags |= MMC_TUNINGF_DATA;
+	}
+
+	return 0;
+}
+
+void mmc_tuning_drop(struct mmc *mmc)
+{
+	struct mmc_tuning_handoff *ho;
+	struct mmc_tuning_rec *rec;
+
+	ho = mmc_tuning_handoff(false);
+	if (!ho)
+		return;
+	rec = mmc_tuning_find_cid(ho, mmc);
+	if (rec)
+		*rec = ho->rec[--ho->count];
+}
+
+/**
+ * mmc_tuning_save() - Record the selected mode for later boot phases
+ *
+ * If the mode needs tuning but the driver cannot provide the result, any
+ * existing record for the card is dropped, since it is no longer valid.
+ *
+ * @mmc:	MMC device which has been set up
+ * @mwt:	Mode in use
+ * @ecbw:	Bus width in use
+ */
+static void mmc_tuning_save(struct mmc *mmc,
+			    const struct mode_width_tuning *mwt,
+			    const struct ext_csd_bus_width *ecbw)
+{
+	u32 data[MMC_TUNING_WORDS];
+
+	if (!mwt->tuning) {
+		mmc_tuning_put(mmc, mwt->mode, ecbw->ext_csd_bits, NULL);
+		return;
+	}
+	memset(data, '\0', sizeof(data));
+	if (dm_mmc_get_tuning(mmc->dev, data))
+		mmc_tuning_drop(mmc);
+	else
+		mmc_tuning_put(mmc, mwt->mode, ecbw->ext_csd_bits, data);
+}
+
+/**
+ * mmc_tuning_restore() - Select the mode recorded by an earlier boot phase
+ *
+ * The record is only used if it is for the same card on a host with the same
+ * capabilities, and the mode and width are still available. The result is
+ * checked with a transfer, as with normal mode selection.
+ *
+ * @mmc:	MMC device to set up
+ * @card_caps:	Capabilities of the card, restricted to those of the host
+ * @return 0 if OK, -ENOENT if there is no usable record, other -ve on error
+ */
+static int mmc_tuning_restore(struct mmc *mmc, uint card_caps)
+{
+	const struct mode_width_tuning *mwt;
+	const struct ext_csd_bus_width *ecbw;
+	struct mmc_tuning_rec *rec;
+	int ret;
+
+	rec = mmc_tuning_find(mmc);
+	if (!rec)
+		return -ENOENT;
+
+	for_each_mmc_mode_by_pref(card_caps, mwt) {
+		if (mwt->mode != rec->mode)
+			continue;
+		if (mwt->tuning && !(rec->flags & MMC_TUNINGF_DATA))
+			return -ENOENT;
+		for_each_supported_width(card_caps & mwt->widths,
+					 mmc_is_mode_ddr(mwt->mode), ecbw) {
+			if (ecbw->ext_csd_bits != rec->ext_csd_bits)
+				continue;
+			ret = mmc_try_mode_and_width(mmc, mwt, ecbw,
+						     mwt->tuning ? rec : NULL);
+			if (ret) {
+				pr_debug("recorded mode %s failed (err=%d)\n",
+					 mmc_mode_name(mwt->mode), ret);
+			}
+
+			return ret;
+		}
+	}
+
+	return -ENOENT;
+}
+#else
+static inline void mmc_tuning_save(struct mmc *mmc,
+				   const struct mode_width_tuning *mwt,
+				   const struct ext_csd_bus_width *ecbw)
+{
+}
+
+static inline int mmc_tuning_restore(struct mmc *mmc, uint card_caps)
+{
+	return -ENOENT;
+}
+#endif
+
 static int mmc_select_mode_and_width(struct mmc *mmc, uint card_caps)
 {
 	int err;
@@ -1922,83 +2212,18 @@ static int mmc_select_mode_and_width(struct mmc *mmc, uint card_caps)
 
 	mmc_set_clock(mmc, mmc->legacy_speed, MMC_CLK_ENABLE);
 
+	/* Skip the search and tuning if an earlier phase has done it */
+	if (!mmc_tuning_restore(mmc, card_caps))
+		return 0;
+
 	for_each_mmc_mode_by_pref(card_caps, mwt) {
 		for_each_supported_width(card_caps & mwt->widths,
 					 mmc_is_mode_ddr(mwt->mode), ecbw) {
-			enum mmc_voltage old_voltage;
-			pr_debug("trying mode %s width %d (at %d MHz)\n",
-				 mmc_mode_name(mwt->mode),
-				 bus_width(ecbw->cap),
-				 mmc_mode2freq(mmc, mwt->mode) / 1000000);
-			old_voltage = mmc->signal_voltage;
-			err = mmc_set_lowest_voltage(mmc, mwt->mode,
-						     MMC_ALL_SIGNAL_VOLTAGE);
-			if (err)
-				continue;
-
-			/* configure the bus width (card + host) */
-			err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
-				    EXT_CSD_BUS_WIDTH,
-				    ecbw->ext_csd_bits & ~EXT_CSD_DDR_FLAG);
-			if (err)
-				goto error;
-			mmc_set_bus_width(mmc, bus_width(ecbw->cap));
-
-			if (mwt->mode == MMC_HS_400) {
-				err = mmc_select_hs400(mmc);
-				if (err) {
-					printf("Select HS400 failed %d\n", err);
-					goto error;
-				}
-			} else {
-				/* configure the bus speed (card) */
-				err = mmc_set_card_speed(mmc, mwt->mode);
-				if (err)
-					goto error;
-
-				/*
-				 * configure the bus width AND the ddr mode
-				 * (card). The host side will be taken care
-				 * of in the next step
-				 */
-				if (ecbw->ext_csd_bits & EXT_CSD_DDR_FLAG) {
-					err = mmc_switch(mmc,
-							 EXT_CSD_CMD_SET_NORMAL,
-							 EXT_CSD_BUS_WIDTH,
-							 ecbw->ext_csd_bits);
-					if (err)
-						goto error;
-				}
-
-				/* configure the bus mode (host) */
-				mmc_select_mode(mmc, mwt->mode);
-				mmc_set_clock(mmc, mmc->tran_speed,
-					      MMC_CLK_ENABLE);
-#ifdef MMC_SUPPORTS_TUNING
-
-				/* execute tuning if needed */
-				if (mwt->tuning) {
-					err = mmc_execute_tuning(mmc,
-								 mwt->tuning);
-					if (err) {
-						pr_debug("tuning failed\n");
-						goto error;
-					}
-				}
-#endif
-			}
-
-			/* do a transfer to check the configuration */
-			err = mmc_read_and_compare_ext_csd(mmc);
-			if (!err)
+			err = mmc_try_mode_and_width(mmc, mwt, ecbw, NULL);
+			if (!err) {
+				mmc_tuning_save(mmc, mwt, ecbw);
 				return 0;
-error:
-			mmc_set_signal_voltage(mmc, old_voltage);
-			/* if an error occured, revert to a safer bus mode */
-			mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
-				   EXT_CSD_BUS_WIDTH, EXT_CSD_BUS_WIDTH_1);
-			mmc_select_mode(mmc, MMC_LEGACY);
-			mmc_set_bus_width(mmc, 1);
+			}
 		}
 	}
 
@@ -2776,6 +3001,10 @@ static int mmc_probe(bd_t *bis)
 	if (ret)
 		return ret;
 
+	/* Controllers are probed by find_mmc_device() when first used */
+	if (CONFIG_IS_ENABLED(DM_DEFERRED_PROBE))
+		return 0;
+
 	/*
 	 * Try to add them in sequence order. Really with driver model we
 	 * should allow holes, but the current MMC list does not allow that.
@@ -2822,7 +3051,9 @@ int mmc_initialize(bd_t *bis)
 		return ret;
 
 #ifndef CONFIG_SPL_BUILD
-	print_mmc_devices(',');
+	/* Listing the devices would probe them all */
+	if (!CONFIG_IS_ENABLED(DM_DEFERRED_PROBE))
+		print_mmc_devices(',');
 #endif
 
 	mmc_do_preinit();
@@ -408,6 +408,28 @@ static int sdhci_execute_tuning(struct udevice *dev, uint opcode)
 	}
 	return 0;
 }
+
+static int sdhci_get_tuning(struct udevice *dev, u32 *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	if (!host->ops || !host->ops->platform_get_tuning)
+		return -ENOSYS;
+
+	return host->ops->platform_get_tuning(mmc, data);
+}
+
+static int sdhci_set_tuning(struct udevice *dev, const u32 *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	if (!host->ops || !host->ops->platform_set_tuning)
+		return -ENOSYS;
+
+	return host->ops->platform_set_tuning(mmc, data);
+}
 #endif
 int sdhci_set_clock(struct mmc *mmc, unsigned int clock)
 {
@@ -658,6 +680,8 @@ const struct dm_mmc_ops sdhci_ops = {
 	.set_ios	= sdhci_set_ios,
 #ifdef MMC_SUPPORTS_TUNING
 	.execute_tuning	= sdhci_execute_tuning,
+	.get_tuning	= sdhci_get_tuning,
+	.set_tuning	= sdhci_set_tuning,
 #endif
 };
 #else
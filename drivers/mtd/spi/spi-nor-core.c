@@ -10,6 +10,7 @@
  */
 
 #include <common.h>
+#include <dm/handoff.h>
 #include <linux/err.h>
 #include <linux/errno.h>
 #include <linux/log2.h>
@@ -1929,6 +1930,144 @@ static int spi_nor_parse_sfdp(struct spi_nor *nor,
 }
 #endif /* SPI_FLASH_SFDP_SUPPORT */
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_SFDP_SUPPORT) && CONFIG_IS_ENABLED(DM_HANDOFF)
+/*
+ * Passing the SFDP results to a later boot phase
+ */
+
+/* Quad Enable procedures, which are passed on by number */
+enum spi_nor_handoff_qe {
+	SNOR_HANDOFF_QE_NONE,
+	SNOR_HANDOFF_QE_SR2_BIT1_NO_RD,
+	SNOR_HANDOFF_QE_SR1_BIT6,
+	SNOR_HANDOFF_QE_SR2_BIT1,
+
+	SNOR_HANDOFF_QE_COUNT,
+};
+
+static int (*const spi_nor_handoff_qe[SNOR_HANDOFF_QE_COUNT])
+		(struct spi_nor *nor) = {
+#if defined(CONFIG_SPI_FLASH_SPANSION) || defined(CONFIG_SPI_FLASH_WINBOND)
+	[SNOR_HANDOFF_QE_SR2_BIT1_NO_RD] = spansion_no_read_cr_quad_enable,
+	[SNOR_HANDOFF_QE_SR2_BIT1] = spansion_read_cr_quad_enable,
+#endif
+#ifdef CONFIG_SPI_FLASH_MACRONIX
+	[SNOR_HANDOFF_QE_SR1_BIT6] = macronix_quad_enable,
+#endif
+};
+
+/**
+ * struct spi_nor_handoff - SFDP results saved with dev_handoff_save()
+ *
+ * @size: Flash size in bytes
+ * @page_size: Page size in bytes
+ * @hwcaps: SNOR_HWCAPS_... mask of supported commands
+ * @erasesize: Erase size from SFDP, or 0 if none
+ * @quad_enable: Quad Enable procedure (enum spi_nor_handoff_qe)
+ * @id: JEDEC ID of the flash, so the results are not used for another part
+ * @addr_width: Address width from SFDP, or 0 if none
+ * @erase_opcode: Erase opcode for @erasesize
+ * @reads: Read commands
+ * @page_programs: Page program commands
+ */
+struct spi_nor_handoff {
+	u64 size;
+	u32 page_size;
+	u32 hwcaps;
+	u32 erasesize;
+	u32 quad_enable;
+	u8 id[SPI_NOR_MAX_ID_LEN];
+	u8 addr_width;
+	u8 erase_opcode;
+	struct spi_nor_read_command reads[SNOR_CMD_READ_MAX];
+	struct spi_nor_pp_command page_programs[SNOR_CMD_PP_MAX];
+};
+
+static void spi_nor_handoff_save(struct spi_nor *nor,
+				 const struct flash_info *info,
+				 const struct spi_nor_flash_parameter *params)
+{
+	struct spi_nor_handoff ho;
+	int qe;
+
+	if (!nor->dev)
+		return;
+	for (qe = 0; qe < SNOR_HANDOFF_QE_COUNT; qe++) {
+		if (spi_nor_handoff_qe[qe] == params->quad_enable)
+			break;
+	}
+	if (qe == SNOR_HANDOFF_QE_COUNT)
+		return;
+
+	memset(&ho, '\0', sizeof(ho));
+	ho.size = params->size;
+	ho.page_size = params->page_size;
+	ho.hwcaps = params->hwcaps.mask;
+	ho.erasesize = nor->mtd.erasesize;
+	ho.quad_enable = qe;
+	memcpy(ho.id, info->id, info->id_len);
+	ho.addr_width = nor->addr_width;
+	ho.erase_opcode = nor->erase_opcode;
+	memcpy(ho.reads, params->reads, sizeof(ho.reads));
+	memcpy(ho.page_programs, params->page_programs,
+	       sizeof(ho.page_programs));
+	dev_handoff_save(nor->dev, DEV_HANDOFF_SPI_NOR, &ho, sizeof(ho));
+}
+
+/**
+ * spi_nor_handoff_restore() - Use SFDP results from an earlier boot phase
+ *
+ * @nor:	SPI NOR device
+ * @info:	Flash information from the JEDEC ID
+ * @params:	Returns the flash parameters, if found
+ * Return: 0 on success, -ENOENT if there are no results for this device,
+ * -EINVAL if they are for a different flash or cannot be used
+ */
+static int spi_nor_handoff_restore(struct spi_nor *nor,
+				   const struct flash_info *info,
+				   struct spi_nor_flash_parameter *params)
+{
+	const struct spi_nor_handoff *ho;
+
+	if (!nor->dev)
+		return -ENOENT;
+	ho = dev_handoff_find(nor->dev, DEV_HANDOFF_SPI_NOR, sizeof(*ho));
+	if (!ho)
+		return -ENOENT;
+	if (memcmp(ho->id, info->id, info->id_len) ||
+	    ho->quad_enable >= SNOR_HANDOFF_QE_COUNT ||
+	    (ho->quad_enable && !spi_nor_handoff_qe[ho->quad_enable]))
+		return -EINVAL;
+
+	params->size = ho->size;
+	params->page_size = ho->page_size;
+	params->hwcaps.mask = ho->hwcaps;
+	params->quad_enable = spi_nor_handoff_qe[ho->quad_enable];
+	memcpy(params->reads, ho->reads, sizeof(params->reads));
+	memcpy(params->page_programs, ho->page_programs,
+	       sizeof(params->page_programs));
+	nor->mtd.erasesize = ho->erasesize;
+	nor->addr_width = ho->addr_width;
+	nor->erase_opcode = ho->erase_opcode;
+	dev_dbg(nor->dev, "using SFDP parameters from earlier phase\n");
+
+	return 0;
+}
+#else
+static void spi_nor_handoff_save(struct spi_nor *nor,
+				 const struct flash_info *info,
+				 const struct spi_nor_flash_parameter *params)
+{
+}
+
+static int spi_nor_handoff_restore(struct spi_nor *nor,
+				   const struct flash_info *info,
+				   struct spi_nor_flash_parameter *params)
+{
+	return -ENOENT;
+}
+#endif
+
 static int spi_nor_init_params(struct spi_nor *nor,
 			       const struct flash_info *info,
 			       struct spi_nor_flash_parameter *params)
@@ -2015,11 +2154,14 @@ static int spi_nor_init_params(struct spi_nor *nor,
 		struct spi_nor_flash_parameter sfdp_params;
 
 		memcpy(&sfdp_params, params, sizeof(sfdp_params));
-		if (spi_nor_parse_sfdp(nor, &sfdp_params)) {
+		if (!spi_nor_handoff_restore(nor, info, &sfdp_params)) {
+			memcpy(params, &sfdp_params, sizeof(*params));
+		} else if (spi_nor_parse_sfdp(nor, &sfdp_params)) {
 			nor->addr_width = 0;
 			nor->mtd.erasesize = 0;
 		} else {
 			memcpy(params, &sfdp_params, sizeof(*params));
+			spi_nor_handoff_save(nor, info, params);
 		}
 	}
 
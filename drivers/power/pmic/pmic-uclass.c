@@ -12,9 +12,241 @@
 #include <dm/lists.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
+#include <malloc.h>
 #include <power/pmic.h>
+#include <linux/bitops.h>
 #include <linux/ctype.h>
 
+/**
+ * struct pmic_reg_cache - cached copy of the registers of a PMIC
+ *
+ * This is only used for PMICs with single-byte registers, so that a byte
+ * buffer passed to pmic_read()/pmic_write() maps directly onto the cache.
+ *
+ * @count:	Number of registers
+ * @batch:	Nesting depth of pmic_batch_start(), writes are held back
+ *		while this is non-zero
+ * @burst:	true if consecutive registers may be written in one transfer
+ * @vals:	Register values
+ * @valid:	Bitmap of registers whose value in @vals is known
+ * @dirty:	Bitmap of registers whose value in @vals has not been written
+ *		to the device yet
+ * @volatile_regs: Bitmap of registers which are never cached
+ */
+struct pmic_reg_cache {
+	int count;
+	int batch;
+	bool burst;
+	u8 *vals;
+	ulong *valid;
+	ulong *dirty;
+	ulong *volatile_regs;
+};
+
+static bool pmic_cache_test(const ulong *map, uint reg)
+{
+	return map[BIT_WORD(reg)] & BIT_MASK(reg);
+}
+
+static void pmic_cache_assign(ulong *map, uint reg, bool set)
+{
+	if (set)
+		map[BIT_WORD(reg)] |= BIT_MASK(reg);
+	else
+		map[BIT_WORD(reg)] &= ~BIT_MASK(reg);
+}
+
+static struct pmic_reg_cache *pmic_cache_get(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	if (!CONFIG_IS_ENABLED(DM_PMIC_REG_CACHE) || !priv)
+		return NULL;
+
+	return priv->trans_len == 1 ? priv->cache : NULL;
+}
+
+/* Get the cache, if all of the registers reg...reg + len - 1 are cacheable */
+static struct pmic_reg_cache *pmic_cache_range(struct udevice *dev, uint reg,
+					       int len)
+{
+	struct pmic_reg_cache *cache = pmic_cache_get(dev);
+	int i;
+
+	if (!cache || len < 1 || reg + len > cache->count)
+		return NULL;
+	for (i = 0; i < len; i++) {
+		if (pmic_cache_test(cache->volatile_regs, reg + i))
+			return NULL;
+	}
+
+	return cache;
+}
+
+/* Write out held-back registers, coalescing runs if the device allows it */
+static int pmic_cache_flush(struct udevice *dev, struct pmic_reg_cache *cache)
+{
+	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	int reg, len, ret, i;
+
+	for (reg = 0; reg < cache->count; reg += len) {
+		len = 1;
+		if (!pmic_cache_test(cache->dirty, reg))
+			continue;
+		while (cache->burst && reg + len < cache->count &&
+		       pmic_cache_test(cache->dirty, reg + len))
+			len++;
+		ret = ops->write(dev, reg, cache->vals + reg, len);
+		if (ret)
+			return ret;
+		for (i = 0; i < len; i++)
+			pmic_cache_assign(cache->dirty, reg + i, false);
+	}
+
+	return 0;
+}
+
+/*
+ * Read cacheable registers. This returns -EAGAIN if the registers must be
+ * read from the device, leaving it to pmic_cache_fill() to cache them.
+ */
+static int pmic_cache_read(struct pmic_reg_cache *cache, uint reg,
+			   uint8_t *buffer, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_test(cache->valid, reg + i))
+			return -EAGAIN;
+	}
+	memcpy(buffer, cache->vals + reg, len);
+
+	return 0;
+}
+
+/* Check if a register can be cached */
+static bool pmic_cache_reg_ok(struct pmic_reg_cache *cache, uint reg)
+{
+	return reg < cache->count &&
+		!pmic_cache_test(cache->volatile_regs, reg);
+}
+
+/*
+ * Cache registers just read, but keep any values not yet written. Registers
+ * which cannot be cached are left alone, so this can be used for any range.
+ */
+static void pmic_cache_fill(struct pmic_reg_cache *cache, uint reg,
+			    uint8_t *buffer, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_reg_ok(cache, reg + i))
+			continue;
+		if (pmic_cache_test(cache->dirty, reg + i)) {
+			buffer[i] = cache->vals[reg + i];
+		} else {
+			cache->vals[reg + i] = buffer[i];
+			pmic_cache_assign(cache->valid, reg + i, true);
+		}
+	}
+}
+
+/*
+ * Update the cache for a write. This returns 0 if nothing more is needed,
+ * either because the registers already hold these values or because the
+ * write is held back, or -EAGAIN if the device must be written.
+ */
+static int pmic_cache_write(struct pmic_reg_cache *cache, uint reg,
+			    const uint8_t *buffer, int len)
+{
+	bool same = true;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_test(cache->valid, reg + i) ||
+		    cache->vals[reg + i] != buffer[i])
+			same = false;
+	}
+	if (same)
+		return 0;
+
+	memcpy(cache->vals + reg, buffer, len);
+	for (i = 0; i < len; i++) {
+		pmic_cache_assign(cache->valid, reg + i, true);
+		pmic_cache_assign(cache->dirty, reg + i, cache->batch);
+	}
+
+	return cache->batch ? 0 : -EAGAIN;
+}
+
+/* Update any cacheable registers in a range just written to the device */
+static void pmic_cache_written(struct pmic_reg_cache *cache, uint reg,
+			       const uint8_t *buffer, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_reg_ok(cache, reg + i))
+			continue;
+		cache->vals[reg + i] = buffer[i];
+		pmic_cache_assign(cache->valid, reg + i, true);
+		pmic_cache_assign(cache->dirty, reg + i, false);
+	}
+}
+
+/* Forget the registers in a range, except those not yet written */
+static void pmic_cache_drop(struct pmic_reg_cache *cache, uint reg, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (pmic_cache_reg_ok(cache, reg + i) &&
+		    !pmic_cache_test(cache->dirty, reg + i))
+			pmic_cache_assign(cache->valid, reg + i, false);
+	}
+}
+
+/* Set up the register cache if the device tree asks for it */
+static int pmic_cache_init(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	struct pmic_reg_cache *cache;
+	const fdt32_t *range;
+	int count, words, size;
+	uint reg;
+
+	if (!CONFIG_IS_ENABLED(DM_PMIC_REG_CACHE) || priv->trans_len != 1 ||
+	    !dev_read_bool(dev, "u-boot,reg-cache"))
+		return 0;
+	count = pmic_reg_count(dev);
+	if (count <= 0)
+		return 0;
+
+	words = BITS_TO_LONGS(count);
+	cache = calloc(1, sizeof(*cache) + 3 * words * sizeof(ulong) + count);
+	if (!cache)
+		return -ENOMEM;
+	cache->count = count;
+	cache->burst = dev_read_bool(dev, "u-boot,reg-burst-write");
+	cache->valid = (ulong *)(cache + 1);
+	cache->dirty = cache->valid + words;
+	cache->volatile_regs = cache->dirty + words;
+	cache->vals = (u8 *)(cache->volatile_regs + words);
+
+	/* Each pair of cells gives the first and last of a volatile range */
+	range = dev_read_prop(dev, "u-boot,volatile-regs", &size);
+	for (; range && size >= 2 * sizeof(*range); size -= 2 * sizeof(*range),
+	     range += 2) {
+		for (reg = fdt32_to_cpu(range[0]);
+		     reg <= fdt32_to_cpu(range[1]) && reg < count; reg++)
+			pmic_cache_assign(cache->volatile_regs, reg, true);
+	}
+	priv->cache = cache;
+
+	return 0;
+}
+
 #if CONFIG_IS_ENABLED(PMIC_CHILDREN)
 int pmic_bind_children(struct udevice *pmic, ofnode parent,
 		       const struct pmic_child_info *child_info)
@@ -105,6 +337,8 @@ int pmic_reg_count(struct udevice *dev)
 int pmic_read(struct udevice *dev, uint reg, uint8_t *buffer, int len)
 {
 	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	struct pmic_reg_cache *cache;
+	int ret;
 
 	if (!buffer)
 		return -EFAULT;
@@ -112,12 +346,27 @@ int pmic_read(struct udevice *dev, uint reg, uint8_t *buffer, int len)
 	if (!ops || !ops->read)
 		return -ENOSYS;
 
-	return ops->read(dev, reg, buffer, len);
+	cache = pmic_cache_range(dev, reg, len);
+	if (cache && !pmic_cache_read(cache, reg, buffer, len))
+		return 0;
+
+	ret = ops->read(dev, reg, buffer, len);
+	/*
+	 * Cache what can be cached, even if the range also has volatile
+	 * registers, and show any values held back by a batch
+	 */
+	cache = pmic_cache_get(dev);
+	if (!ret && cache)
+		pmic_cache_fill(cache, reg, buffer, len);
+
+	return ret;
 }
 
 int pmic_write(struct udevice *dev, uint reg, const uint8_t *buffer, int len)
 {
 	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	struct pmic_reg_cache *cache, *held;
+	int ret;
 
 	if (!buffer)
 		return -EFAULT;
@@ -125,7 +374,68 @@ int pmic_write(struct udevice *dev, uint reg, const uint8_t *buffer, int len)
 	if (!ops || !ops->write)
 		return -ENOSYS;
 
-	return ops->write(dev, reg, buffer, len);
+	cache = pmic_cache_range(dev, reg, len);
+	held = pmic_cache_get(dev);
+	if (cache) {
+		ret = pmic_cache_write(cache, reg, buffer, len);
+		if (ret != -EAGAIN)
+			return ret;
+	} else if (held && held->batch) {
+		/* Keep the held-back writes in order with this one */
+		ret = pmic_cache_flush(dev, held);
+		if (ret)
+			return ret;
+	}
+
+	ret = ops->write(dev, reg, buffer, len);
+	if (ret && held)
+		pmic_cache_drop(held, reg, len);
+	else if (!cache && held)
+		pmic_cache_written(held, reg, buffer, len);
+
+	return ret;
+}
+
+int pmic_batch_start(struct udevice *dev)
+{
+	struct pmic_reg_cache *cache = pmic_cache_get(dev);
+
+	if (cache)
+		cache->batch++;
+
+	return 0;
+}
+
+int pmic_batch_end(struct udevice *dev)
+{
+	struct pmic_reg_cache *cache = pmic_cache_get(dev);
+
+	if (!cache)
+		return 0;
+	if (!cache->batch)
+		return -EINVAL;
+	if (--cache->batch)
+		return 0;
+
+	return pmic_cache_flush(dev, cache);
+}
+
+int pmic_cache_sync(struct udevice *dev)
+{
+	struct pmic_reg_cache *cache = pmic_cache_get(dev);
+
+	return cache ? pmic_cache_flush(dev, cache) : 0;
+}
+
+void pmic_cache_invalidate(struct udevice *dev)
+{
+	struct pmic_reg_cache *cache = pmic_cache_get(dev);
+	int i;
+
+	if (!cache)
+		return;
+	for (i = 0; i < BITS_TO_LONGS(cache->count); i++)
+		cache->valid[i] = cache->dirty[i];
 }
 
 int pmic_reg_read(struct udevice *dev, uint reg)
@@ -191,9 +501,28 @@ static int pmic_pre_probe(struct udevice *dev)
 	return 0;
 }
 
+static int pmic_post_probe(struct udevice *dev)
+{
+	return pmic_cache_init(dev);
+}
+
+static int pmic_pre_remove(struct udevice *dev)
+{
+	struct uc_pmic_priv *pmic_priv = dev_get_uclass_priv(dev);
+	int ret;
+
+	ret = pmic_cache_sync(dev);
+	free(pmic_priv->cache);
+	pmic_priv->cache = NULL;
+
+	return ret;
+}
+
 UCLASS_DRIVER(pmic) = {
 	.id		= UCLASS_PMIC,
 	.name		= "pmic",
 	.pre_probe	= pmic_pre_probe,
+	.post_probe	= pmic_post_probe,
+	.pre_remove	= pmic_pre_remove,
 	.per_device_auto_alloc_size = sizeof(struct uc_pmic_priv),
 };
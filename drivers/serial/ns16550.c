@@ -306,6 +306,30 @@ static int ns16550_serial_putc(struct udevice *dev, const char ch)
 	return 0;
 }
 
+static ssize_t ns16550_serial_puts(struct udevice *dev, const char *s,
+				   size_t len)
+{
+	struct NS16550 *const com_port = dev_get_priv(dev);
+	struct ns16550_platdata *plat = com_port->plat;
+	size_t count = 1;
+	size_t i;
+
+	/* THRE is only set once the whole transmit FIFO is empty */
+	if (!(serial_in(&com_port->lsr) & UART_LSR_THRE))
+		return -EAGAIN;
+	if (plat->fifo_size && (plat->fcr & UART_FCR_FIFO_EN))
+		count = plat->fifo_size;
+	count = min(count, len);
+	for (i = 0; i < count; i++)
+		serial_out(s[i], &com_port->thr);
+
+	/* As in ns16550_serial_putc(), reset the watchdog on each line */
+	if (memchr(s, '\n', count))
+		WATCHDOG_RESET();
+
+	return count;
+}
+
 static int ns16550_serial_pending(struct udevice *dev, bool input)
 {
 	struct NS16550 *const com_port = dev_get_priv(dev);
@@ -488,6 +512,7 @@ int ns16550_serial_ofdata_to_platdata(struct udevice *dev)
 	plat->fcr = UART_FCR_DEFVAL;
 	if (port_type == PORT_JZ4780)
 		plat->fcr |= UART_FCR_UME;
+	plat->fifo_size = dev_read_u32_default(dev, "fifo-size", 16);
 
 	return 0;
 }
@@ -495,6 +520,7 @@ int ns16550_serial_ofdata_to_platdata(struct udevice *dev)
 
 const struct dm_serial_ops ns16550_serial_ops = {
 	.putc = ns16550_serial_putc,
+	.puts = ns16550_serial_puts,
 	.pending = ns16550_serial_pending,
 	.getc = ns16550_serial_getc,
 	.setbrg = ns16550_serial_setbrg,
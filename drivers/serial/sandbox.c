@@ -19,6 +19,7 @@
 #include <video.h>
 #include <linux/compiler.h>
 #include <asm/state.h>
+#include <asm/test.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -43,8 +44,16 @@ struct sandbox_serial_platdata {
 
 struct sandbox_serial_priv {
 	bool start_of_line;
+	bool tx_busy;
 };
 
+void sandbox_serial_set_tx_busy(struct udevice *dev, bool busy)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+
+	priv->tx_busy = busy;
+}
+
 /**
  * output_ansi_colour() - Output an ANSI colour code
  *
@@ -93,6 +102,8 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 	struct sandbox_serial_priv *priv = dev_get_priv(dev);
 	struct sandbox_serial_platdata *plat = dev->platdata;
 
+	if (priv->tx_busy)
+		return -EAGAIN;
 	if (priv->start_of_line && plat->colour != -1) {
 		priv->start_of_line = false;
 		output_ansi_colour(plat->colour);
@@ -105,6 +116,31 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 	return 0;
 }
 
+static ssize_t sandbox_serial_puts(struct udevice *dev, const char *s,
+				   size_t len)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+	struct sandbox_serial_platdata *plat = dev->platdata;
+	const char *end;
+
+	if (priv->tx_busy)
+		return -EAGAIN;
+	if (priv->start_of_line && plat->colour != -1) {
+		priv->start_of_line = false;
+		output_ansi_colour(plat->colour);
+	}
+
+	/* Stop after a newline so the next line gets its colour */
+	end = memchr(s, '\n', len);
+	if (end)
+		len = end + 1 - s;
+	os_write(1, s, len);
+	if (end)
+		priv->start_of_line = true;
+
+	return len;
+}
+
 static unsigned int increment_buffer_index(unsigned int index)
 {
 	return (index + 1) % ARRAY_SIZE(serial_buf);
@@ -237,6 +273,7 @@ static int sandbox_serial_ofdata_to_platdata(struct udevice *dev)
 
 static const struct dm_serial_ops sandbox_serial_ops = {
 	.putc = sandbox_serial_putc,
+	.puts = sandbox_serial_puts,
 	.pending = sandbox_serial_pending,
 	.getc = sandbox_serial_getc,
 	.getconfig = sandbox_serial_getconfig,
@@ -14,6 +14,7 @@
 #include <dm/lists.h>
 #include <dm/device-internal.h>
 #include <dm/of_access.h>
+#include <dm/uclass-internal.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -170,23 +171,165 @@ void serial_initialize(void)
 	serial_init();
 }
 
-static void _serial_putc(struct udevice *dev, char ch)
+/**
+ * __serial_write() - Send characters to a device without waiting
+ *
+ * @dev:	Device to write to
+ * @str:	Characters to send (newlines are not translated)
+ * @len:	Number of characters to send
+ * @return number of characters accepted by the device (characters which
+ * fail with an error other than -EAGAIN are dropped and counted)
+ */
+static int __serial_write(struct udevice *dev, const char *str, int len)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
-	int err;
+	int i, err;
 
-	if (ch == '\n')
-		_serial_putc(dev, '\r');
+	if (CONFIG_IS_ENABLED(SERIAL_PUTS) && ops->puts) {
+		err = ops->puts(dev, str, len);
+		if (err == -EAGAIN)
+			return 0;
 
-	do {
-		err = ops->putc(dev, ch);
-	} while (err == -EAGAIN);
+		return err < 0 ? len : min(err, len);
+	}
+
+	for (i = 0; i < len; i++) {
+		err = ops->putc(dev, str[i]);
+		if (err == -EAGAIN)
+			break;
+	}
+
+	return i;
+}
+
+/* Send characters to a device, waiting until it accepts them all */
+static void serial_write_wait(struct udevice *dev, const char *str, int len)
+{
+	int sent;
+
+	while (len) {
+		sent = __serial_write(dev, str, len);
+		str += sent;
+		len -= sent;
+	}
+}
+
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/* Send as much buffered output as the device accepts without waiting */
+static void serial_tx_drain(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	int len, sent;
+
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr) {
+		if (upriv->tx_wr_ptr > upriv->tx_rd_ptr)
+			len = upriv->tx_wr_ptr - upriv->tx_rd_ptr;
+		else
+			len = CONFIG_SERIAL_TX_BUFFER_SIZE - upriv->tx_rd_ptr;
+		sent = __serial_write(dev, upriv->tx_buf + upriv->tx_rd_ptr,
+				      len);
+		if (!sent)
+			break;
+		upriv->tx_rd_ptr += sent;
+		upriv->tx_rd_ptr %= CONFIG_SERIAL_TX_BUFFER_SIZE;
+	}
+}
+
+static void _serial_write(struct udevice *dev, const char *str, int len)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	int space, sent;
+
+	if (!upriv->tx_buf) {
+		serial_write_wait(dev, str, len);
+		return;
+	}
+
+	/* Keep output in order by sending what is already queued first */
+	serial_tx_drain(dev);
+	if (upriv->tx_rd_ptr == upriv->tx_wr_ptr) {
+		sent = __serial_write(dev, str, len);
+		str += sent;
+		len -= sent;
+	}
+
+	while (len) {
+		space = (upriv->tx_rd_ptr - upriv->tx_wr_ptr - 1) &
+			(CONFIG_SERIAL_TX_BUFFER_SIZE - 1);
+		if (!space) {
+			serial_tx_drain(dev);
+			continue;
+		}
+		space = min(space, CONFIG_SERIAL_TX_BUFFER_SIZE -
+			    upriv->tx_wr_ptr);
+		space = min(space, len);
+		memcpy(upriv->tx_buf + upriv->tx_wr_ptr, str, space);
+		upriv->tx_wr_ptr += space;
+		upriv->tx_wr_ptr %= CONFIG_SERIAL_TX_BUFFER_SIZE;
+		str += space;
+		len -= space;
+	}
+}
+
+static void _serial_flush(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr)
+		serial_tx_drain(dev);
+	if (ops->pending) {
+		while (ops->pending(dev, false) > 0)
+			;
+	}
+}
+
+void serial_flush(void)
+{
+	struct udevice *dev;
+	struct uclass *uc;
+
+	/* This may be called from panic() before driver model is ready */
+	uc = uclass_find(UCLASS_SERIAL);
+	if (!uc)
+		return;
+	uclass_foreach_dev(dev, uc) {
+		if (device_active(dev))
+			_serial_flush(dev);
+	}
+}
+#else
+static void serial_tx_drain(struct udevice *dev)
+{
+}
+
+static void _serial_write(struct udevice *dev, const char *str, int len)
+{
+	serial_write_wait(dev, str, len);
+}
+#endif /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
+static void _serial_putc(struct udevice *dev, char ch)
+{
+	if (ch == '\n')
+		_serial_write(dev, "\r\n", 2);
+	else
+		_serial_write(dev, &ch, 1);
 }
 
 static void _serial_puts(struct udevice *dev, const char *str)
 {
-	while (*str)
-		_serial_putc(dev, *str++);
+	const char *end;
+
+	while (*str) {
+		end = strchrnul(str, '\n');
+		if (end != str)
+			_serial_write(dev, str, end - str);
+		if (!*end)
+			break;
+		_serial_write(dev, "\r\n", 2);
+		str = end + 1;
+	}
 }
 
 static int __serial_getc(struct udevice *dev)
@@ -195,6 +338,7 @@ static int __serial_getc(struct udevice *dev)
 	int err;
 
 	do {
+		serial_tx_drain(dev);
 		err = ops->getc(dev);
 		if (err == -EAGAIN)
 			WATCHDOG_RESET();
@@ -207,6 +351,7 @@ static int __serial_tstc(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	serial_tx_drain(dev);
 	if (ops->pending)
 		return ops->pending(dev, true);
 
@@ -435,8 +580,10 @@ U_BOOT_ENV_CALLBACK(baudrate, on_baudrate);
 static int serial_post_probe(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
-#ifdef CONFIG_DM_STDIO
+#if defined(CONFIG_DM_STDIO) || CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+#endif
+#ifdef CONFIG_DM_STDIO
 	struct stdio_dev sdev;
 #endif
 	int ret;
@@ -448,6 +595,8 @@ static int serial_post_probe(struct udevice *dev)
 		ops->getc += gd->reloc_off;
 	if (ops->putc)
 		ops->putc += gd->reloc_off;
+	if (ops->puts)
+		ops->puts += gd->reloc_off;
 	if (ops->pending)
 		ops->pending += gd->reloc_off;
 	if (ops->clear)
@@ -470,6 +619,11 @@ static int serial_post_probe(struct udevice *dev)
 			return ret;
 	}
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	if (gd->flags & GD_FLG_RELOC)
+		upriv->tx_buf = malloc(CONFIG_SERIAL_TX_BUFFER_SIZE);
+#endif
+
 #ifdef CONFIG_DM_STDIO
 	if (!(gd->flags & GD_FLG_RELOC))
 		return 0;
@@ -495,12 +649,20 @@ static int serial_post_probe(struct udevice *dev)
 
 static int serial_pre_remove(struct udevice *dev)
 {
-#if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
+#if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER) || \
+	CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+#endif
 
+#if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
 	if (stdio_deregister_dev(upriv->sdev, true))
 		return -EPERM;
 #endif
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	_serial_flush(dev);
+	free(upriv->tx_buf);
+	upriv->tx_buf = NULL;
+#endif
 
 	return 0;
 }
@@ -11,6 +11,7 @@
 #include <dm.h>
 #include <errno.h>
 #include <regmap.h>
+#include <serial.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/root.h>
@@ -112,6 +113,7 @@ void reset_cpu(ulong addr)
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	printf("resetting ...\n");
+	serial_flush();
 
 	sysreset_walk_halt(SYSRESET_COLD);
 
@@ -207,6 +207,63 @@ int btrfs_read(const char *file, void *buf, loff_t offset, loff_t len,
 	return 0;
 }
 
+struct btrfs_file {
+	struct btrfs_root root;
+	u64 inr;
+	u64 size;
+};
+
+int btrfs_open(const char *file, void **filep, loff_t *size)
+{
+	struct btrfs_root root = btrfs_info.fs_root;
+	struct btrfs_inode_item inode;
+	struct btrfs_file *bfile;
+	u64 inr;
+	u8 type;
+
+	inr = btrfs_lookup_path(&root, root.root_dirid, file, &type, &inode,
+				40);
+
+	if (inr == -1ULL || type != BTRFS_FT_REG_FILE)
+		return -ENOENT;
+
+	bfile = malloc(sizeof(*bfile));
+	if (!bfile)
+		return -ENOMEM;
+	bfile->root = root;
+	bfile->inr = inr;
+	bfile->size = inode.size;
+	*size = inode.size;
+	*filep = bfile;
+
+	return 0;
+}
+
+int btrfs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+		loff_t *actread)
+{
+	struct btrfs_file *bfile = priv;
+	u64 rd;
+
+	*actread = 0;
+	if (offset >= bfile->size)
+		return 0;
+	if (!len || len > bfile->size - offset)
+		len = bfile->size - offset;
+
+	rd = btrfs_file_read(&bfile->root, bfile->inr, offset, len, buf);
+	if (rd == -1ULL)
+		return -EIO;
+
+	*actread = rd;
+	return 0;
+}
+
+void btrfs_close_file(void *priv)
+{
+	free(priv);
+}
+
 void btrfs_close(void)
 {
 	btrfs_chunk_map_exit();
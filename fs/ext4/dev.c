@@ -46,6 +46,11 @@ void ext4fs_set_blk_dev(struct blk_desc *rbdd, disk_partition_t *info)
 		get_fs()->dev_desc->log2blksz;
 }
 
+disk_partition_t *ext4fs_get_part_info(void)
+{
+	return part_info;
+}
+
 int ext4fs_devread(lbaint_t sector, int byte_offset, int byte_len,
 		   char *buffer)
 {
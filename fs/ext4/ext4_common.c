@@ -21,6 +21,7 @@
 #include <common.h>
 #include <ext_common.h>
 #include <ext4fs.h>
+#include <fs.h>
 #include <malloc.h>
 #include <memalign.h>
 #include <stddef.h>
@@ -2270,9 +2271,54 @@ static int ext4fs_find_file1(const char *currpath,
 	return -1;
 }
 
+/**
+ * struct ext4fs_dcache_ent - What the lookup cache keeps for a path
+ *
+ * @ino:	Inode number
+ * @type:	File type (FILETYPE_...)
+ */
+struct ext4fs_dcache_ent {
+	int ino;
+	int type;
+};
+
+/*
+ * Look up a path from the root directory in the cache. Returns 1 with
+ * *foundnode and *foundtype set if found, 0 if the path is known not to
+ * exist, or -ENOENT if it is not cached.
+ */
+static int ext4fs_dcache_find(const char *path, struct ext2fs_node *rootnode,
+			      struct ext2fs_node **foundnode, int *foundtype)
+{
+	struct ext4fs_dcache_ent ent;
+	struct ext2fs_node *node;
+	int ret;
+
+	ret = fs_dcache_lookup(get_fs()->dev_desc, ext4fs_get_part_info(),
+			       FS_TYPE_EXT, path, &ent, sizeof(ent));
+	if (ret != 1)
+		return ret;
+
+	if (ent.ino == rootnode->ino) {
+		node = rootnode;
+	} else {
+		node = zalloc(sizeof(struct ext2fs_node));
+		if (!node)
+			return -ENOENT;
+		node->data = rootnode->data;
+		node->ino = ent.ino;
+	}
+	*foundnode = node;
+	*foundtype = ent.type;
+
+	return 1;
+}
+
 int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 	struct ext2fs_node **foundnode, int expecttype)
 {
+	struct ext4fs_dcache_ent ent;
+	bool cache = false;
 	int status;
 	int foundtype = FILETYPE_DIRECTORY;
 
@@ -2280,7 +2326,25 @@ int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 	if (!path)
 		return 0;
 
-	status = ext4fs_find_file1(path, rootnode, foundnode, &foundtype);
+	/* Only lookups from the root directory have a unique path */
+	if (CONFIG_IS_ENABLED(FS_DCACHE) && rootnode == &ext4fs_root->diropen) {
+		status = ext4fs_dcache_find(path, rootnode, foundnode,
+					    &foundtype);
+		cache = status == -ENOENT;
+	} else {
+		status = -ENOENT;
+	}
+	if (status == -ENOENT)
+		status = ext4fs_find_file1(path, rootnode, foundnode,
+					   &foundtype);
+	/* -1 is a read error, which is not worth remembering */
+	if (cache && status >= 0) {
+		ent.ino = status ? (*foundnode)->ino : 0;
+		ent.type = foundtype;
+		fs_dcache_add(get_fs()->dev_desc, ext4fs_get_part_info(),
+			      FS_TYPE_EXT, path, status ? &ent : NULL,
+			      sizeof(ent));
+	}
 	if (status == 0)
 		return 0;
 
@@ -2302,7 +2366,11 @@ int ext4fs_open(const char *filename, loff_t *len)
 	if (ext4fs_root == NULL)
 		return -1;
 
-	ext4fs_file = NULL;
+	/* The filesystem may stay mounted between calls, see fs_open() */
+	if (ext4fs_file) {
+		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
+		ext4fs_file = NULL;
+	}
 	status = ext4fs_find_file(filename, &ext4fs_root->diropen, &fdiro,
 				  FILETYPE_REG);
 	if (status == 0)
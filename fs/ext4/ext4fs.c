@@ -207,6 +207,40 @@ int ext4fs_read(char *buf, loff_t offset, loff_t len, loff_t *actread)
 	return ext4fs_read_file(ext4fs_file, offset, len, buf, actread);
 }
 
+int ext4fs_open_file(const char *filename, void **filep, loff_t *size)
+{
+	if (ext4fs_open(filename, size) < 0)
+		return -ENOENT;
+
+	/* Take the node, so that it is not freed by the next ext4fs_open() */
+	*filep = ext4fs_file;
+	ext4fs_file = NULL;
+
+	return 0;
+}
+
+int ext4fs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread)
+{
+	struct ext2fs_node *node = priv;
+	loff_t size = le32_to_cpu(node->inode.size);
+
+	*actread = 0;
+	if (offset >= size)
+		return 0;
+	if (!len || len > size - offset)
+		len = size - offset;
+	if (ext4fs_read_file(node, offset, len, buf, actread) < 0)
+		return -EIO;
+
+	return 0;
+}
+
+void ext4fs_close_file(void *priv)
+{
+	ext4fs_free_node(priv, &ext4fs_root->diropen);
+}
+
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 disk_partition_t *fs_partition)
 {
@@ -300,16 +300,27 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+/*
+ * A cluster of an open file and its position in the file, so that the next
+ * read does not have to follow the cluster chain from the start of the file
+ */
+struct fat_cursor {
+	__u32 clust;
+	loff_t pos;
+};
+
 /*
  * Read at most 'maxsize' bytes from 'pos' in the file associated with 'dentptr'
- * into 'buffer'.
+ * into 'buffer'. If 'cursor' is not NULL, start looking for the cluster at
+ * 'pos' from there if possible, and update it to that cluster.
  * Update the number of bytes read in *gotsize or return -1 on fatal errors.
  */
 __u8 get_contents_vfatname_block[MAX_CLUSTSIZE]
 	__aligned(ARCH_DMA_MINALIGN);
 
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
-			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
+			__u8 *buffer, loff_t maxsize, loff_t *gotsize,
+			struct fat_cursor *cursor)
 {
 	loff_t filesize = FAT2CPU32(dentptr->size);
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
@@ -331,6 +342,10 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 	debug("%llu bytes\n", filesize);
 
 	actsize = bytesperclust;
+	if (cursor && cursor->clust && cursor->pos <= pos) {
+		curclust = cursor->clust;
+		actsize += cursor->pos;
+	}
 
 	/* go to cluster at pos */
 	while (actsize <= pos) {
@@ -345,6 +360,10 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 
 	/* actsize > pos */
 	actsize -= bytesperclust;
+	if (cursor) {
+		cursor->clust = curclust;
+		cursor->pos = actsize;
+	}
 	filesize -= actsize;
 	pos -= actsize;
 
@@ -1004,6 +1023,69 @@ static int fat_itr_resolve(fat_itr *itr, const char *path, unsigned type)
 	return -ENOENT;
 }
 
+/**
+ * fat_itr_lookup() - resolve a path, using the lookup cache
+ *
+ * This is like fat_itr_resolve(), except that for a file the iterator only
+ * has the file's directory entry, rather than pointing into the parent
+ * directory. So it must not be used to change the directory.
+ *
+ * The cache keeps the directory entry of a file. For a directory it keeps
+ * an entry with just ATTR_DIR and the first cluster set, or 0 for the root
+ * directory, like the one fat_itr_child() descends into.
+ *
+ * @itr: iterator initialized to root
+ * @path: the requested path
+ * @type: bitmask of allowable file types
+ * @return 0 on success or -errno
+ */
+static int fat_itr_lookup(fat_itr *itr, const char *path, unsigned type)
+{
+	dir_entry *dent = (dir_entry *)itr->block;
+	int ret;
+
+	ret = fs_dcache_lookup(cur_dev, &cur_part_info, FS_TYPE_FAT, path,
+			       dent, sizeof(*dent));
+	if (ret == -ENOENT) {
+		ret = fat_itr_resolve(itr, path, TYPE_ANY);
+		if (ret == -ENOENT)
+			fs_dcache_add(cur_dev, &cur_part_info, FS_TYPE_FAT,
+				      path, NULL, 0);
+		if (ret)
+			return ret;
+
+		if (itr->dent) {
+			fs_dcache_add(cur_dev, &cur_part_info, FS_TYPE_FAT,
+				      path, itr->dent, sizeof(*itr->dent));
+			return type & TYPE_FILE ? 0 : -ENOTDIR;
+		}
+
+		if (!CONFIG_IS_ENABLED(FS_DCACHE))
+			return type & TYPE_DIR ? 0 : -ENOENT;
+		/* itr->block is not in use until the first fat_itr_next() */
+		memset(dent, '\0', sizeof(*dent));
+		dent->attr = ATTR_DIR;
+		dent->start = cpu_to_le16(itr->start_clust & 0xffff);
+		dent->starthi = cpu_to_le16(itr->start_clust >> 16);
+		fs_dcache_add(cur_dev, &cur_part_info, FS_TYPE_FAT, path, dent,
+			      sizeof(*dent));
+
+		return type & TYPE_DIR ? 0 : -ENOENT;
+	}
+	if (!ret)
+		return -ENOENT;
+
+	itr->dent = dent;
+	if (dent->attr & ATTR_DIR) {
+		if (!(type & TYPE_DIR))
+			return -ENOENT;
+		fat_itr_child(itr, itr);
+		return 0;
+	}
+
+	return type & TYPE_FILE ? 0 : -ENOTDIR;
+}
+
 int file_fat_detectfs(void)
 {
 	boot_sector bs;
@@ -1079,7 +1161,7 @@ int fat_exists(const char *filename)
 	if (ret)
 		goto out;
 
-	ret = fat_itr_resolve(itr, filename, TYPE_ANY);
+	ret = fat_itr_lookup(itr, filename, TYPE_ANY);
 	free(fsdata.fatbuf);
 out:
 	free(itr);
@@ -1099,7 +1181,7 @@ int fat_size(const char *filename, loff_t *size)
 	if (ret)
 		goto out_free_itr;
 
-	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
+	ret = fat_itr_lookup(itr, filename, TYPE_FILE);
 	if (ret) {
 		/*
 		 * Directories don't have size, but fs_size() is not
@@ -1107,7 +1189,7 @@ int fat_size(const char *filename, loff_t *size)
 		 */
 		free(fsdata.fatbuf);
 		fat_itr_root(itr, &fsdata);
-		if (!fat_itr_resolve(itr, filename, TYPE_DIR)) {
+		if (!fat_itr_lookup(itr, filename, TYPE_DIR)) {
 			*size = 0;
 			ret = 0;
 		}
@@ -1136,12 +1218,13 @@ int file_fat_read_at(const char *filename, loff_t pos, void *buffer,
 	if (ret)
 		goto out_free_itr;
 
-	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
+	ret = fat_itr_lookup(itr, filename, TYPE_FILE);
 	if (ret)
 		goto out_free_both;
 
 	debug("reading %s at pos %llu\n", filename, pos);
-	ret = get_contents(&fsdata, itr->dent, pos, buffer, maxsize, actread);
+	ret = get_contents(&fsdata, itr->dent, pos, buffer, maxsize, actread,
+			   NULL);
 
 out_free_both:
 	free(fsdata.fatbuf);
@@ -1174,6 +1257,72 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	return ret;
 }
 
+struct fat_file {
+	fsdata fsdata;
+	dir_entry dent;
+	struct fat_cursor cursor;
+};
+
+int fat_open(const char *filename, void **filep, loff_t *size)
+{
+	struct fat_file *file;
+	fat_itr *itr;
+	int ret;
+
+	file = malloc(sizeof(*file));
+	if (!file)
+		return -ENOMEM;
+	itr = malloc_cache_aligned(sizeof(fat_itr));
+	if (!itr) {
+		ret = -ENOMEM;
+		goto out_free_file;
+	}
+	ret = fat_itr_root(itr, &file->fsdata);
+	if (ret)
+		goto out_free_itr;
+
+	ret = fat_itr_lookup(itr, filename, TYPE_FILE);
+	if (ret) {
+		free(file->fsdata.fatbuf);
+		goto out_free_itr;
+	}
+
+	/* Keep the boot sector information and FAT buffer for reading */
+	file->dent = *itr->dent;
+	file->cursor.clust = 0;
+	*size = FAT2CPU32(file->dent.size);
+	*filep = file;
+	free(itr);
+
+	return 0;
+
+out_free_itr:
+	free(itr);
+out_free_file:
+	free(file);
+	return ret;
+}
+
+int fat_pread(void *priv, void *buf, loff_t offset, loff_t len,
+	      loff_t *actread)
+{
+	struct fat_file *file = priv;
+
+	if (get_contents(&file->fsdata, &file->dent, offset, buf, len, actread,
+			 &file->cursor))
+		return -EIO;
+
+	return 0;
+}
+
+void fat_close_file(void *priv)
+{
+	struct fat_file *file = priv;
+
+	free(file->fsdata.fatbuf);
+	free(file);
+}
+
 typedef struct {
 	struct fs_dir_stream parent;
 	struct fs_dirent dirent;
@@ -1195,7 +1344,7 @@ int fat_opendir(const char *filename, struct fs_dir_stream **dirsp)
 	if (ret)
 		goto fail_free_dir;
 
-	ret = fat_itr_resolve(&dir->itr, filename, TYPE_DIR);
+	ret = fat_itr_lookup(&dir->itr, filename, TYPE_DIR);
 	if (ret)
 		goto fail_free_both;
 
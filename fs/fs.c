@@ -16,6 +16,8 @@
 #include <btrfs.h>
 #include <asm/io.h>
 #include <div64.h>
+#include <malloc.h>
+#include <linux/list.h>
 #include <linux/math64.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -25,6 +27,49 @@ static int fs_dev_part;
 static disk_partition_t fs_partition;
 static int fs_type = FS_TYPE_ANY;
 
+/**
+ * struct fs_mount - A filesystem kept mounted while it has open files
+ *
+ * Filesystem drivers hold the state of only one filesystem at a time. The
+ * mount whose state they hold is fs_live. The files of other mounts have no
+ * filesystem handle; the mount is probed again, and the files opened again,
+ * when they are next read.
+ *
+ * @link:	Link in fs_mounts
+ * @desc:	Block device, or NULL for virtual filesystems
+ * @part:	Partition number
+ * @partition:	Partition information
+ * @fstype:	Filesystem type (FS_TYPE_...)
+ * @files:	Open files (struct fs_file)
+ */
+struct fs_mount {
+	struct list_head link;
+	struct blk_desc *desc;
+	int part;
+	disk_partition_t partition;
+	int fstype;
+	struct list_head files;
+};
+
+/**
+ * struct fs_file - An open file
+ *
+ * @link:	Link in the list of files of @mount
+ * @mount:	Filesystem holding the file
+ * @priv:	Filesystem handle for the file, or NULL if @mount is not
+ *		fs_live
+ * @path:	Path of the file, to open it again
+ */
+struct fs_file {
+	struct list_head link;
+	struct fs_mount *mount;
+	void *priv;
+	char path[];
+};
+
+static LIST_HEAD(fs_mounts);
+static struct fs_mount *fs_live;
+
 static inline int fs_probe_unsupported(struct blk_desc *fs_dev_desc,
 				      disk_partition_t *fs_partition)
 {
@@ -99,6 +144,22 @@ static inline int fs_uuid_unsupported(char *uuid_str)
 	return -1;
 }
 
+static inline int fs_open_unsupported(const char *filename, void **filep,
+				      loff_t *size)
+{
+	return -ENODEV;
+}
+
+static inline int fs_pread_unsupported(void *priv, void *buf, loff_t offset,
+				       loff_t len, loff_t *actread)
+{
+	return -ENODEV;
+}
+
+static inline void fs_close_file_unsupported(void *priv)
+{
+}
+
 static inline int fs_opendir_unsupported(const char *filename,
 					 struct fs_dir_stream **dirs)
 {
@@ -138,6 +199,21 @@ struct fstype_info {
 		     loff_t len, loff_t *actwrite);
 	void (*close)(void);
 	int (*uuid)(char *uuid_str);
+	/*
+	 * Open a file for pread().  On success return 0, the filesystem's
+	 * handle via 'filep' and the file size via 'size'.  On error return
+	 * -errno.  The handle is only used while the filesystem stays
+	 * probed.  See fs_open().
+	 */
+	int (*open)(const char *filename, void **filep, loff_t *size);
+	/*
+	 * Read from an open file.  Reads to the end of the file if 'len' is
+	 * 0.  Return 0 on success or -errno on error.  See fs_pread().
+	 */
+	int (*pread)(void *priv, void *buf, loff_t offset, loff_t len,
+		     loff_t *actread);
+	/* see fs_close_file() */
+	void (*close_file)(void *priv);
 	/*
 	 * Open a directory stream.  On success return 0 and directory
 	 * stream pointer via 'dirsp'.  On error, return -errno.  See
@@ -156,6 +232,53 @@ struct fstype_info {
 	int (*mkdir)(const char *dirname);
 };
 
+static struct fstype_info *fs_get_info(int fstype);
+
+/*
+ * generic implementation of file handles in terms of size/read, for
+ * filesystems which do not keep any state for an open file
+ */
+struct fs_generic_file {
+	struct fstype_info *info;
+	char path[];
+};
+
+__maybe_unused
+static int fs_open_generic(const char *filename, void **filep, loff_t *size)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct fs_generic_file *file;
+
+	if (info->size(filename, size))
+		return -ENOENT;
+	file = malloc(sizeof(*file) + strlen(filename) + 1);
+	if (!file)
+		return -ENOMEM;
+	file->info = info;
+	strcpy(file->path, filename);
+	*filep = file;
+
+	return 0;
+}
+
+__maybe_unused
+static int fs_pread_generic(void *priv, void *buf, loff_t offset, loff_t len,
+			    loff_t *actread)
+{
+	struct fs_generic_file *file = priv;
+
+	if (file->info->read(file->path, buf, offset, len, actread))
+		return -EIO;
+
+	return 0;
+}
+
+__maybe_unused
+static void fs_close_file_generic(void *priv)
+{
+	free(priv);
+}
+
 static struct fstype_info fstypes[] = {
 #ifdef CONFIG_FS_FAT
 	{
@@ -179,6 +302,9 @@ static struct fstype_info fstypes[] = {
 #endif
 		.uuid = fs_uuid_unsupported,
 		.opendir = fat_opendir,
+		.open = fat_open,
+		.pread = fat_pread,
+		.close_file = fat_close_file,
 		.readdir = fat_readdir,
 		.closedir = fat_closedir,
 	},
@@ -200,6 +326,9 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 #endif
 		.uuid = ext4fs_uuid,
+		.open = ext4fs_open_file,
+		.pread = ext4fs_pread,
+		.close_file = ext4fs_close_file,
 		.opendir = fs_opendir_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
@@ -218,6 +347,9 @@ static struct fstype_info fstypes[] = {
 		.read = fs_read_sandbox,
 		.write = fs_write_sandbox,
 		.uuid = fs_uuid_unsupported,
+		.open = fs_open_generic,
+		.pread = fs_pread_generic,
+		.close_file = fs_close_file_generic,
 		.opendir = fs_opendir_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
@@ -236,6 +368,9 @@ static struct fstype_info fstypes[] = {
 		.read = ubifs_read,
 		.write = fs_write_unsupported,
 		.uuid = fs_uuid_unsupported,
+		.open = fs_open_generic,
+		.pread = fs_pread_generic,
+		.close_file = fs_close_file_generic,
 		.opendir = fs_opendir_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
@@ -254,6 +389,9 @@ static struct fstype_info fstypes[] = {
 		.read = btrfs_read,
 		.write = fs_write_unsupported,
 		.uuid = btrfs_uuid,
+		.open = btrfs_open,
+		.pread = btrfs_pread,
+		.close_file = btrfs_close_file,
 		.opendir = fs_opendir_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
@@ -271,6 +409,9 @@ static struct fstype_info fstypes[] = {
 		.read = fs_read_unsupported,
 		.write = fs_write_unsupported,
 		.uuid = fs_uuid_unsupported,
+		.open = fs_open_unsupported,
+		.pread = fs_pread_unsupported,
+		.close_file = fs_close_file_unsupported,
 		.opendir = fs_opendir_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
@@ -304,9 +445,64 @@ const char *fs_get_type_name(void)
 	return fs_get_info(fs_type)->name;
 }
 
+/*
+ * Check whether a partition is the mounted filesystem, which is then made the
+ * current one again without probing it. Virtual filesystems have no block
+ * device, so they can only be told apart by their type.
+ */
+static bool fs_is_mounted(struct blk_desc *desc, int part, int fstype)
+{
+	if (!fs_live || fs_live->desc != desc || fs_live->part != part)
+		return false;
+	if (fstype == FS_TYPE_ANY ? !desc : fstype != fs_live->fstype)
+		return false;
+
+	fs_dev_desc = desc;
+	fs_dev_part = part;
+	fs_partition = fs_live->partition;
+	fs_type = fs_live->fstype;
+
+	return true;
+}
+
+/* Drop the filesystem handles of the open files of the mounted filesystem */
+static void fs_release_files(void)
+{
+	struct fstype_info *info;
+	struct fs_file *file;
+
+	if (!fs_live)
+		return;
+
+	info = fs_get_info(fs_live->fstype);
+	list_for_each_entry(file, &fs_live->files, link) {
+		if (file->priv) {
+			info->close_file(file->priv);
+			file->priv = NULL;
+		}
+	}
+	fs_live = NULL;
+}
+
+/* Close the mounted filesystem, so that another one can be probed */
+static void fs_unmount(void)
+{
+	struct fstype_info *info;
+
+	if (!fs_live)
+		return;
+
+	info = fs_get_info(fs_live->fstype);
+	fs_release_files();
+	info->close();
+	fs_type = FS_TYPE_ANY;
+}
+
 int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 {
 	struct fstype_info *info;
+	disk_partition_t partition;
+	struct blk_desc *desc;
 	int part, i;
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
 	static int relocated;
@@ -325,10 +521,15 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 	}
 #endif
 
-	part = blk_get_device_part_str(ifname, dev_part_str, &fs_dev_desc,
-					&fs_partition, 1);
+	part = blk_get_device_part_str(ifname, dev_part_str, &desc,
+					&partition, 1);
 	if (part < 0)
 		return -1;
+	if (fs_is_mounted(desc, part, fstype))
+		return 0;
+	fs_unmount();
+	fs_dev_desc = desc;
+	fs_partition = partition;
 
 	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
 		if (fstype != FS_TYPE_ANY && info->fstype != FS_TYPE_ANY &&
@@ -354,6 +555,9 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 	struct fstype_info *info;
 	int ret, i;
 
+	if (fs_is_mounted(desc, part, FS_TYPE_ANY))
+		return 0;
+	fs_unmount();
 	if (part >= 1)
 		ret = part_get_info(desc, part, &fs_partition);
 	else
@@ -377,7 +581,9 @@ static void fs_close(void)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
 
-	info->close();
+	/* Keep the filesystem probed while it has open files */
+	if (!fs_live)
+		info->close();
 
 	fs_type = FS_TYPE_ANY;
 }
@@ -452,6 +658,150 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return ret;
 }
 
+/* Find or add the mount for the current filesystem, and make it fs_live */
+static struct fs_mount *fs_mount_current(void)
+{
+	struct fs_mount *mount;
+
+	if (fs_live)
+		return fs_live;
+
+	list_for_each_entry(mount, &fs_mounts, link) {
+		if (mount->desc == fs_dev_desc && mount->part == fs_dev_part &&
+		    mount->fstype == fs_type)
+			goto found;
+	}
+	mount = calloc(1, sizeof(*mount));
+	if (!mount)
+		return NULL;
+	mount->desc = fs_dev_desc;
+	mount->part = fs_dev_part;
+	mount->partition = fs_partition;
+	mount->fstype = fs_type;
+	INIT_LIST_HEAD(&mount->files);
+	list_add(&mount->link, &fs_mounts);
+found:
+	fs_live = mount;
+
+	return mount;
+}
+
+/* Probe the filesystem of a mount again, if it is not the mounted one */
+static int fs_mount_activate(struct fs_mount *mount)
+{
+	struct fstype_info *info = fs_get_info(mount->fstype);
+
+	if (fs_live == mount)
+		return 0;
+
+	if (fs_live) {
+		fs_unmount();
+	} else if (fs_type != FS_TYPE_ANY) {
+		/*
+		 * fs_set_blk_dev() probed a filesystem and nothing has used it
+		 * yet. Use it if it is this mount's, else close it.
+		 */
+		if (fs_dev_desc == mount->desc && fs_dev_part == mount->part &&
+		    fs_type == mount->fstype) {
+			fs_live = mount;
+			return 0;
+		}
+		fs_close();
+	}
+	if (info->probe(mount->desc, &mount->partition))
+		return -EIO;
+	fs_dev_desc = mount->desc;
+	fs_dev_part = mount->part;
+	fs_partition = mount->partition;
+	fs_type = mount->fstype;
+	fs_live = mount;
+
+	return 0;
+}
+
+int fs_open(const char *filename, struct fs_file **filep, loff_t *size)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct fs_mount *mount;
+	struct fs_file *file;
+	int ret;
+
+	file = calloc(1, sizeof(*file) + strlen(filename) + 1);
+	if (!file) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	strcpy(file->path, filename);
+
+	ret = info->open(filename, &file->priv, size);
+	if (ret)
+		goto err_free;
+	mount = fs_mount_current();
+	if (!mount) {
+		info->close_file(file->priv);
+		ret = -ENOMEM;
+		goto err_free;
+	}
+	file->mount = mount;
+	list_add_tail(&file->link, &mount->files);
+	*filep = file;
+	fs_close();
+
+	return 0;
+
+err_free:
+	free(file);
+err:
+	fs_close();
+	return ret;
+}
+
+int fs_pread(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+	     loff_t *actread)
+{
+	struct fs_mount *mount = file->mount;
+	struct fstype_info *info = fs_get_info(mount->fstype);
+	loff_t size;
+	int ret;
+
+	ret = fs_mount_activate(mount);
+	if (ret)
+		return ret;
+	if (!file->priv) {
+		ret = info->open(file->path, &file->priv, &size);
+		if (ret) {
+			file->priv = NULL;
+			return ret;
+		}
+	}
+
+	return info->pread(file->priv, buf, offset, len, actread);
+}
+
+void fs_close_file(struct fs_file *file)
+{
+	struct fs_mount *mount;
+	struct fstype_info *info;
+
+	if (!file)
+		return;
+
+	mount = file->mount;
+	info = fs_get_info(mount->fstype);
+	if (file->priv)
+		info->close_file(file->priv);
+	list_del(&file->link);
+	free(file);
+	if (!list_empty(&mount->files))
+		return;
+
+	/* Last file closed: stop keeping the filesystem mounted */
+	if (fs_live == mount)
+		fs_unmount();
+	list_del(&mount->link);
+	free(mount);
+}
+
 int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	     loff_t *actwrite)
 {
@@ -459,6 +809,8 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	void *buf;
 	int ret;
 
+	/* Open files are opened again afterwards, without stale caches */
+	fs_release_files();
 	buf = map_sysmem(addr, len);
 	ret = info->write(filename, buf, offset, len, actwrite);
 	unmap_sysmem(buf);
@@ -530,6 +882,7 @@ int fs_unlink(const char *filename)
 
 	struct fstype_info *info = fs_get_info(fs_type);
 
+	fs_release_files();
 	ret = info->unlink(filename);
 
 	fs_type = FS_TYPE_ANY;
@@ -544,6 +897,7 @@ int fs_mkdir(const char *dirname)
 
 	struct fstype_info *info = fs_get_info(fs_type);
 
+	fs_release_files();
 	ret = info->mkdir(dirname);
 
 	fs_type = FS_TYPE_ANY;
@@ -577,11 +931,14 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	unsigned long addr;
 	const char *addr_str;
 	const char *filename;
+	struct fs_file *file;
 	loff_t bytes;
 	loff_t pos;
+	loff_t size;
 	loff_t len_read;
 	int ret;
 	unsigned long time;
+	void *buf;
 	char *ep;
 
 	if (argc < 2)
@@ -622,10 +979,20 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		pos = 0;
 
 	time = get_timer(0);
-	ret = fs_read(filename, addr, pos, bytes, &len_read);
+	ret = fs_open(filename, &file, &size);
+	if (ret < 0) {
+		printf("** File not found %s **\n", filename);
+		return 1;
+	}
+	buf = map_sysmem(addr, bytes ? bytes : size);
+	ret = fs_pread(file, buf, pos, bytes, &len_read);
+	unmap_sysmem(buf);
+	fs_close_file(file);
 	time = get_timer(time);
-	if (ret < 0)
+	if (ret < 0) {
+		printf("** Unable to read file %s **\n", filename);
 		return 1;
+	}
 
 	printf("%llu bytes read in %lu ms", len_read, time);
 	if (time > 0) {
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Cache of path lookups on block-device filesystems
+ *
+ * Boot scripts check for many candidate files, often the same ones several
+ * times, and each check resolves the path one directory at a time. This
+ * keeps the outcome of recent lookups, including failed ones, for each
+ * partition. What is stored for a found path is up to the filesystem.
+ *
+ * A write to a block device, or initialising it again, drops all of its
+ * entries, so the cache never outlives the data it was read from.
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <fs.h>
+#include <malloc.h>
+#include <part.h>
+#include <linux/list.h>
+
+/**
+ * struct fs_dcache_entry - A cached path lookup
+ *
+ * @link:	Link in fs_dcache, most recently used first
+ * @desc:	Block device
+ * @part_start:	First block of the partition
+ * @fstype:	Filesystem type (FS_TYPE_...)
+ * @found:	true if the path exists, false if it does not
+ * @data:	Filesystem's information about the path, if found
+ * @path:	Path as passed to the filesystem
+ */
+struct fs_dcache_entry {
+	struct list_head link;
+	struct blk_desc *desc;
+	lbaint_t part_start;
+	int fstype;
+	bool found;
+	u8 data[FS_DCACHE_DATA_SIZE];
+	char path[FS_DCACHE_PATH_MAX];
+};
+
+static LIST_HEAD(fs_dcache);
+static uint fs_dcache_count;
+
+static struct fs_dcache_entry *fs_dcache_find(struct blk_desc *desc,
+					      disk_partition_t *part,
+					      int fstype, const char *path)
+{
+	struct fs_dcache_entry *ent;
+
+	list_for_each_entry(ent, &fs_dcache, link) {
+		if (ent->desc == desc && ent->part_start == part->start &&
+		    ent->fstype == fstype && !strcmp(ent->path, path))
+			return ent;
+	}
+
+	return NULL;
+}
+
+int fs_dcache_lookup(struct blk_desc *desc, disk_partition_t *part,
+		     int fstype, const char *path, void *data, uint size)
+{
+	struct fs_dcache_entry *ent;
+
+	ent = fs_dcache_find(desc, part, fstype, path);
+	if (!ent)
+		return -ENOENT;
+
+	list_move(&ent->link, &fs_dcache);
+	if (!ent->found)
+		return 0;
+	memcpy(data, ent->data, min_t(uint, size, FS_DCACHE_DATA_SIZE));
+
+	return 1;
+}
+
+void fs_dcache_add(struct blk_desc *desc, disk_partition_t *part, int fstype,
+		   const char *path, const void *data, uint size)
+{
+	struct fs_dcache_entry *ent;
+
+	if (strlen(path) >= FS_DCACHE_PATH_MAX || size > FS_DCACHE_DATA_SIZE)
+		return;
+
+	ent = fs_dcache_find(desc, part, fstype, path);
+	if (!ent && fs_dcache_count < CONFIG_FS_DCACHE_ENTRIES) {
+		ent = malloc(sizeof(*ent));
+		if (!ent)
+			return;
+		fs_dcache_count++;
+	} else if (!ent) {
+		/* Replace the least recently used entry */
+		ent = list_last_entry(&fs_dcache, struct fs_dcache_entry, link);
+		list_del(&ent->link);
+	} else {
+		list_del(&ent->link);
+	}
+
+	ent->desc = desc;
+	ent->part_start = part->start;
+	ent->fstype = fstype;
+	ent->found = data != NULL;
+	if (data)
+		memcpy(ent->data, data, size);
+	strcpy(ent->path, path);
+	list_add(&ent->link, &fs_dcache);
+}
+
+void fs_dcache_invalidate(struct blk_desc *desc)
+{
+	struct fs_dcache_entry *ent, *next;
+
+	list_for_each_entry_safe(ent, next, &fs_dcache, link) {
+		if (ent->desc == desc) {
+			list_del(&ent->link);
+			free(ent);
+			fs_dcache_count--;
+		}
+	}
+}
@@ -290,6 +290,39 @@ struct dm_gpio_ops {
 	 */
 	int (*xlate)(struct udevice *dev, struct gpio_desc *desc,
 		     struct ofnode_phandle_args *args);
+
+	/**
+	 * get_values() - Get the values of several GPIOs at once
+	 *
+	 * This method is optional. If it is not provided, the uclass reads
+	 * each GPIO with get_value().
+	 *
+	 * @dev:	GPIO device
+	 * @mask:	Bitmap of the GPIOs to read, one bit for each GPIO in
+	 *		the device, with GPIO 0 in bit 0 of @mask[0]
+	 * @values:	Returns the values of the GPIOs in @mask, using the same
+	 *		layout. Bits not in @mask are undefined
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*get_values)(struct udevice *dev, const ulong *mask,
+			  ulong *values);
+
+	/**
+	 * set_values() - Set the values of several GPIOs at once
+	 *
+	 * This method is optional. If it is not provided, the uclass sets
+	 * each GPIO with set_value(). Where the hardware allows, all the
+	 * GPIOs should change together.
+	 *
+	 * @dev:	GPIO device
+	 * @mask:	Bitmap of the GPIOs to set, one bit for each GPIO in the
+	 *		device, with GPIO 0 in bit 0 of @mask[0]
+	 * @values:	Values to set, using the same layout as @mask. Bits not
+	 *		in @mask must be ignored
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*set_values)(struct udevice *dev, const ulong *mask,
+			  const ulong *values);
 };
 
 /**
@@ -552,6 +585,38 @@ int dm_gpio_get_value(const struct gpio_desc *desc);
 
 int dm_gpio_set_value(const struct gpio_desc *desc, int value);
 
+/**
+ * dm_gpios_get_values() - Get the values of a list of GPIOs
+ *
+ * GPIOs in the same bank are read together where the driver supports it,
+ * so that the values are sampled at (nearly) the same time.
+ *
+ * @desc_list:	List of GPIOs to read, each previously returned by
+ *		gpio_request_by_name() or similar
+ * @count:	Number of GPIOs in @desc_list, at most BITS_PER_LONG
+ * @valuesp:	Returns the values, with the value of the first GPIO in bit 0,
+ *		the second in bit 1, etc. (1 for active, 0 for inactive)
+ * @return 0 if OK, -ve on error
+ */
+int dm_gpios_get_values(const struct gpio_desc *desc_list, int count,
+			ulong *valuesp);
+
+/**
+ * dm_gpios_set_values() - Set the values of a list of GPIOs
+ *
+ * GPIOs in the same bank are set together where the driver supports it,
+ * which is useful for bit-banged buses.
+ *
+ * @desc_list:	List of GPIOs to set, each previously returned by
+ *		gpio_request_by_name() or similar
+ * @count:	Number of GPIOs in @desc_list, at most BITS_PER_LONG
+ * @values:	Values to set, with the value of the first GPIO in bit 0, the
+ *		second in bit 1, etc. (1 for active, 0 for inactive)
+ * @return 0 if OK, -ve on error
+ */
+int dm_gpios_set_values(const struct gpio_desc *desc_list, int count,
+			ulong values);
+
 /**
  * dm_gpio_get_open_drain() - Check if open-drain-mode of a GPIO is active
  *
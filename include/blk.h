@@ -197,6 +197,30 @@ static inline void blkcache_invalidate(int iftype, int dev) {}
 
 #endif
 
+#if CONFIG_IS_ENABLED(FS_DCACHE)
+/**
+ * fs_dcache_invalidate() - drop the cached path lookups for a block device
+ * because of a write or device (re)initialization
+ *
+ * @desc: Block device
+ */
+void fs_dcache_invalidate(struct blk_desc *desc);
+#else
+static inline void fs_dcache_invalidate(struct blk_desc *desc) {}
+#endif
+
+#if CONFIG_IS_ENABLED(EFI_LOADER) && defined(CONFIG_PARTITIONS)
+/**
+ * efi_disk_invalidate() - drop the blocks read ahead for the EFI block I/O
+ * protocols because of a write or device (re)initialization
+ *
+ * @desc: Block device
+ */
+void efi_disk_invalidate(struct blk_desc *desc);
+#else
+static inline void efi_disk_invalidate(struct blk_desc *desc) {}
+#endif
+
 #if CONFIG_IS_ENABLED(BLK)
 struct udevice;
 
@@ -450,6 +474,8 @@ static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	fs_dcache_invalidate(block_dev);
+	efi_disk_invalidate(block_dev);
 	return block_dev->block_write(block_dev, start, blkcnt, buffer);
 }
 
@@ -457,6 +483,8 @@ static inline ulong blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt)
 {
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	fs_dcache_invalidate(block_dev);
+	efi_disk_invalidate(block_dev);
 	return block_dev->block_erase(block_dev, start, blkcnt);
 }
 
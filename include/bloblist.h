@@ -27,6 +27,8 @@ enum bloblist_tag_t {
 	BLOBLISTT_SPL_HANDOFF,		/* Hand-off info from SPL */
 	BLOBLISTT_VBOOT_CTX,		/* Chromium OS verified boot context */
 	BLOBLISTT_VBOOT_HANDOFF,	/* Chromium OS internal handoff info */
+	BLOBLISTT_MMC_TUNING,		/* eMMC mode and tuning results */
+	BLOBLISTT_DM_HANDOFF,		/* Driver-model device state */
 };
 
 /**
@@ -135,7 +137,8 @@ void *bloblist_add(uint tag, int size);
  * @size:	Size of the blob
  * @blobp:	Returns a pointer to blob on success
  * @return 0 if OK, -ENOSPC if it is missing and could not be added due to lack
- *	of space, or -ESPIPE it exists but has the wrong size
+ *	of space, -ESPIPE it exists but has the wrong size, or -ENOENT if there
+ *	is no bloblist
  */
 int bloblist_ensure_size(uint tag, int size, void **blobp);
 
@@ -13,6 +13,9 @@ int btrfs_ls(const char *);
 int btrfs_exists(const char *);
 int btrfs_size(const char *, loff_t *);
 int btrfs_read(const char *, void *, loff_t, loff_t, loff_t *);
+int btrfs_open(const char *, void **, loff_t *);
+int btrfs_pread(void *, void *, loff_t, loff_t, loff_t *);
+void btrfs_close_file(void *);
 void btrfs_close(void);
 int btrfs_uuid(char *);
 void btrfs_list_subvols(void);
@@ -307,6 +307,26 @@ int clk_disable_bulk(struct clk_bulk *bulk);
  */
 bool clk_is_match(const struct clk *p, const struct clk *q);
 
+/**
+ * struct clk_cache_stats - Statistics for the rate cache of a clock device
+ *
+ * @hits: Number of clk_get_rate() calls answered from the cache
+ * @misses: Number of clk_get_rate() calls passed on to the driver
+ */
+struct clk_cache_stats {
+	uint hits;
+	uint misses;
+};
+
+/**
+ * clk_get_cache_stats() - Get the rate-cache statistics of a clock device
+ *
+ * @dev: Clock device, which must be probed
+ * @stats: Returns the statistics
+ * @return 0 if OK, -ENOSYS if clock rates are not cached
+ */
+int clk_get_cache_stats(struct udevice *dev, struct clk_cache_stats *stats);
+
 #else
 static inline int clk_request(struct udevice *dev, struct clk *clk)
 {
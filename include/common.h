@@ -402,6 +402,7 @@ ulong	video_setmem (ulong);
 
 /* arch/$(ARCH)/lib/cache.c */
 void	enable_caches(void);
+int	enable_caches_early(void);
 void	flush_cache   (unsigned long, unsigned long);
 void	flush_dcache_all(void);
 void	flush_dcache_range(unsigned long start, unsigned long stop);
@@ -438,6 +439,25 @@ int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
 
+/**
+ * gunzip_exact() - Decompress gzip data whose compressed size is exact
+ *
+ * *@lenp should be the exact size of the gzip data, so that the uncompressed
+ * size can be read from the gzip trailer. The data is then inflated in one
+ * pass straight into @dst, limited to that size, and the result is checked
+ * against the trailer. If the trailer does not fit the data, for example
+ * because the image is padded, this falls back to gunzip().
+ *
+ * @dst:	Destination buffer
+ * @dstlen:	Size of @dst in bytes
+ * @src:	gzip data
+ * @lenp:	On entry, size of the gzip data. On exit, the number of bytes
+ *		decompressed
+ * @return 0 if OK, -1 on error
+ */
+int gunzip_exact(void *dst, int dstlen, unsigned char *src,
+		 unsigned long *lenp);
+
 /**
  * gzwrite progress indicators: defined weak to allow board-specific
  * overrides:
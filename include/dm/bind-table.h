@@ -0,0 +1,171 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Table for binding devices without scanning the device tree
+ *
+ * This is generated by dtoc from the control device tree when
+ * CONFIG_OF_BIND_TABLE is enabled. See dts/Makefile.
+ */
+
+#ifndef _DM_BIND_TABLE_H_
+#define _DM_BIND_TABLE_H_
+
+#include <fdtdec.h>
+#include <linux/compiler.h>
+
+struct driver;
+
+/**
+ * struct dm_bind_driver - A driver which matches a node's compatible string
+ *
+ * @drv:	Driver, or NULL if it is not built into this image
+ * @compat:	Compatible string which the driver matches
+ * @compat_idx:	Position of @compat in the node's compatible list
+ */
+struct dm_bind_driver {
+	struct driver *drv;
+	const char *compat;
+	uint compat_idx;
+};
+
+/**
+ * enum dm_bind_flags - Flags for a node in the bind table
+ *
+ * @DM_BIND_PRE_RELOC:	Node is marked to be bound before relocation
+ * @DM_BIND_DISABLED:	Node's status is not "okay"
+ * @DM_BIND_CONTAINER:	Node is not a device, but its subnodes may be
+ */
+enum dm_bind_flags {
+	DM_BIND_PRE_RELOC	= 1 << 0,
+	DM_BIND_DISABLED	= 1 << 1,
+	DM_BIND_CONTAINER	= 1 << 2,
+};
+
+/**
+ * struct dm_bind_node - A device tree node in the bind table
+ *
+ * Nodes are in device-tree order, so are sorted by offset.
+ *
+ * @offset:	Offset of the node in the device tree
+ * @addr:	CPU address of the node's first 'reg' entry, or
+ *		FDT_ADDR_T_NONE if it has none or it was not worked out at
+ *		build time
+ * @first_child: Index of the node's first subnode, or -1 if none
+ * @next_sibling: Index of the node's next sibling, or -1 if none
+ * @first_driver: Index of the node's first driver in the driver table
+ * @num_drivers: Number of drivers for this node, in the order in which
+ *		they should be tried
+ * @flags:	Flags for this node (enum dm_bind_flags)
+ */
+struct dm_bind_node {
+	int offset;
+	fdt_addr_t addr;
+	int first_child;
+	int next_sibling;
+	u16 first_driver;
+	u8 num_drivers;
+	u8 flags;
+};
+
+/**
+ * struct dm_bind_phandle - A phandle in the bind table
+ *
+ * @phandle:	Phandle value
+ * @offset:	Offset of the node with this phandle
+ */
+struct dm_bind_phandle {
+	u32 phandle;
+	int offset;
+};
+
+/**
+ * struct dm_bind_table - Device tree information prepared at build time
+ *
+ * The sizes and CRC identify the device tree the table was generated from.
+ * The table is ignored for any other tree.
+ *
+ * @fdt_size:	Total size of the device tree
+ * @struct_size: Size of the structure block of the device tree
+ * @strings_size: Size of the strings block of the device tree
+ * @crc:	CRC32 of the structure block followed by the strings block
+ * @nodes:	All nodes in the device tree, starting with the root
+ * @num_nodes:	Number of entries in @nodes
+ * @drivers:	Drivers for the nodes
+ * @phandles:	Phandles in the device tree, sorted by value
+ * @num_phandles: Number of entries in @phandles
+ */
+struct dm_bind_table {
+	u32 fdt_size;
+	u32 struct_size;
+	u32 strings_size;
+	u32 crc;
+	const struct dm_bind_node *nodes;
+	uint num_nodes;
+	const struct dm_bind_driver *drivers;
+	const struct dm_bind_phandle *phandles;
+	uint num_phandles;
+};
+
+/* Refer to a driver which may not be built in, from the generated table */
+#define DM_BIND_DRIVER_DECL(_name) \
+	extern struct driver _u_boot_list_2_driver_2_##_name __weak
+#define DM_BIND_DRIVER(_name)	(&_u_boot_list_2_driver_2_##_name)
+
+extern const struct dm_bind_table dm_bind_table;
+
+#if CONFIG_IS_ENABLED(OF_BIND_TABLE)
+/**
+ * dm_bind_table_valid() - Check if the bind table applies to a device tree
+ *
+ * @blob:	Device tree to check
+ * The contents of each device tree are only checked the first time it is
+ * passed in. The tree must not change after that.
+ *
+ * @return true if @blob is the control device tree and the table was
+ *	generated from it
+ */
+bool dm_bind_table_valid(const void *blob);
+
+/**
+ * dm_bind_table_find() - Find a node in the bind table
+ *
+ * @offset:	Offset of the node in the device tree
+ * @return the node, or NULL if not found
+ */
+const struct dm_bind_node *dm_bind_table_find(int offset);
+
+/**
+ * dm_bind_table_phandle() - Find the node with a given phandle
+ *
+ * @phandle:	Phandle to look up
+ * @return node offset, or -FDT_ERR_NOTFOUND if not found
+ */
+int dm_bind_table_phandle(u32 phandle);
+
+/**
+ * dm_bind_table_addr() - Get the translated address of a node
+ *
+ * @blob:	Device tree containing the node
+ * @offset:	Offset of the node
+ * @return CPU address of the node's first 'reg' entry, or FDT_ADDR_T_NONE
+ *	if this is not known, in which case the caller should translate the
+ *	address itself
+ */
+fdt_addr_t dm_bind_table_addr(const void *blob, int offset);
+#else
+static inline bool dm_bind_table_valid(const void *blob)
+{
+	return false;
+}
+
+static inline int dm_bind_table_phandle(u32 phandle)
+{
+	return -FDT_ERR_NOTFOUND;
+}
+
+static inline fdt_addr_t dm_bind_table_addr(const void *blob, int offset)
+{
+	return FDT_ADDR_T_NONE;
+}
+#endif
+
+#endif
@@ -123,6 +123,8 @@ enum {
  *		When CONFIG_DEVRES is enabled, devm_kmalloc() and friends will
  *		add to this list. Memory so-allocated will be freed
  *		automatically when the device is removed / unbound
+ * @name_hnode: Used by the uclass index to hash this device by name
+ * @node_hnode: Used by the uclass index to hash this device by node
  */
 struct udevice {
 	const struct driver *driver;
@@ -146,6 +148,10 @@ struct udevice {
 #ifdef CONFIG_DEVRES
 	struct list_head devres_head;
 #endif
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct hlist_node name_hnode;
+	struct hlist_node node_hnode;
+#endif
 };
 
 /* Maximum sequence number supported */
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Passing device state from one boot phase to the next
+ */
+
+#ifndef __DM_HANDOFF_H
+#define __DM_HANDOFF_H
+
+struct udevice;
+
+/*
+ * Tags for dev_handoff_save() and dev_handoff_find(). These only need to be
+ * unique for a particular device, but keeping them in one list makes it
+ * easier to see what state is passed on.
+ */
+enum dev_handoff_tag {
+	DEV_HANDOFF_NONE = 0,
+	DEV_HANDOFF_TEST,		/* Used by the driver model tests */
+	DEV_HANDOFF_SPI_NOR,		/* SPI NOR flash parameters (SFDP) */
+};
+
+#if CONFIG_IS_ENABLED(DM_HANDOFF)
+/**
+ * dev_handoff_save() - Save the state of a device for a later boot phase
+ *
+ * The state is stored in the bloblist. It is found again by the uclass and
+ * the names of the device and its parents, so the device must have the same
+ * name (normally its device tree node name) in each phase. Any state already
+ * saved for the same device and tag is replaced.
+ *
+ * The state must not contain pointers, and should only use fixed-size types,
+ * since the next phase may not use the same architecture (e.g. 32-bit SPL
+ * and 64-bit U-Boot proper).
+ *
+ * @dev:	Device whose state is saved
+ * @tag:	Kind of state (enum dev_handoff_tag)
+ * @data:	State to save
+ * @size:	Size of @data in bytes
+ * @return 0 if OK, -ENOENT if there is no bloblist, -ENOSPC if there is not
+ *	enough space (see CONFIG_DM_HANDOFF_SIZE)
+ */
+int dev_handoff_save(struct udevice *dev, uint tag, const void *data,
+		     int size);
+
+/**
+ * dev_handoff_find() - Find state saved for a device by an earlier boot phase
+ *
+ * @dev:	Device to check
+ * @tag:	Kind of state (enum dev_handoff_tag)
+ * @size:	Expected size of the state in bytes
+ * @return pointer to the state, or NULL if none was saved or it has a
+ *	different size
+ */
+const void *dev_handoff_find(struct udevice *dev, uint tag, int size);
+
+/**
+ * dev_handoff_drop() - Drop state saved for a device
+ *
+ * This should be used if the state turns out to be wrong, e.g. because the
+ * hardware has changed, so that later phases do not use it.
+ *
+ * @dev:	Device whose state is dropped
+ * @tag:	Kind of state (enum dev_handoff_tag)
+ */
+void dev_handoff_drop(struct udevice *dev, uint tag);
+#else
+static inline int dev_handoff_save(struct udevice *dev, uint tag,
+				   const void *data, int size)
+{
+	return -ENOSYS;
+}
+
+static inline const void *dev_handoff_find(struct udevice *dev, uint tag,
+					   int size)
+{
+	return NULL;
+}
+
+static inline void dev_handoff_drop(struct udevice *dev, uint tag)
+{
+}
+#endif
+
+#endif
@@ -61,6 +61,24 @@ int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		   bool pre_reloc_only);
 
+struct dm_bind_node;
+
+/**
+ * lists_bind_table() - bind a device tree node using the bind table
+ *
+ * This is the same as lists_bind_fdt() except that the drivers for the node
+ * come from the table generated at build time instead of a search of the
+ * driver list.
+ *
+ * @parent: parent device
+ * @bnode: bind-table entry of the node to bind
+ * @pre_reloc_only: If true, bind only nodes with special devicetree properties,
+ * or drivers with the DM_FLAG_PRE_RELOC flag. If false bind all drivers.
+ * @return 0 if OK (including when no driver was bound), -ve on error
+ */
+int lists_bind_table(struct udevice *parent, const struct dm_bind_node *bnode,
+		     bool pre_reloc_only);
+
 /**
  * device_bind_driver() - bind a device to a driver
  *
@@ -218,6 +218,18 @@ struct device_node *of_find_node_by_prop_value(struct device_node *from,
  */
 struct device_node *of_find_node_by_phandle(phandle handle);
 
+/**
+ * of_populate_phandle_cache() - Build the phandle-to-node lookup table
+ *
+ * This indexes every node in the live tree by its phandle so that
+ * of_find_node_by_phandle() does not need to walk the tree. It must be
+ * called again if the tree is rebuilt. Lookups still work (more slowly) if
+ * the table is missing or stale.
+ *
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+int of_populate_phandle_cache(void);
+
 /**
  * of_read_u32() - Find and read a 32-bit integer from a property
  *
@@ -114,6 +114,18 @@ int dm_init(bool of_live);
  */
 int dm_uninit(void);
 
+/**
+ * dm_probe_preload() - Probe the devices listed in /chosen/u-boot,dm-preload
+ *
+ * With CONFIG_DM_DEFERRED_PROBE, devices are only probed when they are
+ * first used. This probes the devices which the board wants ready early,
+ * each after the power-domain, clock and reset providers it refers to.
+ * Failures are reported but are not fatal.
+ *
+ * @return 0 if OK, -ve on error
+ */
+int dm_probe_preload(void);
+
 #if CONFIG_IS_ENABLED(DM_DEVICE_REMOVE)
 /**
  * dm_remove_devices_flags - Call remove function of all drivers with
@@ -214,4 +214,19 @@ void dm_leak_check_start(struct unit_test_state *uts);
  * @dms: Overall test state
  */int dm_leak_check_end(struct unit_test_state *uts);
 
+/**
+ * dm_test_with_bloblist() - Run part of a test with its own bloblist
+ *
+ * This points gd->bloblist at a new, empty bloblist while @func runs, then
+ * puts back the previous one whether or not @func succeeds. The bloblist
+ * set up by the board is not touched.
+ *
+ * @uts: Overall test state
+ * @size: Size of the bloblist in bytes, or 0 to run @func with no bloblist
+ * @func: Function to run
+ * @return 0 if OK, -ve on error
+ */
+int dm_test_with_bloblist(struct unit_test_state *uts, uint size,
+			  int (*func)(struct unit_test_state *uts));
+
 #endif
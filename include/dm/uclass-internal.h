@@ -196,6 +196,31 @@ int uclass_unbind_device(struct udevice *dev);
 static inline int uclass_unbind_device(struct udevice *dev) { return 0; }
 #endif
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/**
+ * uclass_index_device() - Add a newly bound device to its uclass's index
+ *
+ * This is called once the device and its driver have finished binding, so
+ * that any name or requested sequence number they set up is used.
+ *
+ * @dev:	Pointer to the device
+ */
+void uclass_index_device(struct udevice *dev);
+#else
+static inline void uclass_index_device(struct udevice *dev) {}
+#endif
+
+/**
+ * uclass_set_seq() - Set the sequence number of a device
+ *
+ * This keeps the uclass's index up to date, so must be used instead of
+ * setting dev->seq directly.
+ *
+ * @dev:	Pointer to the device
+ * @seq:	Sequence number, or -1 if the device is no longer probed
+ */
+void uclass_set_seq(struct udevice *dev, int seq);
+
 /**
  * uclass_pre_probe_device() - Deal with a device that is about to be probed
  *
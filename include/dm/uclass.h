@@ -14,6 +14,8 @@
 #include <linker_lists.h>
 #include <linux/list.h>
 
+struct uclass_index;
+
 /**
  * struct uclass - a U-Boot drive class, collecting together similar drivers
  *
@@ -30,12 +32,17 @@
  * @dev_head: List of devices in this uclass (devices are attached to their
  * uclass when their bind method is called)
  * @sibling_node: Next uclass in the linked list of uclasses
+ * @index: Lookup tables for the devices in this uclass, or NULL if the
+ * uclass was created before relocation or the tables could not be allocated
  */
 struct uclass {
 	void *priv;
 	struct uclass_driver *uc_drv;
 	struct list_head dev_head;
 	struct list_head sibling_node;
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct uclass_index *index;
+#endif
 };
 
 struct driver;
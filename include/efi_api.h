@@ -504,6 +504,31 @@ struct efi_block_io {
 	efi_status_t (EFIAPI *flush_blocks)(struct efi_block_io *this);
 };
 
+#define EFI_BLOCK_IO2_PROTOCOL_GUID \
+	EFI_GUID(0xa77b2472, 0xe282, 0x4e9f, \
+		 0xa2, 0x45, 0xc2, 0xc0, 0xe2, 0x7b, 0xbc, 0xc1)
+
+struct efi_block_io2_token {
+	struct efi_event *event;
+	efi_status_t transaction_status;
+};
+
+struct efi_block_io2 {
+	struct efi_block_io_media *media;
+	efi_status_t (EFIAPI *reset)(struct efi_block_io2 *this,
+			bool extended_verification);
+	efi_status_t (EFIAPI *read_blocks_ex)(struct efi_block_io2 *this,
+			u32 media_id, u64 lba,
+			struct efi_block_io2_token *token,
+			efi_uintn_t buffer_size, void *buffer);
+	efi_status_t (EFIAPI *write_blocks_ex)(struct efi_block_io2 *this,
+			u32 media_id, u64 lba,
+			struct efi_block_io2_token *token,
+			efi_uintn_t buffer_size, void *buffer);
+	efi_status_t (EFIAPI *flush_blocks_ex)(struct efi_block_io2 *this,
+			struct efi_block_io2_token *token);
+};
+
 struct simple_text_output_mode {
 	s32 max_mode;
 	s32 mode;
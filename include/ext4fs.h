@@ -145,11 +145,16 @@ int ext4fs_size(const char *filename, loff_t *size);
 void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot);
 int ext4fs_devread(lbaint_t sector, int byte_offset, int byte_len, char *buf);
 void ext4fs_set_blk_dev(struct blk_desc *rbdd, disk_partition_t *info);
+disk_partition_t *ext4fs_get_part_info(void);
 long int read_allocated_block(struct ext2_inode *inode, int fileblock);
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 disk_partition_t *fs_partition);
 int ext4_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 		   loff_t *actread);
+int ext4fs_open_file(const char *filename, void **filep, loff_t *size);
+int ext4fs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread);
+void ext4fs_close_file(void *priv);
 int ext4_read_superblock(char *buffer);
 int ext4fs_uuid(char *uuid_str);
 #endif
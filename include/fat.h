@@ -200,6 +200,10 @@ int file_fat_write(const char *filename, void *buf, loff_t offset, loff_t len,
 		   loff_t *actwrite);
 int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 		  loff_t *actread);
+int fat_open(const char *filename, void **filep, loff_t *size);
+int fat_pread(void *priv, void *buf, loff_t offset, loff_t len,
+	      loff_t *actread);
+void fat_close_file(void *priv);
 int fat_opendir(const char *filename, struct fs_dir_stream **dirsp);
 int fat_readdir(struct fs_dir_stream *dirs, struct fs_dirent **dentp);
 void fat_closedir(struct fs_dir_stream *dirs);
@@ -664,6 +664,30 @@ const char *fdtdec_get_compatible(enum fdt_compat_id id);
  */
 int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name);
 
+/**
+ * fdtdec_node_offset_by_phandle() - Find the node with a given phandle
+ *
+ * This is equivalent to fdt_node_offset_by_phandle() but, for the control
+ * device tree after relocation, uses an index built on first use rather
+ * than scanning the whole tree. The index is checked on each lookup and
+ * rebuilt if the tree has changed underneath it. With CONFIG_OF_BIND_TABLE
+ * the table of phandles generated at build time is used instead, also before
+ * relocation.
+ *
+ * @blob:	FDT blob
+ * @phandle:	phandle to look up
+ * @return node offset if found, -ve FDT_ERR_... on error
+ */
+#if CONFIG_IS_ENABLED(OF_INDEX) || CONFIG_IS_ENABLED(OF_BIND_TABLE)
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle);
+#else
+static inline int fdtdec_node_offset_by_phandle(const void *blob,
+						uint32_t phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+#endif
+
 /**
  * Look up a property in a node and return its contents in an integer
  * array of given length. The property must have at least enough data for
@@ -85,6 +85,48 @@ int fs_size(const char *filename, loff_t *size);
 int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	    loff_t *actread);
 
+struct fs_file;
+
+/*
+ * fs_open - Open a file on the partition previously set by fs_set_blk_dev()
+ *
+ * The filesystem stays mounted until the last file on it is closed, so that
+ * fs_set_blk_dev() for the same partition does not probe it again. Reading
+ * from an open file does not look up its path again.
+ *
+ * Filesystem drivers only keep one filesystem mounted at a time. If another
+ * partition is set in the meantime, the file's filesystem is probed again
+ * when the file is next read.
+ *
+ * @filename: Name of file to open
+ * @filep: Returns the open file
+ * @size: Returns the size of the file
+ * @return 0 if ok, -ve on error
+ */
+int fs_open(const char *filename, struct fs_file **filep, loff_t *size);
+
+/*
+ * fs_pread - Read from an open file
+ *
+ * This does not need fs_set_blk_dev() to be called first.
+ *
+ * @file: File to read from
+ * @buf: Buffer to read into
+ * @offset: The offset in file to read from
+ * @len: The number of bytes to read. Maybe 0 to read to the end of the file
+ * @actread: Returns the actual number of bytes read
+ * @return 0 if ok with valid *actread, -ve on error
+ */
+int fs_pread(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+	     loff_t *actread);
+
+/*
+ * fs_close_file - Close a file opened by fs_open()
+ *
+ * @file: File to close, may be NULL
+ */
+void fs_close_file(struct fs_file *file);
+
 /*
  * fs_write - Write file to the partition previously set by fs_set_blk_dev()
  * Note that not all filesystem types support offset!=0.
@@ -173,6 +215,57 @@ int fs_unlink(const char *filename);
  */
 int fs_mkdir(const char *filename);
 
+/* Largest filesystem information kept for a path by the lookup cache */
+#define FS_DCACHE_DATA_SIZE	32
+/* Longest path kept by the lookup cache, including the terminator */
+#define FS_DCACHE_PATH_MAX	128
+
+#if CONFIG_IS_ENABLED(FS_DCACHE)
+/*
+ * fs_dcache_lookup - Look up a path in the lookup cache
+ *
+ * @desc: Block device holding the filesystem
+ * @part: Partition holding the filesystem
+ * @fstype: Filesystem type (FS_TYPE_...)
+ * @path: Path as passed to the filesystem
+ * @data: Returns the information stored by fs_dcache_add(), if found
+ * @size: Size of @data
+ * @return 1 if the path exists, 0 if it does not, -ENOENT if it is not in
+ *	the cache
+ */
+int fs_dcache_lookup(struct blk_desc *desc, disk_partition_t *part,
+		     int fstype, const char *path, void *data, uint size);
+
+/*
+ * fs_dcache_add - Add the result of a path lookup to the lookup cache
+ *
+ * Paths longer than FS_DCACHE_PATH_MAX are not cached.
+ *
+ * @desc: Block device holding the filesystem
+ * @part: Partition holding the filesystem
+ * @fstype: Filesystem type (FS_TYPE_...)
+ * @path: Path as passed to the filesystem
+ * @data: Information needed to use the path again without looking it up,
+ *	or NULL if the path does not exist
+ * @size: Size of @data, at most FS_DCACHE_DATA_SIZE
+ */
+void fs_dcache_add(struct blk_desc *desc, disk_partition_t *part, int fstype,
+		   const char *path, const void *data, uint size);
+#else
+static inline int fs_dcache_lookup(struct blk_desc *desc,
+				   disk_partition_t *part, int fstype,
+				   const char *path, void *data, uint size)
+{
+	return -ENOENT;
+}
+
+static inline void fs_dcache_add(struct blk_desc *desc, disk_partition_t *part,
+				 int fstype, const char *path,
+				 const void *data, uint size)
+{
+}
+#endif
+
 /*
  * Common implementation for various filesystem commands, optionally limited
  * to a specific filesystem type via the fstype parameter.
@@ -893,6 +893,17 @@ void malloc_simple_info(void);
 # define pvALLOc		dlpvalloc
 # define mALLINFo	dlmallinfo
 # define mALLOPt		dlmallopt
+# elif CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+/* malloc_slab.c provides the public versions of these */
+# define cALLOc		dlcalloc
+# define fREe		dlfree
+# define mALLOc		dlmalloc
+# define mEMALIGn	dlmemalign
+# define rEALLOc		dlrealloc
+# define vALLOc		valloc
+# define pvALLOc		pvalloc
+# define mALLINFo	mallinfo
+# define mALLOPt		mallopt
 # else /* USE_DL_PREFIX */
 # define cALLOc		calloc
 # define fREe		free
@@ -931,6 +942,13 @@ size_t  malloc_usable_size(Void_t*);
 void    malloc_stats(void);
 int     mALLOPt(int, int);
 struct mallinfo mALLINFo(void);
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+void *malloc(size_t bytes);
+void free(void *mem);
+void *realloc(void *oldmem, size_t bytes);
+void *memalign(size_t alignment, size_t bytes);
+void *calloc(size_t n, size_t elem_size);
+#endif
 # else
 Void_t* mALLOc();
 void    fREe();
@@ -958,6 +976,102 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/* Number of size classes in the slab front-end */
+#define MALLOC_SLAB_CLASSES	10
+
+/* Number of buckets in the histogram of allocation sizes */
+#define MALLOC_HIST_BUCKETS	16
+
+/**
+ * struct malloc_slab_info - Usage of one slab size class
+ *
+ * @size:	Object size in bytes
+ * @pages:	Number of pages holding objects of this size
+ * @objs:	Number of objects currently allocated
+ * @allocs:	Total number of allocations from this class
+ */
+struct malloc_slab_info {
+	uint size;
+	uint pages;
+	uint objs;
+	ulong allocs;
+};
+
+/**
+ * struct malloc_stats - malloc() statistics since relocation
+ *
+ * @heap_size:		Size of the dlmalloc heap in bytes
+ * @heap_free:		Free bytes in the dlmalloc heap
+ * @largest_free:	Largest free block in the dlmalloc heap
+ * @free_blocks:	Number of free blocks in the dlmalloc heap
+ * @in_use:		Bytes currently allocated, after rounding up
+ * @peak:		Highest value of @in_use
+ * @allocs:		Number of allocations
+ * @frees:		Number of frees
+ * @hist:		Number of allocations by requested size: bucket 0 is
+ *			up to 16 bytes, bucket 1 up to 32 and so on, with the
+ *			last bucket counting all larger ones
+ * @slab_size:		Size of the slab arena in bytes
+ * @slab_in_use:	Bytes currently allocated from the slab arena
+ * @slab_free_pages:	Number of unused pages in the slab arena
+ * @slab_misses:	Small allocations passed to dlmalloc because the slab
+ *			arena was full
+ * @slab:		Usage of each slab size class
+ */
+struct malloc_stats {
+	ulong heap_size;
+	ulong heap_free;
+	ulong largest_free;
+	uint free_blocks;
+	ulong in_use;
+	ulong peak;
+	ulong allocs;
+	ulong frees;
+	ulong hist[MALLOC_HIST_BUCKETS];
+	ulong slab_size;
+	ulong slab_in_use;
+	uint slab_free_pages;
+	ulong slab_misses;
+	struct malloc_slab_info slab[MALLOC_SLAB_CLASSES];
+};
+
+/**
+ * malloc_slab_init() - Set up the slab arena for small allocations
+ *
+ * This is called by mem_malloc_init() to take the slab arena from the top of
+ * the malloc() region. It also resets the statistics.
+ *
+ * @start:	Start of the malloc() region
+ * @size:	Size of the malloc() region in bytes
+ * @return number of bytes taken from the top of the region, which dlmalloc
+ *	must not use
+ */
+ulong malloc_slab_init(ulong start, ulong size);
+
+/**
+ * malloc_slab_mallinfo() - Add the slab arena to the information from dlmalloc
+ *
+ * @mi:		Information to update
+ */
+void malloc_slab_mallinfo(struct mallinfo *mi);
+
+/**
+ * malloc_heap_info() - Get the free space in the dlmalloc heap
+ *
+ * This fills in @heap_size, @heap_free, @largest_free and @free_blocks. It
+ * walks all free blocks so is not fast.
+ *
+ * @stats:	Returns heap information
+ */
+void malloc_heap_info(struct malloc_stats *stats);
+
+/**
+ * malloc_get_stats() - Get malloc() statistics
+ *
+ * @stats:	Returns the statistics
+ */
+void malloc_get_stats(struct malloc_stats *stats);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
@@ -447,6 +447,29 @@ struct dm_mmc_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*execute_tuning)(struct udevice *dev, uint opcode);
+
+	/**
+	 * get_tuning() - Read back the result of the last tuning
+	 *
+	 * This is used to pass the tuning result on to a later boot phase,
+	 * which can then use set_tuning() instead of execute_tuning().
+	 *
+	 * @dev:	Device that was tuned
+	 * @data:	Returns MMC_TUNING_WORDS words of driver-specific data
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*get_tuning)(struct udevice *dev, u32 *data);
+
+	/**
+	 * set_tuning() - Restore a tuning result from get_tuning()
+	 *
+	 * This is called with the bus mode and clock already set up.
+	 *
+	 * @dev:	Device to update
+	 * @data:	Data returned by get_tuning() for the same card and mode
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*set_tuning)(struct udevice *dev, const u32 *data);
 #endif
 
 #if CONFIG_IS_ENABLED(MMC_UHS_SUPPORT)
@@ -472,6 +495,8 @@ void dm_mmc_send_init_stream(struct udevice *dev);
 int dm_mmc_get_cd(struct udevice *dev);
 int dm_mmc_get_wp(struct udevice *dev);
 int dm_mmc_execute_tuning(struct udevice *dev, uint opcode);
+int dm_mmc_get_tuning(struct udevice *dev, u32 *data);
+int dm_mmc_set_tuning(struct udevice *dev, const u32 *data);
 int dm_mmc_wait_dat0(struct udevice *dev, int state, int timeout);
 
 /* Transition functions for compatibility */
@@ -561,6 +586,53 @@ static inline bool supports_uhs(uint caps)
 #endif
 }
 
+/* Words of driver-specific tuning data kept for each card */
+#define MMC_TUNING_WORDS	4
+
+/* Number of cards whose tuning results can be passed on */
+#define MMC_TUNING_MAX		2
+
+#define MMC_TUNING_VERSION	1
+
+/* Flags for struct mmc_tuning_rec */
+enum {
+	MMC_TUNINGF_DATA	= 1 << 0,	/* @data is valid */
+};
+
+/**
+ * struct mmc_tuning_rec - Mode and tuning result for one eMMC card
+ *
+ * @cid: CID of the card, so that the record is not used for another card
+ * @host_caps: Host capabilities when the record was made
+ * @mode: Selected bus mode (enum bus_mode)
+ * @ext_csd_bits: EXT_CSD_BUS_WIDTH value for the selected width
+ * @flags: MMC_TUNINGF_... flags
+ * @data: Driver-specific tuning data from the get_tuning() method
+ */
+struct mmc_tuning_rec {
+	u32 cid[4];
+	u32 host_caps;
+	u32 mode;
+	u32 ext_csd_bits;
+	u32 flags;
+	u32 data[MMC_TUNING_WORDS];
+};
+
+/**
+ * struct mmc_tuning_handoff - Tuning results passed between boot phases
+ *
+ * This is stored in the bloblist with the tag BLOBLISTT_MMC_TUNING
+ *
+ * @version: MMC_TUNING_VERSION
+ * @count: Number of valid records in @rec
+ * @rec: Tuning results, one for each card
+ */
+struct mmc_tuning_handoff {
+	u32 version;
+	u32 count;
+	struct mmc_tuning_rec rec[MMC_TUNING_MAX];
+};
+
 /*
  * With CONFIG_DM_MMC enabled, struct mmc can be accessed from the MMC device
  * with mmc_get_mmc_dev().
@@ -699,6 +771,37 @@ int mmc_send_tuning(struct mmc *mmc, u32 opcode, int *cmd_error);
  */
 int mmc_of_parse(struct udevice *dev, struct mmc_config *cfg);
 
+/**
+ * mmc_tuning_find() - Find the mode recorded for a card by an earlier phase
+ *
+ * @mmc:	MMC device, whose CID and host capabilities must both match
+ *		those in the record
+ * @return pointer to the record in the bloblist, or NULL if none
+ */
+struct mmc_tuning_rec *mmc_tuning_find(struct mmc *mmc);
+
+/**
+ * mmc_tuning_put() - Record the mode selected for a card
+ *
+ * This replaces any existing record for the card
+ *
+ * @mmc:	MMC device, giving the CID and host capabilities
+ * @mode:	Selected bus mode (enum bus_mode)
+ * @ext_csd_bits: EXT_CSD_BUS_WIDTH value for the selected width
+ * @data:	MMC_TUNING_WORDS words of tuning data, or NULL if none
+ * @return 0 if OK, -ENOENT if there is no bloblist, -ENOSPC if there are
+ *	already records for MMC_TUNING_MAX other cards
+ */
+int mmc_tuning_put(struct mmc *mmc, uint mode, uint ext_csd_bits,
+		   const u32 *data);
+
+/**
+ * mmc_tuning_drop() - Remove the record for a card, if any
+ *
+ * @mmc:	MMC device, giving the CID
+ */
+void mmc_tuning_drop(struct mmc *mmc);
+
 int mmc_read(struct mmc *mmc, u64 src, uchar *dst, int size);
 
 /**
@@ -52,6 +52,7 @@
  * @reg_width:		IO accesses size of registers (in bytes)
  * @reg_shift:		Shift size of registers (0=byte, 1=16bit, 2=32bit...)
  * @clock:		UART base clock speed in Hz
+ * @fifo_size:		Size of the transmit FIFO in bytes, 0 if unknown
  */
 struct ns16550_platdata {
 	unsigned long base;
@@ -60,6 +61,7 @@ struct ns16550_platdata {
 	int reg_offset;
 	int clock;
 	u32 fcr;
+	u32 fifo_size;
 };
 
 struct udevice;
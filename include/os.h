@@ -364,4 +364,22 @@ int os_write_file(const char *name, const void *buf, int size);
  */
 int os_read_file(const char *name, void **bufp, int *sizep);
 
+
+/**
+ * os_run_threads() - Run a function on several host threads at once
+ *
+ * This calls @fn once for each index from 0 to @count - 1, each on its own
+ * thread except index 0, which runs on the calling thread. It returns when
+ * all calls have finished. If a thread cannot be created, its index runs
+ * on the calling thread instead.
+ *
+ * @fn:		Function to call
+ * @arg:	Argument to pass to @fn
+ * @count:	Number of calls to make
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+int os_run_threads(void (*fn)(void *arg, unsigned int index,
+			      unsigned int count),
+		   void *arg, unsigned int count);
+
 #endif
@@ -297,13 +297,62 @@ int pmic_reg_write(struct udevice *dev, uint reg, uint value);
  */
 int pmic_clrsetbits(struct udevice *dev, uint reg, uint clr, uint set);
 
+/**
+ * pmic_batch_start() - start holding back PMIC register writes
+ *
+ * If the PMIC has a register cache (see CONFIG_DM_PMIC_REG_CACHE), writes
+ * to cacheable registers only update the cache until pmic_batch_end() is
+ * called. They are then written out together, with consecutive registers
+ * written in a single transfer if the device allows it. Reads still return
+ * the values written. Calls may be nested.
+ *
+ * Do not use this around writes which need a delay between them.
+ *
+ * @dev:	PMIC device
+ * @return 0 on success or negative value of errno.
+ */
+int pmic_batch_start(struct udevice *dev);
+
+/**
+ * pmic_batch_end() - write out the PMIC register writes held back
+ *
+ * This ends the batch started by the matching pmic_batch_start(). Once the
+ * outermost batch ends, all held-back writes are sent to the device.
+ *
+ * @dev:	PMIC device
+ * @return 0 on success or negative value of errno.
+ */
+int pmic_batch_end(struct udevice *dev);
+
+/**
+ * pmic_cache_sync() - write out any PMIC register writes held back
+ *
+ * @dev:	PMIC device
+ * @return 0 on success or negative value of errno.
+ */
+int pmic_cache_sync(struct udevice *dev);
+
+/**
+ * pmic_cache_invalidate() - forget the cached PMIC register values
+ *
+ * This should be used if the registers may have been changed without going
+ * through the PMIC uclass, e.g. because the PMIC was reset. Writes which
+ * are being held back are kept.
+ *
+ * @dev:	PMIC device
+ */
+void pmic_cache_invalidate(struct udevice *dev);
+
+struct pmic_reg_cache;
+
 /*
  * This structure holds the private data for PMIC uclass
  * For now we store information about the number of bytes
- * being sent at once to the device.
+ * being sent at once to the device, and the register cache (if any).
  */
 struct uc_pmic_priv {
 	uint trans_len;
+	struct pmic_reg_cache *cache;
 };
 
 #endif /* CONFIG_DM_PMIC */
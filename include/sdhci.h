@@ -266,6 +266,8 @@ struct sdhci_ops {
 	int	(*set_ios_post)(struct sdhci_host *host);
 	void	(*set_clock)(struct sdhci_host *host, u32 div);
 	int (*platform_execute_tuning)(struct mmc *host, u8 opcode);
+	int (*platform_get_tuning)(struct mmc *host, u32 *data);
+	int (*platform_set_tuning)(struct mmc *host, const u32 *data);
 	void (*set_delay)(struct sdhci_host *host);
 };
 
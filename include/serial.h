@@ -189,6 +189,23 @@ struct dm_serial_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*putc)(struct udevice *dev, const char ch);
+	/**
+	 * puts() - Write a string of characters
+	 *
+	 * Write as many characters from @s as the device can accept without
+	 * waiting, for example by filling the transmit FIFO. The uclass
+	 * calls this again with the rest. Newlines are already translated,
+	 * so @s should be sent as is.
+	 *
+	 * This method is optional and is only used with CONFIG_SERIAL_PUTS.
+	 *
+	 * @dev: Device pointer
+	 * @s: Characters to write
+	 * @len: Number of characters in @s
+	 * @return number of characters written (which may be fewer than
+	 * @len), -EAGAIN if none could be written, other -ve on error
+	 */
+	ssize_t (*puts)(struct udevice *dev, const char *s, size_t len);
 	/**
 	 * pending() - Check if input/output characters are waiting
 	 *
@@ -269,6 +286,10 @@ struct dm_serial_ops {
  * @buf:	Pointer to the RX buffer
  * @rd_ptr:	Read pointer in the RX buffer
  * @wr_ptr:	Write pointer in the RX buffer
+ *
+ * @tx_buf:	Pointer to the TX buffer, or NULL if output is not buffered
+ * @tx_rd_ptr:	Read pointer in the TX buffer
+ * @tx_wr_ptr:	Write pointer in the TX buffer
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
@@ -276,11 +297,31 @@ struct serial_dev_priv {
 	char *buf;
 	int rd_ptr;
 	int wr_ptr;
+
+	char *tx_buf;
+	int tx_rd_ptr;
+	int tx_wr_ptr;
 };
 
 /* Access the serial operations for a device */
 #define serial_get_ops(dev)	((struct dm_serial_ops *)(dev)->driver->ops)
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/**
+ * serial_flush() - Send all buffered output to the console UART
+ *
+ * With CONFIG_SERIAL_TX_BUFFER, output can be held in RAM while the UART
+ * is busy. This waits until it has all been passed to the UART and the
+ * UART has finished sending it. Call this before starting an OS, which
+ * may reset the UART or reuse the memory.
+ */
+void serial_flush(void);
+#else
+static inline void serial_flush(void)
+{
+}
+#endif
+
 void atmel_serial_initialize(void);
 void mcf_serial_initialize(void);
 void mpc85xx_serial_initialize(void);
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Running short jobs on all CPUs
+ */
+
+#ifndef __SMP_H
+#define __SMP_H
+
+/**
+ * typedef smp_job_fn - Job function run by smp_run_on_cpus()
+ *
+ * @arg:	Argument passed to smp_run_on_cpus()
+ * @cpu:	Index of the CPU running this call, 0 being the boot CPU
+ * @ncpus:	Number of CPUs running the job
+ */
+typedef void (*smp_job_fn)(void *arg, uint cpu, uint ncpus);
+
+#if CONFIG_IS_ENABLED(SMP_JOBS)
+/**
+ * smp_run_on_cpus() - Run a job on all available CPUs
+ *
+ * This calls @fn once on each CPU, each with a different index from 0 to
+ * @ncpus - 1, and waits for all calls to finish. Their writes to memory
+ * are visible to the caller when this returns. The boot CPU always takes
+ * index 0, and if no other CPUs are available it is the only caller.
+ *
+ * Jobs run without a console and must not call printf(), malloc(), driver
+ * model or smp_run_on_cpus(). They may only use memory they are given.
+ *
+ * A CPU which does not finish its call in time is not used again until
+ * smp_park_cpus() has been called. It may still be running @fn, so the
+ * caller must not free or reuse what @arg refers to in that case.
+ *
+ * @fn:		Job function to run
+ * @arg:	Argument to pass to @fn
+ * @return 0 if OK, -ETIMEDOUT if a CPU did not finish, other -ve on error,
+ *	in which case @fn may not have been called on any CPU
+ */
+int smp_run_on_cpus(smp_job_fn fn, void *arg);
+
+/**
+ * smp_park_cpus() - Return secondary CPUs to where they were at start-up
+ *
+ * This must be called before the OS is started, so that the OS can start
+ * the secondary CPUs itself. A later call to smp_run_on_cpus() starts them
+ * again.
+ */
+void smp_park_cpus(void);
+#else
+static inline int smp_run_on_cpus(smp_job_fn fn, void *arg)
+{
+	fn(arg, 0, 1);
+
+	return 0;
+}
+
+static inline void smp_park_cpus(void)
+{
+}
+#endif
+
+#endif
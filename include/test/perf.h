@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Performance tests
+ */
+
+#ifndef __TEST_PERF_H__
+#define __TEST_PERF_H__
+
+#include <test/test.h>
+
+/* Declare a new performance test */
+#define PERF_TEST(_name, _flags)	UNIT_TEST(_name, _flags, perf_test)
+
+/**
+ * perf_check() - Report a measurement and check it against its baseline
+ *
+ * This prints the time per operation. If the environment variable
+ * perf_<name> holds a baseline, in nanoseconds per operation, the time must
+ * not be more than CONFIG_UT_PERF_MARGIN percent above it. If perf_record is
+ * set, the time is stored in perf_<name> as the new baseline instead.
+ *
+ * @name:	Name of the measurement
+ * @us:		Time taken, in microseconds
+ * @count:	Number of operations done in that time
+ * @return 0 if OK, -ETIME if slower than the baseline allows, other -ve
+ *	value if the baseline could not be recorded
+ */
+int perf_check(const char *name, ulong us, uint count);
+
+#endif /* __TEST_PERF_H__ */
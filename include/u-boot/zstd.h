@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Zstandard decompression
+ */
+
+#ifndef _UBOOT_ZSTD_H
+#define _UBOOT_ZSTD_H
+
+/**
+ * zstd_decompress() - Decompress Zstandard data
+ *
+ * This handles one or more concatenated frames, skipping any skippable
+ * frames. Content checksums are verified when present. Dictionaries are
+ * not supported.
+ *
+ * The source and destination must not overlap. Nothing is written to @dst
+ * beyond the decompressed data, so @dstn may be larger than needed.
+ *
+ * @src:	Compressed data
+ * @srcn:	Size of compressed data in bytes
+ * @dst:	Place to put the decompressed data
+ * @dstn:	On entry, size of the @dst buffer in bytes. On exit, the
+ *		number of bytes produced by frames which decoded successfully
+ * @return 0 if OK, -ENOBUFS if @dst is too small, -EPROTONOSUPPORT if a
+ *	dictionary is needed, -ENOMEM if out of memory, -EINVAL if the data
+ *	is corrupt
+ */
+int zstd_decompress(const void *src, size_t srcn, void *dst, size_t *dstn);
+
+#endif
@@ -10,6 +10,8 @@
 #include <efi_loader.h>
 #include <environment.h>
 #include <malloc.h>
+#include <serial.h>
+#include <smp.h>
 #include <linux/libfdt_env.h>
 #include <u-boot/crc.h>
 #include <bootm.h>
@@ -1891,6 +1893,10 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 	/* TODO: Should persist EFI variables here */
 
 	board_quiesce_devices();
+	serial_flush();
+
+	/* Give back the secondary CPUs used for jobs, for the OS to start */
+	smp_park_cpus();
 
 	/* Fix up caches for EFI payloads if necessary */
 	efi_exit_caches();
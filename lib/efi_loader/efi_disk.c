@@ -11,14 +11,17 @@
 #include <efi_loader.h>
 #include <part.h>
 #include <malloc.h>
+#include <memalign.h>
 
 const efi_guid_t efi_block_io_guid = BLOCK_IO_GUID;
+const efi_guid_t efi_block_io2_guid = EFI_BLOCK_IO2_PROTOCOL_GUID;
 
 /**
  * struct efi_disk_obj - EFI disk object
  *
  * @header:	EFI object header
  * @ops:	EFI disk I/O protocol interface
+ * @ops2:	EFI disk I/O 2 protocol interface
  * @ifname:	interface name for block device
  * @dev_index:	device index of block device
  * @media:	block I/O media information
@@ -31,6 +34,7 @@ const efi_guid_t efi_block_io_guid = BLOCK_IO_GUID;
 struct efi_disk_obj {
 	struct efi_object header;
 	struct efi_block_io ops;
+	struct efi_block_io2 ops2;
 	const char *ifname;
 	int dev_index;
 	struct efi_block_io_media media;
@@ -41,6 +45,23 @@ struct efi_disk_obj {
 	struct blk_desc *desc;
 };
 
+/**
+ * struct efi_disk_readahead - blocks read ahead for small reads
+ *
+ * @desc:	block device, or NULL if nothing has been read ahead
+ * @start:	first block, counted from the start of the device
+ * @count:	number of blocks
+ * @buf:	blocks read, aligned for DMA
+ */
+struct efi_disk_readahead {
+	struct blk_desc *desc;
+	lbaint_t start;
+	lbaint_t count;
+	void *buf;
+};
+
+static struct efi_disk_readahead efi_disk_ra;
+
 static efi_status_t EFIAPI efi_disk_reset(struct efi_block_io *this,
 			char extended_verification)
 {
@@ -53,17 +74,68 @@ enum efi_disk_direction {
 	EFI_DISK_WRITE,
 };
 
-static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
-			u32 media_id, u64 lba, unsigned long buffer_size,
+void efi_disk_invalidate(struct blk_desc *desc)
+{
+	if (efi_disk_ra.desc == desc)
+		efi_disk_ra.desc = NULL;
+}
+
+/**
+ * efi_disk_read() - read blocks from a block device
+ *
+ * Reads of fewer blocks than fit in CONFIG_EFI_DISK_READAHEAD_SIZE are
+ * served from a buffer, which is filled from the device starting at the
+ * first block requested. So a series of small reads next to each other
+ * becomes a single transfer, into a buffer which suits DMA whatever the
+ * alignment of the caller's buffer. Larger reads go straight to the device.
+ *
+ * @desc:	block device
+ * @lba:	first block, counted from the start of the device
+ * @blocks:	number of blocks
+ * @buffer:	buffer to read into
+ * Return:	number of blocks read
+ */
+static ulong efi_disk_read(struct blk_desc *desc, lbaint_t lba,
+			   lbaint_t blocks, void *buffer)
+{
+	struct efi_disk_readahead *ra = &efi_disk_ra;
+	lbaint_t max = CONFIG_EFI_DISK_READAHEAD_SIZE / desc->blksz;
+	ulong n;
+
+	if (!blocks || blocks >= max || lba >= desc->lba)
+		return blk_dread(desc, lba, blocks, buffer);
+
+	if (ra->desc != desc || lba < ra->start ||
+	    lba + blocks > ra->start + ra->count) {
+		if (!ra->buf) {
+			ra->buf = memalign(ARCH_DMA_MINALIGN,
+					   CONFIG_EFI_DISK_READAHEAD_SIZE);
+			if (!ra->buf)
+				return blk_dread(desc, lba, blocks, buffer);
+		}
+		ra->desc = NULL;
+		n = blk_dread(desc, lba, min(max, desc->lba - lba), ra->buf);
+		if (n < blocks)
+			return blk_dread(desc, lba, blocks, buffer);
+		ra->desc = desc;
+		ra->start = lba;
+		ra->count = n;
+	}
+	memcpy(buffer, ra->buf + (lba - ra->start) * desc->blksz,
+	       blocks * desc->blksz);
+
+	return blocks;
+}
+
+static efi_status_t efi_disk_rw_blocks(struct efi_disk_obj *diskobj,
+			u64 lba, unsigned long buffer_size,
 			void *buffer, enum efi_disk_direction direction)
 {
-	struct efi_disk_obj *diskobj;
 	struct blk_desc *desc;
 	int blksz;
 	int blocks;
 	unsigned long n;
 
-	diskobj = container_of(this, struct efi_disk_obj, ops);
 	desc = (struct blk_desc *) diskobj->desc;
 	blksz = desc->blksz;
 	blocks = buffer_size / blksz;
@@ -77,7 +149,7 @@ static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 		return EFI_DEVICE_ERROR;
 
 	if (direction == EFI_DISK_READ)
-		n = blk_dread(desc, lba, blocks, buffer);
+		n = efi_disk_read(desc, lba, blocks, buffer);
 	else
 		n = blk_dwrite(desc, lba, blocks, buffer);
 
@@ -92,74 +164,97 @@ static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 	return EFI_SUCCESS;
 }
 
-static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
-			u32 media_id, u64 lba, efi_uintn_t buffer_size,
-			void *buffer)
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+/*
+ * The bounce buffer is only needed if the device cannot reach the caller's
+ * buffer, i.e. if it is not entirely below 4 GiB
+ */
+static bool efi_disk_needs_bounce(void *buffer, efi_uintn_t buffer_size)
 {
-	void *real_buffer = buffer;
-	efi_status_t r;
+	return (u64)(uintptr_t)buffer + buffer_size > 0x100000000ULL;
+}
+#endif
 
+static efi_status_t efi_disk_do_read(struct efi_disk_obj *diskobj, u64 lba,
+				     efi_uintn_t buffer_size, void *buffer)
+{
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
-	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_read_blocks(this, media_id, lba,
-			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
+	if (efi_disk_needs_bounce(buffer, buffer_size)) {
+		efi_uintn_t size = min_t(efi_uintn_t, buffer_size,
+					 EFI_LOADER_BOUNCE_BUFFER_SIZE);
+		efi_status_t r;
+
+		r = efi_disk_rw_blocks(diskobj, lba, size, efi_bounce_buffer,
+				       EFI_DISK_READ);
 		if (r != EFI_SUCCESS)
 			return r;
-		return efi_disk_read_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
-			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
-			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
+		/* Copy from bounce buffer to real buffer */
+		memcpy(buffer, efi_bounce_buffer, size);
+		if (size == buffer_size)
+			return r;
+
+		return efi_disk_do_read(diskobj,
+					lba + size / diskobj->media.block_size,
+					buffer_size - size, buffer + size);
 	}
+#endif
+
+	return efi_disk_rw_blocks(diskobj, lba, buffer_size, buffer,
+				  EFI_DISK_READ);
+}
+
+static efi_status_t efi_disk_do_write(struct efi_disk_obj *diskobj, u64 lba,
+				      efi_uintn_t buffer_size, void *buffer)
+{
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	if (efi_disk_needs_bounce(buffer, buffer_size)) {
+		efi_uintn_t size = min_t(efi_uintn_t, buffer_size,
+					 EFI_LOADER_BOUNCE_BUFFER_SIZE);
+		efi_status_t r;
+
+		/* Populate bounce buffer */
+		memcpy(efi_bounce_buffer, buffer, size);
+		r = efi_disk_rw_blocks(diskobj, lba, size, efi_bounce_buffer,
+				       EFI_DISK_WRITE);
+		if (r != EFI_SUCCESS || size == buffer_size)
+			return r;
 
-	real_buffer = efi_bounce_buffer;
+		return efi_disk_do_write(diskobj,
+					 lba + size / diskobj->media.block_size,
+					 buffer_size - size, buffer + size);
+	}
 #endif
 
+	return efi_disk_rw_blocks(diskobj, lba, buffer_size, buffer,
+				  EFI_DISK_WRITE);
+}
+
+static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
+			u32 media_id, u64 lba, efi_uintn_t buffer_size,
+			void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+
 	EFI_ENTRY("%p, %x, %llx, %zx, %p", this, media_id, lba,
 		  buffer_size, buffer);
 
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
-			       EFI_DISK_READ);
-
-	/* Copy from bounce buffer to real buffer if necessary */
-	if ((r == EFI_SUCCESS) && (real_buffer != buffer))
-		memcpy(buffer, real_buffer, buffer_size);
+	diskobj = container_of(this, struct efi_disk_obj, ops);
 
-	return EFI_EXIT(r);
+	return EFI_EXIT(efi_disk_do_read(diskobj, lba, buffer_size, buffer));
 }
 
 static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 			u32 media_id, u64 lba, efi_uintn_t buffer_size,
 			void *buffer)
 {
-	void *real_buffer = buffer;
-	efi_status_t r;
-
-#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
-	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_write_blocks(this, media_id, lba,
-			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
-		if (r != EFI_SUCCESS)
-			return r;
-		return efi_disk_write_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
-			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
-			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
-	}
-
-	real_buffer = efi_bounce_buffer;
-#endif
+	struct efi_disk_obj *diskobj;
 
 	EFI_ENTRY("%p, %x, %llx, %zx, %p", this, media_id, lba,
 		  buffer_size, buffer);
 
-	/* Populate bounce buffer if necessary */
-	if (real_buffer != buffer)
-		memcpy(real_buffer, buffer, buffer_size);
-
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
-			       EFI_DISK_WRITE);
+	diskobj = container_of(this, struct efi_disk_obj, ops);
 
-	return EFI_EXIT(r);
+	return EFI_EXIT(efi_disk_do_write(diskobj, lba, buffer_size, buffer));
 }
 
 static efi_status_t EFIAPI efi_disk_flush_blocks(struct efi_block_io *this)
@@ -176,6 +271,85 @@ static const struct efi_block_io block_io_disk_template = {
 	.flush_blocks = &efi_disk_flush_blocks,
 };
 
+/**
+ * efi_disk_complete() - complete a block I/O 2 request
+ *
+ * Requests are carried out before the service returns. So a non-blocking
+ * request, i.e. one with a token and event, has finished already and its
+ * event is signaled straight away. Failures are returned directly.
+ *
+ * @token:	token passed by the caller, may be NULL
+ * @ret:	status of the request
+ * Return:	status code to return to the caller
+ */
+static efi_status_t efi_disk_complete(struct efi_block_io2_token *token,
+				      efi_status_t ret)
+{
+	if (ret != EFI_SUCCESS || !token || !token->event)
+		return ret;
+
+	token->transaction_status = EFI_SUCCESS;
+	efi_signal_event(token->event, true);
+
+	return EFI_SUCCESS;
+}
+
+static efi_status_t EFIAPI efi_disk_reset_ex(struct efi_block_io2 *this,
+			bool extended_verification)
+{
+	EFI_ENTRY("%p, %x", this, extended_verification);
+	return EFI_EXIT(EFI_DEVICE_ERROR);
+}
+
+static efi_status_t EFIAPI efi_disk_read_blocks_ex(struct efi_block_io2 *this,
+			u32 media_id, u64 lba,
+			struct efi_block_io2_token *token,
+			efi_uintn_t buffer_size, void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t r;
+
+	EFI_ENTRY("%p, %x, %llx, %p, %zx, %p", this, media_id, lba, token,
+		  buffer_size, buffer);
+
+	diskobj = container_of(this, struct efi_disk_obj, ops2);
+	r = efi_disk_do_read(diskobj, lba, buffer_size, buffer);
+
+	return EFI_EXIT(efi_disk_complete(token, r));
+}
+
+static efi_status_t EFIAPI efi_disk_write_blocks_ex(struct efi_block_io2 *this,
+			u32 media_id, u64 lba,
+			struct efi_block_io2_token *token,
+			efi_uintn_t buffer_size, void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t r;
+
+	EFI_ENTRY("%p, %x, %llx, %p, %zx, %p", this, media_id, lba, token,
+		  buffer_size, buffer);
+
+	diskobj = container_of(this, struct efi_disk_obj, ops2);
+	r = efi_disk_do_write(diskobj, lba, buffer_size, buffer);
+
+	return EFI_EXIT(efi_disk_complete(token, r));
+}
+
+static efi_status_t EFIAPI efi_disk_flush_blocks_ex(struct efi_block_io2 *this,
+			struct efi_block_io2_token *token)
+{
+	/* We always write synchronously */
+	EFI_ENTRY("%p, %p", this, token);
+	return EFI_EXIT(efi_disk_complete(token, EFI_SUCCESS));
+}
+
+static const struct efi_block_io2 block_io2_disk_template = {
+	.reset = &efi_disk_reset_ex,
+	.read_blocks_ex = &efi_disk_read_blocks_ex,
+	.write_blocks_ex = &efi_disk_write_blocks_ex,
+	.flush_blocks_ex = &efi_disk_flush_blocks_ex,
+};
+
 /*
  * Get the simple file system protocol for a file device path.
  *
@@ -266,6 +440,10 @@ static efi_status_t efi_disk_add_dev(
 			       &diskobj->ops);
 	if (ret != EFI_SUCCESS)
 		return ret;
+	ret = efi_add_protocol(&diskobj->header, &efi_block_io2_guid,
+			       &diskobj->ops2);
+	if (ret != EFI_SUCCESS)
+		return ret;
 	ret = efi_add_protocol(&diskobj->header, &efi_guid_device_path,
 			       diskobj->dp);
 	if (ret != EFI_SUCCESS)
@@ -280,6 +458,7 @@ static efi_status_t efi_disk_add_dev(
 			return ret;
 	}
 	diskobj->ops = block_io_disk_template;
+	diskobj->ops2 = block_io2_disk_template;
 	diskobj->ifname = if_typename;
 	diskobj->dev_index = dev_index;
 	diskobj->offset = offset;
@@ -289,11 +468,13 @@ static efi_status_t efi_disk_add_dev(
 	diskobj->media.removable_media = desc->removable;
 	diskobj->media.media_present = 1;
 	diskobj->media.block_size = desc->blksz;
-	diskobj->media.io_align = desc->blksz;
+	/* Buffers with this alignment can be used for DMA directly */
+	diskobj->media.io_align = ARCH_DMA_MINALIGN;
 	diskobj->media.last_block = desc->lba - offset;
 	if (part != 0)
 		diskobj->media.logical_partition = 1;
 	diskobj->ops.media = &diskobj->media;
+	diskobj->ops2.media = &diskobj->media;
 	if (disk)
 		*disk = diskobj;
 	return EFI_SUCCESS;
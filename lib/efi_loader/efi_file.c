@@ -29,6 +29,9 @@ struct file_handle {
 	loff_t offset;       /* current file position/cursor */
 	int isdir;
 
+	/* for reading a file, opened on the first read: */
+	struct fs_file *file;
+
 	/* for reading a directory: */
 	struct fs_dir_stream *dirs;
 	struct fs_dirent *dent;
@@ -263,6 +266,7 @@ out:
 
 static efi_status_t file_close(struct file_handle *fh)
 {
+	fs_close_file(fh->file);
 	fs_closedir(fh->dirs);
 	free(fh);
 	return EFI_SUCCESS;
@@ -298,10 +302,20 @@ error:
 static efi_status_t file_read(struct file_handle *fh, u64 *buffer_size,
 		void *buffer)
 {
-	loff_t actread;
+	loff_t actread, size;
+
+	/* A length of 0 would read the whole file */
+	if (!*buffer_size)
+		return EFI_SUCCESS;
+
+	/*
+	 * Keep the file open, so that the filesystem is not probed and the
+	 * path not looked up again for each read
+	 */
+	if (!fh->file && fs_open(fh->path, &fh->file, &size))
+		return EFI_DEVICE_ERROR;
 
-	if (fs_read(fh->path, map_to_sysmem(buffer), fh->offset,
-		    *buffer_size, &actread))
+	if (fs_pread(fh->file, buffer, fh->offset, *buffer_size, &actread))
 		return EFI_DEVICE_ERROR;
 
 	*buffer_size = actread;
@@ -10,199 +10,255 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <watchdog.h>
-#include <linux/list_sort.h>
+#include <linux/list.h>
+#include <linux/rbtree.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
 efi_uintn_t efi_memory_map_key;
 
-struct efi_mem_list {
-	struct list_head link;
+/*
+ * The memory map is a red-black tree of regions which do not overlap, sorted
+ * by start address. Adjacent regions of the same type and attributes are
+ * merged, so adding or removing a range only touches the regions it
+ * overlaps and their immediate neighbours.
+ */
+struct efi_mem_region {
+	struct rb_node node;
 	struct efi_mem_desc desc;
 };
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
-
-/* This list contains all memory map items */
-LIST_HEAD(efi_mem);
+static struct rb_root efi_mem = RB_ROOT;
+static uint efi_mem_count;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
 #endif
 
 /*
- * U-Boot services each EFI AllocatePool request as a separate
- * (multiple) page allocation.  We have to track the number of pages
- * to be able to free the correct amount later.
- * EFI requires 8 byte alignment for pool allocations, so we can
- * prepend each allocation with an 64 bit header tracking the
- * allocation size, and hand out the remainder to the caller.
+ * Each pool allocation is prepended with a header, so that we know how
+ * to free it later. EFI requires 8 byte alignment for pool allocations;
+ * we use ARCH_DMA_MINALIGN so that buffers can be used for DMA.
+ *
+ * Allocations which fit in EFI_POOL_MAX_CHUNK bytes, including the header,
+ * are carved from pages holding chunks of a single size and memory type
+ * (see struct efi_pool_page) and have @num_pages set to 0. Larger ones are
+ * a separate (multiple) page allocation, with the header at the start of
+ * the first page.
  */
 struct efi_pool_allocation {
 	u64 num_pages;
 	char data[] __aligned(ARCH_DMA_MINALIGN);
 };
 
-/*
- * Sorts the memory list from highest address to lowest address
+#define EFI_POOL_CLASSES	4
+#define EFI_POOL_MIN_CHUNK	128
+#define EFI_POOL_MAX_CHUNK	(EFI_POOL_MIN_CHUNK << (EFI_POOL_CLASSES - 1))
+#define EFI_POOL_CHUNK(cls)	(EFI_POOL_MIN_CHUNK << (cls))
+
+/**
+ * struct efi_pool_page - header of a page holding small pool allocations
+ *
+ * The chunks follow the header, at EFI_POOL_PAGE_HDR bytes from the start
+ * of the page. The data of each free chunk points to the next free one.
  *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
+ * @link:	link in efi_pool_partial[] for @cls, unless the page is full
+ * @free:	first free chunk, or NULL if the page is full
+ * @type:	memory type of the page
+ * @cls:	size class of the chunks
+ * @inuse:	number of chunks allocated
  */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
-{
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
+struct efi_pool_page {
+	struct list_head link;
+	struct efi_pool_allocation *free;
+	int type;
+	u16 cls;
+	u16 inuse;
+};
 
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
-}
+#define EFI_POOL_PAGE_HDR	ALIGN(sizeof(struct efi_pool_page), \
+				      ARCH_DMA_MINALIGN)
+
+/*
+ * Pages with free chunks, for each size class. These are set up here rather
+ * than in efi_memory_init() so that they are valid before it is called.
+ * Keep one entry per class.
+ */
+static struct list_head efi_pool_partial[EFI_POOL_CLASSES] = {
+	LIST_HEAD_INIT(efi_pool_partial[0]),
+	LIST_HEAD_INIT(efi_pool_partial[1]),
+	LIST_HEAD_INIT(efi_pool_partial[2]),
+	LIST_HEAD_INIT(efi_pool_partial[3]),
+};
 
 static uint64_t desc_get_end(struct efi_mem_desc *desc)
 {
 	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
 }
 
-static void efi_mem_sort(void)
+static struct efi_mem_region *efi_mem_entry(struct rb_node *node)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			struct efi_mem_desc *prev = &prevmem->desc;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
-
-			cur = &lmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
-
-			prevmem = lmem;
-		}
-	}
+	return rb_entry_safe(node, struct efi_mem_region, node);
 }
 
-/** efi_mem_carve_out - unmap memory region
+/**
+ * efi_mem_lookup() - find the first region which ends above an address
  *
- * @map:		memory map
- * @carve_desc:		memory region to unmap
- * @overlap_only_ram:	the carved out region may only overlap RAM
- * Return Value:	the number of overlapping pages which have been
- *			removed from the map,
- *			EFI_CARVE_NO_OVERLAP, if the regions don't overlap,
- *			EFI_CARVE_OVERLAPS_NONRAM, if the carve and map overlap,
- *			and the map contains anything but free ram
- *			(only when overlap_only_ram is true),
- *			EFI_CARVE_LOOP_AGAIN, if the mapping list should be
- *			traversed again, as it has been altered.
+ * As regions do not overlap, their end addresses are sorted like their start
+ * addresses, so a single descent of the tree is enough.
  *
- * Unmaps all memory occupied by the carve_desc region from the list entry
- * pointed to by map.
- *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to re-add the already carved out pages to the mapping.
+ * @addr:	address to look up
+ * Return:	the region containing @addr, else the first region above it,
+ *		or NULL if there is none
  */
-static s64 efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_only_ram)
+static struct efi_mem_region *efi_mem_lookup(u64 addr)
 {
-	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_only_ram && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
-			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
+	struct rb_node *node = efi_mem.rb_node;
+	struct efi_mem_region *found = NULL;
+
+	while (node) {
+		struct efi_mem_region *mem = efi_mem_entry(node);
+
+		if (addr < desc_get_end(&mem->desc)) {
+			found = mem;
+			node = node->rb_left;
 		} else {
-			map->desc.physical_start = carve_end;
-			map->desc.num_pages = (map_end - carve_end)
-					      >> EFI_PAGE_SHIFT;
+			node = node->rb_right;
 		}
+	}
+
+	return found;
+}
 
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
+static void efi_mem_insert(struct efi_mem_region *new)
+{
+	struct rb_node **link = &efi_mem.rb_node;
+	struct rb_node *parent = NULL;
+	u64 start = new->desc.physical_start;
+
+	while (*link) {
+		parent = *link;
+		if (start < efi_mem_entry(parent)->desc.physical_start)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
 	}
+	rb_link_node(&new->node, parent, link);
+	rb_insert_color(&new->node, &efi_mem);
+	efi_mem_count++;
+}
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
+static void efi_mem_remove(struct efi_mem_region *mem)
+{
+	rb_erase(&mem->node, &efi_mem);
+	efi_mem_count--;
+	free(mem);
+}
 
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
-	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
+static bool efi_mem_can_merge(struct efi_mem_desc *low,
+			      struct efi_mem_desc *high)
+{
+	return desc_get_end(low) == high->physical_start &&
+	       low->type == high->type && low->attribute == high->attribute;
+}
 
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
+/* Merge a region with its neighbours, if they are of the same kind */
+static void efi_mem_merge(struct efi_mem_region *mem)
+{
+	struct efi_mem_region *prev = efi_mem_entry(rb_prev(&mem->node));
+	struct efi_mem_region *next = efi_mem_entry(rb_next(&mem->node));
 
-	return EFI_CARVE_LOOP_AGAIN;
+	if (next && efi_mem_can_merge(&mem->desc, &next->desc)) {
+		mem->desc.num_pages += next->desc.num_pages;
+		efi_mem_remove(next);
+	}
+	if (prev && efi_mem_can_merge(&prev->desc, &mem->desc)) {
+		prev->desc.num_pages += mem->desc.num_pages;
+		efi_mem_remove(mem);
+	}
+}
+
+/**
+ * efi_mem_only_ram() - check that a range is all free RAM
+ *
+ * @start:	start address of the range
+ * @end:	end address of the range
+ * Return:	true if every page in the range is in the map as
+ *		EFI_CONVENTIONAL_MEMORY
+ */
+static bool efi_mem_only_ram(u64 start, u64 end)
+{
+	struct efi_mem_region *mem = efi_mem_lookup(start);
+
+	for (; start < end; mem = efi_mem_entry(rb_next(&mem->node))) {
+		if (!mem || mem->desc.physical_start > start ||
+		    mem->desc.type != EFI_CONVENTIONAL_MEMORY)
+			return false;
+		start = desc_get_end(&mem->desc);
+	}
+
+	return true;
+}
+
+/**
+ * efi_mem_carve_out() - remove a range from the memory map
+ *
+ * Regions which overlap the range are shrunk or removed. A region which
+ * covers the whole range is split in two; as it is then the only overlapping
+ * region, a failure to split leaves the map unchanged.
+ *
+ * @start:	start address of the range
+ * @end:	end address of the range
+ * Return:	0 if OK, -ENOMEM if a region could not be split
+ */
+static int efi_mem_carve_out(u64 start, u64 end)
+{
+	struct efi_mem_region *mem = efi_mem_lookup(start);
+
+	while (mem && mem->desc.physical_start < end) {
+		struct efi_mem_desc *desc = &mem->desc;
+		u64 map_start = desc->physical_start;
+		u64 map_end = desc_get_end(desc);
+		struct efi_mem_region *next;
+
+		next = efi_mem_entry(rb_next(&mem->node));
+
+		if (map_start < start && map_end > end) {
+			/* [ map_start .. start ] carve [ end .. map_end ] */
+			struct efi_mem_region *new;
+
+			new = calloc(1, sizeof(*new));
+			if (!new)
+				return -ENOMEM;
+			new->desc = *desc;
+			new->desc.physical_start = end;
+			new->desc.virtual_start = end;
+			new->desc.num_pages = (map_end - end) >> EFI_PAGE_SHIFT;
+			efi_mem_insert(new);
+			desc->num_pages = (start - map_start) >> EFI_PAGE_SHIFT;
+			break;
+		} else if (map_start < start) {
+			desc->num_pages = (start - map_start) >> EFI_PAGE_SHIFT;
+		} else if (map_end > end) {
+			/* Moving the start up to @end keeps the tree sorted */
+			desc->physical_start = end;
+			desc->virtual_start = end;
+			desc->num_pages = (map_end - end) >> EFI_PAGE_SHIFT;
+		} else {
+			efi_mem_remove(mem);
+		}
+		mem = next;
+	}
+
+	return 0;
 }
 
 uint64_t efi_add_memory_map(uint64_t start, uint64_t pages, int memory_type,
 			    bool overlap_only_ram)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *newlist;
-	bool carve_again;
-	uint64_t carved_pages = 0;
+	struct efi_mem_region *new;
+	uint64_t end = start + (pages << EFI_PAGE_SHIFT);
 
 	debug("%s: 0x%llx 0x%llx %d %s\n", __func__,
 	      start, pages, memory_type, overlap_only_ram ? "yes" : "no");
@@ -213,87 +269,49 @@ uint64_t efi_add_memory_map(uint64_t start, uint64_t pages, int memory_type,
 	if (!pages)
 		return start;
 
-	++efi_memory_map_key;
-	newlist = calloc(1, sizeof(*newlist));
-	newlist->desc.type = memory_type;
-	newlist->desc.physical_start = start;
-	newlist->desc.virtual_start = start;
-	newlist->desc.num_pages = pages;
+	/*
+	 * The payload wanted to have RAM overlaps only, but we overlapped
+	 * with an allocated or unmapped region. Error out.
+	 */
+	if (overlap_only_ram && !efi_mem_only_ram(start, end))
+		return 0;
+
+	new = calloc(1, sizeof(*new));
+	if (!new)
+		return 0;
+	new->desc.type = memory_type;
+	new->desc.physical_start = start;
+	new->desc.virtual_start = start;
+	new->desc.num_pages = pages;
 
 	switch (memory_type) {
 	case EFI_RUNTIME_SERVICES_CODE:
 	case EFI_RUNTIME_SERVICES_DATA:
-		newlist->desc.attribute = EFI_MEMORY_WB | EFI_MEMORY_RUNTIME;
+		new->desc.attribute = EFI_MEMORY_WB | EFI_MEMORY_RUNTIME;
 		break;
 	case EFI_MMAP_IO:
-		newlist->desc.attribute = EFI_MEMORY_RUNTIME;
+		new->desc.attribute = EFI_MEMORY_RUNTIME;
 		break;
 	default:
-		newlist->desc.attribute = EFI_MEMORY_WB;
+		new->desc.attribute = EFI_MEMORY_WB;
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			s64 r;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_only_ram);
-			switch (r) {
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				return 0;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
-			}
-		}
-	} while (carve_again);
-
-	if (overlap_only_ram && (carved_pages != pages)) {
-		/*
-		 * The payload wanted to have RAM overlaps, but we overlapped
-		 * with an unallocated region. Error out.
-		 */
+	if (efi_mem_carve_out(start, end)) {
+		free(new);
 		return 0;
 	}
-
-	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	efi_mem_insert(new);
+	efi_mem_merge(new);
+	++efi_memory_map_key;
 
 	return start;
 }
 
 static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 {
-	struct list_head *lhandle;
+	struct efi_mem_region *mem;
+	struct rb_node *node;
 
 	/*
 	 * Prealign input max address, so we simplify our matching
@@ -301,33 +319,26 @@ static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 	 */
 	max_addr &= ~EFI_PAGE_MASK;
 
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem = list_entry(lhandle,
-			struct efi_mem_list, link);
-		struct efi_mem_desc *desc = &lmem->desc;
-		uint64_t desc_len = desc->num_pages << EFI_PAGE_SHIFT;
-		uint64_t desc_end = desc->physical_start + desc_len;
-		uint64_t curmax = min(max_addr, desc_end);
-		uint64_t ret = curmax - len;
+	/* Start with the highest region which begins below max_addr */
+	mem = efi_mem_lookup(max_addr);
+	if (!mem)
+		node = rb_last(&efi_mem);
+	else if (mem->desc.physical_start >= max_addr)
+		node = rb_prev(&mem->node);
+	else
+		node = &mem->node;
+
+	for (; node; node = rb_prev(node)) {
+		struct efi_mem_desc *desc = &efi_mem_entry(node)->desc;
+		uint64_t curmax = min(max_addr, desc_get_end(desc));
 
 		/* We only take memory from free RAM */
 		if (desc->type != EFI_CONVENTIONAL_MEMORY)
 			continue;
 
-		/* Out of bounds for max_addr */
-		if ((ret + len) > max_addr)
-			continue;
-
-		/* Out of bounds for upper map limit */
-		if ((ret + len) > desc_end)
-			continue;
-
-		/* Out of bounds for lower map limit */
-		if (ret < desc->physical_start)
-			continue;
-
 		/* Return the highest address in this map within bounds */
-		return ret;
+		if (curmax - desc->physical_start >= len)
+			return curmax - len;
 	}
 
 	return 0;
@@ -421,7 +432,6 @@ efi_status_t efi_free_pages(uint64_t memory, efi_uintn_t pages)
 	uint64_t r = 0;
 
 	r = efi_add_memory_map(memory, pages, EFI_CONVENTIONAL_MEMORY, false);
-	/* Merging of adjacent free regions is missing */
 
 	if (r == memory)
 		return EFI_SUCCESS;
@@ -429,6 +439,99 @@ efi_status_t efi_free_pages(uint64_t memory, efi_uintn_t pages)
 	return EFI_NOT_FOUND;
 }
 
+/* Return the size class for a pool allocation, or -1 if it is too large */
+static int efi_pool_class(efi_uintn_t size)
+{
+	int cls;
+
+	for (cls = 0; cls < EFI_POOL_CLASSES; cls++) {
+		if (size <= EFI_POOL_CHUNK(cls) -
+			    sizeof(struct efi_pool_allocation))
+			return cls;
+	}
+
+	return -1;
+}
+
+/**
+ * efi_pool_get_page() - get a page with a free chunk
+ *
+ * @pool_type:	memory type of the page
+ * @cls:	size class of the chunks
+ * Return:	page, or NULL if a new page was needed but none is free
+ */
+static struct efi_pool_page *efi_pool_get_page(int pool_type, int cls)
+{
+	struct efi_pool_allocation *alloc;
+	struct efi_pool_page *page;
+	ulong chunk = EFI_POOL_CHUNK(cls);
+	u64 addr;
+	int i;
+
+	list_for_each_entry(page, &efi_pool_partial[cls], link) {
+		if (page->type == pool_type)
+			return page;
+	}
+
+	if (efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES, pool_type, 1,
+			       &addr) != EFI_SUCCESS)
+		return NULL;
+	page = (struct efi_pool_page *)(uintptr_t)addr;
+	page->free = NULL;
+	page->type = pool_type;
+	page->cls = cls;
+	page->inuse = 0;
+
+	/* Chain the chunks so that they are handed out in address order */
+	for (i = (EFI_PAGE_SIZE - EFI_POOL_PAGE_HDR) / chunk; i-- > 0;) {
+		alloc = (void *)page + EFI_POOL_PAGE_HDR + i * chunk;
+		alloc->num_pages = 0;
+		*(struct efi_pool_allocation **)alloc->data = page->free;
+		page->free = alloc;
+	}
+	list_add(&page->link, &efi_pool_partial[cls]);
+
+	return page;
+}
+
+static efi_status_t efi_pool_alloc(int pool_type, int cls, void **buffer)
+{
+	struct efi_pool_allocation *alloc;
+	struct efi_pool_page *page;
+
+	page = efi_pool_get_page(pool_type, cls);
+	if (!page)
+		return EFI_OUT_OF_RESOURCES;
+
+	alloc = page->free;
+	page->free = *(struct efi_pool_allocation **)alloc->data;
+	page->inuse++;
+	if (!page->free)
+		list_del_init(&page->link);
+	*buffer = alloc->data;
+
+	return EFI_SUCCESS;
+}
+
+static efi_status_t efi_pool_free(struct efi_pool_allocation *alloc)
+{
+	struct efi_pool_page *page;
+
+	page = (struct efi_pool_page *)((uintptr_t)alloc & ~EFI_PAGE_MASK);
+	/* A full page goes back on the partial list */
+	if (!page->free)
+		list_add(&page->link, &efi_pool_partial[page->cls]);
+	*(struct efi_pool_allocation **)alloc->data = page->free;
+	page->free = alloc;
+	if (--page->inuse)
+		return EFI_SUCCESS;
+
+	/* Give an empty page back, so that it does not clutter the map */
+	list_del(&page->link);
+
+	return efi_free_pages((uintptr_t)page, 1);
+}
+
 /*
  * Allocate memory from pool.
  *
@@ -441,8 +544,8 @@ efi_status_t efi_allocate_pool(int pool_type, efi_uintn_t size, void **buffer)
 {
 	efi_status_t r;
 	struct efi_pool_allocation *alloc;
-	u64 num_pages = efi_size_in_pages(size +
-					  sizeof(struct efi_pool_allocation));
+	u64 num_pages;
+	int cls;
 
 	if (!buffer)
 		return EFI_INVALID_PARAMETER;
@@ -452,6 +555,12 @@ efi_status_t efi_allocate_pool(int pool_type, efi_uintn_t size, void **buffer)
 		return EFI_SUCCESS;
 	}
 
+	cls = efi_pool_class(size);
+	if (cls >= 0)
+		return efi_pool_alloc(pool_type, cls, buffer);
+
+	num_pages = efi_size_in_pages(size +
+				      sizeof(struct efi_pool_allocation));
 	r = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES, pool_type, num_pages,
 			       (uint64_t *)&alloc);
 
@@ -478,6 +587,9 @@ efi_status_t efi_free_pool(void *buffer)
 		return EFI_INVALID_PARAMETER;
 
 	alloc = container_of(buffer, struct efi_pool_allocation, data);
+	if (!alloc->num_pages)
+		return efi_pool_free(alloc);
+
 	/* Sanity check, was the supplied address returned by allocate_pool */
 	assert(((uintptr_t)alloc & EFI_PAGE_MASK) == 0);
 
@@ -504,8 +616,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 				uint32_t *descriptor_version)
 {
 	efi_uintn_t map_size = 0;
-	int map_entries = 0;
-	struct list_head *lhandle;
+	struct rb_node *node;
 	efi_uintn_t provided_map_size;
 
 	if (!memory_map_size)
@@ -513,10 +624,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 
 	provided_map_size = *memory_map_size;
 
-	list_for_each(lhandle, &efi_mem)
-		map_entries++;
-
-	map_size = map_entries * sizeof(struct efi_mem_desc);
+	map_size = efi_mem_count * sizeof(struct efi_mem_desc);
 
 	*memory_map_size = map_size;
 
@@ -532,16 +640,9 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 	if (descriptor_version)
 		*descriptor_version = EFI_MEMORY_DESCRIPTOR_VERSION;
 
-	/* Copy list into array */
-	/* Return the list in ascending order */
-	memory_map = &memory_map[map_entries - 1];
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem;
-
-		lmem = list_entry(lhandle, struct efi_mem_list, link);
-		*memory_map = lmem->desc;
-		memory_map--;
-	}
+	/* Copy the tree into the array, in ascending order */
+	for (node = rb_first(&efi_mem); node; node = rb_next(node))
+		*memory_map++ = efi_mem_entry(node)->desc;
 
 	if (map_key)
 		*map_key = efi_memory_map_key;
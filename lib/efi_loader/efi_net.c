@@ -11,11 +11,33 @@
 
 static const efi_guid_t efi_net_guid = EFI_SIMPLE_NETWORK_GUID;
 static const efi_guid_t efi_pxe_guid = EFI_PXE_GUID;
+/* Number of received packets which can be queued for the application */
+#define EFI_NET_RX_PACKETS	64
+/* Most packets which eth_rx() may pass on in one call */
+#define EFI_NET_RX_BATCH	32
+/* Number of transmitted buffers which can wait to be recycled */
+#define EFI_NET_TX_PACKETS	32
+
 static struct efi_pxe_packet *dhcp_ack;
-static bool new_rx_packet;
-static void *new_tx_packet;
 static void *transmit_buffer;
 
+/*
+ * Received packets wait in a ring until the application calls Receive(),
+ * so that a burst of packets between two calls is not lost.
+ */
+static uchar *receive_buffer;
+static size_t receive_lengths[EFI_NET_RX_PACKETS];
+static int rx_packet_idx;
+static int rx_packet_num;
+
+/*
+ * Packets are sent synchronously, so a transmit buffer can be recycled as
+ * soon as Transmit() returns. GetStatus() hands them back in order.
+ */
+static void *transmitted[EFI_NET_TX_PACKETS];
+static int tx_packet_idx;
+static int tx_packet_num;
+
 /*
  * The notification function of this event is called in every timer cycle
  * to check if a new network packet has been received.
@@ -129,6 +151,10 @@ static efi_status_t EFIAPI efi_net_initialize(struct efi_simple_network *this,
 		goto out;
 	}
 
+	/* Drop packets queued before */
+	rx_packet_num = 0;
+	tx_packet_num = 0;
+
 	/* Setup packet buffers */
 	net_init();
 	/* Disable hardware and put it into the reset state */
@@ -351,13 +377,18 @@ static efi_status_t EFIAPI efi_net_get_status(struct efi_simple_network *this,
 	if (int_status) {
 		/* We send packets synchronously, so nothing is outstanding */
 		*int_status = EFI_SIMPLE_NETWORK_TRANSMIT_INTERRUPT;
-		if (new_rx_packet)
+		if (rx_packet_num)
 			*int_status |= EFI_SIMPLE_NETWORK_RECEIVE_INTERRUPT;
 	}
-	if (txbuf)
-		*txbuf = new_tx_packet;
-
-	new_tx_packet = NULL;
+	if (txbuf) {
+		if (tx_packet_num) {
+			*txbuf = transmitted[tx_packet_idx++];
+			tx_packet_idx %= EFI_NET_TX_PACKETS;
+			tx_packet_num--;
+		} else {
+			*txbuf = NULL;
+		}
+	}
 out:
 	return EFI_EXIT(ret);
 }
@@ -427,7 +458,14 @@ static efi_status_t EFIAPI efi_net_transmit
 	memcpy(transmit_buffer, buffer, buffer_size);
 	net_send_packet(transmit_buffer, buffer_size);
 
-	new_tx_packet = buffer;
+	/* If the application does not recycle its buffers, forget the oldest */
+	if (tx_packet_num == EFI_NET_TX_PACKETS) {
+		tx_packet_idx = (tx_packet_idx + 1) % EFI_NET_TX_PACKETS;
+		tx_packet_num--;
+	}
+	transmitted[(tx_packet_idx + tx_packet_num) % EFI_NET_TX_PACKETS] =
+		buffer;
+	tx_packet_num++;
 
 out:
 	return EFI_EXIT(ret);
@@ -457,6 +495,8 @@ static efi_status_t EFIAPI efi_net_receive
 	efi_status_t ret = EFI_SUCCESS;
 	struct ethernet_hdr *eth_hdr;
 	size_t hdr_size = sizeof(struct ethernet_hdr);
+	uchar *packet;
+	size_t len;
 	u16 protlen;
 
 	EFI_ENTRY("%p, %p, %p, %p, %p, %p, %p", this, header_size,
@@ -482,22 +522,18 @@ static efi_status_t EFIAPI efi_net_receive
 		break;
 	}
 
-	if (!new_rx_packet) {
-		ret = EFI_NOT_READY;
-		goto out;
-	}
-	/* Check that we at least received an Ethernet header */
-	if (net_rx_packet_len < sizeof(struct ethernet_hdr)) {
-		new_rx_packet = false;
+	if (!rx_packet_num) {
 		ret = EFI_NOT_READY;
 		goto out;
 	}
+	packet = receive_buffer + rx_packet_idx * PKTSIZE_ALIGN;
+	len = receive_lengths[rx_packet_idx];
 	/* Fill export parameters */
-	eth_hdr = (struct ethernet_hdr *)net_rx_packet;
+	eth_hdr = (struct ethernet_hdr *)packet;
 	protlen = ntohs(eth_hdr->et_protlen);
 	if (protlen == 0x8100) {
 		hdr_size += 4;
-		protlen = ntohs(*(u16 *)&net_rx_packet[hdr_size - 2]);
+		protlen = ntohs(*(u16 *)&packet[hdr_size - 2]);
 	}
 	if (header_size)
 		*header_size = hdr_size;
@@ -507,16 +543,20 @@ static efi_status_t EFIAPI efi_net_receive
 		memcpy(src_addr, eth_hdr->et_src, ARP_HLEN);
 	if (protocol)
 		*protocol = protlen;
-	if (*buffer_size < net_rx_packet_len) {
+	if (*buffer_size < len) {
 		/* Packet doesn't fit, try again with bigger buffer */
-		*buffer_size = net_rx_packet_len;
+		*buffer_size = len;
 		ret = EFI_BUFFER_TOO_SMALL;
 		goto out;
 	}
 	/* Copy packet */
-	memcpy(buffer, net_rx_packet, net_rx_packet_len);
-	*buffer_size = net_rx_packet_len;
-	new_rx_packet = false;
+	memcpy(buffer, packet, len);
+	*buffer_size = len;
+	rx_packet_idx = (rx_packet_idx + 1) % EFI_NET_RX_PACKETS;
+	rx_packet_num--;
+	/* WaitForPacket stays signaled while packets are queued */
+	if (rx_packet_num)
+		wait_for_packet->is_signaled = true;
 out:
 	return EFI_EXIT(ret);
 }
@@ -540,13 +580,25 @@ void efi_net_set_dhcp_ack(void *pkt, int len)
  * efi_net_push() - callback for received network packet
  *
  * This function is called when a network packet is received by eth_rx().
+ * The packet is queued for the application, unless the queue is full.
  *
  * @pkt:	network packet
  * @len:	length
  */
 static void efi_net_push(void *pkt, int len)
 {
-	new_rx_packet = true;
+	int next;
+
+	/* Check that we at least received an Ethernet header */
+	if (len < sizeof(struct ethernet_hdr) || len > PKTSIZE_ALIGN)
+		return;
+	if (rx_packet_num == EFI_NET_RX_PACKETS)
+		return;
+
+	next = (rx_packet_idx + rx_packet_num) % EFI_NET_RX_PACKETS;
+	memcpy(receive_buffer + next * PKTSIZE_ALIGN, pkt, len);
+	receive_lengths[next] = len;
+	rx_packet_num++;
 	wait_for_packet->is_signaled = true;
 }
 
@@ -572,11 +624,19 @@ static void EFIAPI efi_network_timer_notify(struct efi_event *event,
 	if (!this || this->mode->state != EFI_NETWORK_INITIALIZED)
 		goto out;
 
-	if (!new_rx_packet) {
-		push_packet = efi_net_push;
+	/*
+	 * Poll until the device has nothing more or the queue might not have
+	 * room for another batch, in which case packets stay with the device.
+	 */
+	push_packet = efi_net_push;
+	while (EFI_NET_RX_PACKETS - rx_packet_num >= EFI_NET_RX_BATCH) {
+		int num = rx_packet_num;
+
 		eth_rx();
-		push_packet = NULL;
+		if (rx_packet_num == num)
+			break;
 	}
+	push_packet = NULL;
 out:
 	EFI_EXIT(EFI_SUCCESS);
 }
@@ -607,6 +667,11 @@ efi_status_t efi_net_register(void)
 		goto out_of_resources;
 	transmit_buffer = (void *)ALIGN((uintptr_t)transmit_buffer, PKTALIGN);
 
+	/* Allocate the receive queue */
+	receive_buffer = malloc(EFI_NET_RX_PACKETS * PKTSIZE_ALIGN);
+	if (!receive_buffer)
+		goto out_of_resources;
+
 	/* Hook net up to the device list */
 	efi_add_handle(&netobj->header);
 
@@ -11,6 +11,8 @@
  * ConnectController is used to setup partitions and to install the simple
  * file protocol.
  * A known file is read from the file system and verified.
+ * The first block of the partition is read with the block I/O 2 protocol
+ * and compared to what the block I/O protocol reads into an unaligned buffer.
  */
 
 #include <efi_selftest.h>
@@ -25,6 +27,8 @@
 static struct efi_boot_services *boottime;
 
 static const efi_guid_t block_io_protocol_guid = BLOCK_IO_GUID;
+static const efi_guid_t block_io2_protocol_guid =
+					EFI_BLOCK_IO2_PROTOCOL_GUID;
 static const efi_guid_t guid_device_path = DEVICE_PATH_GUID;
 static const efi_guid_t guid_simple_file_system_protocol =
 					EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_GUID;
@@ -288,6 +292,86 @@ static efi_uintn_t dp_size(struct efi_device_path *dp)
 	return (char *)pos - (char *)dp;
 }
 
+/*
+ * Read the first block of a partition with both block I/O protocols.
+ *
+ * @handle	handle of the partition
+ * @return	EFI_ST_SUCCESS for success
+ */
+static int read_partition_blocks(efi_handle_t handle)
+{
+	struct efi_block_io *bio;
+	struct efi_block_io2 *bio2;
+	struct efi_block_io2_token token;
+	u8 block[1 << LB_BLOCK_SIZE] __aligned(ARCH_DMA_MINALIGN);
+	u8 unaligned[(1 << LB_BLOCK_SIZE) + 1];
+	efi_status_t ret;
+
+	ret = boottime->open_protocol(handle, &block_io_protocol_guid,
+				      (void **)&bio, NULL, NULL,
+				      EFI_OPEN_PROTOCOL_GET_PROTOCOL);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Failed to open block I/O protocol\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->open_protocol(handle, &block_io2_protocol_guid,
+				      (void **)&bio2, NULL, NULL,
+				      EFI_OPEN_PROTOCOL_GET_PROTOCOL);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Failed to open block I/O 2 protocol\n");
+		return EFI_ST_FAILURE;
+	}
+	if (bio2->media != bio->media) {
+		efi_st_error("Block I/O protocols differ in media\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->create_event(0, TPL_CALLBACK, NULL, NULL,
+				     &token.event);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Could not create event\n");
+		return EFI_ST_FAILURE;
+	}
+	token.transaction_status = EFI_NOT_READY;
+	ret = bio2->read_blocks_ex(bio2, bio2->media->media_id, 0, &token,
+				   sizeof(block), block);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("ReadBlocksEx failed\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->check_event(token.event);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("ReadBlocksEx did not signal its event\n");
+		return EFI_ST_FAILURE;
+	}
+	if (token.transaction_status != EFI_SUCCESS) {
+		efi_st_error("ReadBlocksEx transaction failed\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->close_event(token.event);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Could not close event\n");
+		return EFI_ST_FAILURE;
+	}
+	if (block[510] != 0x55 || block[511] != 0xaa) {
+		efi_st_error("No boot sector signature\n");
+		return EFI_ST_FAILURE;
+	}
+
+	/* The same block again, from the read-ahead buffer if enabled */
+	ret = bio->read_blocks(bio, bio->media->media_id, 0, sizeof(block),
+			       unaligned + 1);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("ReadBlocks failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (efi_st_memcmp(block, unaligned + 1, sizeof(block))) {
+		efi_st_error("Block I/O protocols read different data\n");
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
 /*
  * Execute unit test.
  *
@@ -352,6 +436,9 @@ static int execute(void)
 		return EFI_ST_FAILURE;
 	}
 
+	if (read_partition_blocks(handle_partition) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
 	/* Open the simple file system protocol */
 	ret = boottime->open_protocol(handle_partition,
 				      &guid_simple_file_system_protocol,
@@ -5,14 +5,16 @@
  * Copyright (c) 2018 Heinrich Schuchardt <xypron.glpk@gmx.de>
  *
  * This unit test checks the following runtime services:
- * AllocatePages, FreePages, GetMemoryMap
+ * AllocatePages, AllocatePool, FreePages, FreePool, GetMemoryMap
  *
- * The memory type used for the device tree is checked.
+ * The memory type used for the device tree and for small pool allocations
+ * is checked.
  */
 
 #include <efi_selftest.h>
 
 #define EFI_ST_NUM_PAGES 8
+#define EFI_ST_POOL_SIZE 40
 
 static const efi_guid_t fdt_guid = EFI_FDT_GUID;
 static struct efi_boot_services *boottime;
@@ -97,6 +99,7 @@ static int execute(void)
 {
 	u64 p1;
 	u64 p2;
+	void *p3;
 	efi_uintn_t map_size = 0;
 	efi_uintn_t map_key;
 	efi_uintn_t desc_size;
@@ -120,6 +123,18 @@ static int execute(void)
 		return EFI_ST_FAILURE;
 	}
 
+	/* Small pool allocations share pages of the requested type */
+	ret = boottime->allocate_pool(EFI_RUNTIME_SERVICES_DATA,
+				      EFI_ST_POOL_SIZE, &p3);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("AllocatePool did not return EFI_SUCCESS\n");
+		return EFI_ST_FAILURE;
+	}
+	if ((uintptr_t)p3 & 7) {
+		efi_st_error("AllocatePool returned unaligned buffer\n");
+		return EFI_ST_FAILURE;
+	}
+
 	/* Load memory map */
 	ret = boottime->get_memory_map(&map_size, NULL, &map_key, &desc_size,
 				       &desc_version);
@@ -150,6 +165,10 @@ static int execute(void)
 	if (find_in_memory_map(map_size, memory_map, desc_size, p2,
 			       EFI_RUNTIME_SERVICES_DATA) != EFI_ST_SUCCESS)
 		return EFI_ST_FAILURE;
+	if (find_in_memory_map(map_size, memory_map, desc_size,
+			       (uintptr_t)p3,
+			       EFI_RUNTIME_SERVICES_DATA) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
 
 	/* Free memory */
 	ret = boottime->free_pages(p1, EFI_ST_NUM_PAGES);
@@ -162,6 +181,11 @@ static int execute(void)
 		efi_st_error("FreePages did not return EFI_SUCCESS\n");
 		return EFI_ST_FAILURE;
 	}
+	ret = boottime->free_pool(p3);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("FreePool did not return EFI_SUCCESS\n");
+		return EFI_ST_FAILURE;
+	}
 	ret = boottime->free_pool(memory_map);
 	if (ret != EFI_SUCCESS) {
 		efi_st_error("FreePool did not return EFI_SUCCESS\n");
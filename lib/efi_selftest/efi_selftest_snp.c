@@ -101,6 +101,7 @@ static efi_status_t send_dhcp_discover(void)
 {
 	efi_status_t ret;
 	struct dhcp p = {};
+	void *txbuf;
 
 	/*
 	 * Fill Ethernet header
@@ -159,11 +160,26 @@ static efi_status_t send_dhcp_discover(void)
 	 * Transmit DHCPDISCOVER message.
 	 */
 	ret = net->transmit(net, 0, sizeof(struct dhcp), &p, NULL, NULL, 0);
-	if (ret != EFI_SUCCESS)
+	if (ret != EFI_SUCCESS) {
 		efi_st_error("Sending a DHCP request failed\n");
-	else
-		efi_st_printf("DHCP Discover\n");
-	return ret;
+		return ret;
+	}
+	efi_st_printf("DHCP Discover\n");
+
+	/*
+	 * The transmit buffer must be recycled exactly once.
+	 */
+	ret = net->get_status(net, NULL, &txbuf);
+	if (ret != EFI_SUCCESS || txbuf != &p) {
+		efi_st_error("Transmit buffer not recycled\n");
+		return EFI_DEVICE_ERROR;
+	}
+	ret = net->get_status(net, NULL, &txbuf);
+	if (ret != EFI_SUCCESS || txbuf) {
+		efi_st_error("Transmit buffer recycled twice\n");
+		return EFI_DEVICE_ERROR;
+	}
+	return EFI_SUCCESS;
 }
 
 /*
@@ -7,6 +7,7 @@
 #include <common.h>
 #include <boot_fit.h>
 #include <dm.h>
+#include <dm/bind-table.h>
 #include <dm/of_extra.h>
 #include <errno.h>
 #include <fdtdec.h>
@@ -17,6 +18,7 @@
 #include <asm/sections.h>
 #include <linux/ctype.h>
 #include <linux/lzo.h>
+#include <malloc.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -617,10 +619,108 @@ int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 	if (!phandle)
 		return -FDT_ERR_NOTFOUND;
 
-	lookup = fdt_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
+	lookup = fdtdec_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
 	return lookup;
 }
 
+#if CONFIG_IS_ENABLED(OF_INDEX)
+/*
+ * Largest phandle value we are prepared to index. dtc allocates phandles
+ * densely from 1, so anything above this uses the normal linear search.
+ */
+#define FDT_PHANDLE_CACHE_MAX	0x10000
+
+/* node offsets in fdt_phandle_cache_blob indexed by phandle, or -1 */
+static int *fdt_phandle_cache;
+static uint fdt_phandle_cache_size;
+static const void *fdt_phandle_cache_blob;
+
+static int fdtdec_build_phandle_cache(const void *blob)
+{
+	uint32_t phandle, max = 0;
+	int offset, i;
+
+	free(fdt_phandle_cache);
+	fdt_phandle_cache = NULL;
+	fdt_phandle_cache_size = 0;
+	fdt_phandle_cache_blob = blob;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle > max)
+			max = phandle;
+	}
+	if (!max || max >= FDT_PHANDLE_CACHE_MAX)
+		return 0;
+
+	fdt_phandle_cache = malloc((max + 1) * sizeof(*fdt_phandle_cache));
+	if (!fdt_phandle_cache)
+		return -ENOMEM;
+	for (i = 0; i <= max; i++)
+		fdt_phandle_cache[i] = -1;
+	fdt_phandle_cache_size = max + 1;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle && phandle != (uint32_t)-1)
+			fdt_phandle_cache[phandle] = offset;
+	}
+	debug("%s: indexed %u phandles\n", __func__, max);
+
+	return 0;
+}
+
+static int fdtdec_phandle_cache_lookup(const void *blob, uint32_t phandle)
+{
+	int offset;
+
+	/* The index needs malloc() so is only built after relocation */
+	if (blob != gd->fdt_blob || !(gd->flags & GD_FLG_RELOC) || !phandle)
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	if (fdt_phandle_cache_blob != blob)
+		fdtdec_build_phandle_cache(blob);
+	if (phandle >= fdt_phandle_cache_size)
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	offset = fdt_phandle_cache[phandle];
+	if (offset >= 0 && fdt_get_phandle(blob, offset) != phandle) {
+		/* The tree has been changed since we indexed it */
+		fdtdec_build_phandle_cache(blob);
+		if (phandle >= fdt_phandle_cache_size)
+			return fdt_node_offset_by_phandle(blob, phandle);
+		offset = fdt_phandle_cache[phandle];
+	}
+	if (offset < 0) {
+		/* The phandle may have been added since, e.g. by an overlay */
+		offset = fdt_node_offset_by_phandle(blob, phandle);
+		if (offset >= 0)
+			fdt_phandle_cache[phandle] = offset;
+	}
+
+	return offset;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(OF_INDEX) || CONFIG_IS_ENABLED(OF_BIND_TABLE)
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle)
+{
+	if (phandle && dm_bind_table_valid(blob)) {
+		int offset = dm_bind_table_phandle(phandle);
+
+		if (offset >= 0 && fdt_get_phandle(blob, offset) == phandle)
+			return offset;
+	}
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	return fdtdec_phandle_cache_lookup(blob, phandle);
+#else
+	return fdt_node_offset_by_phandle(blob, phandle);
+#endif
+}
+#endif
+
 /**
  * Look up a property in a node and check that it has a minimum length.
  *
@@ -748,8 +848,8 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 			 * below.
 			 */
 			if (cells_name || cur_index == index) {
-				node = fdt_node_offset_by_phandle(blob,
-								  phandle);
+				node = fdtdec_node_offset_by_phandle(blob,
+								     phandle);
 				if (!node) {
 					debug("%s: could not find phandle\n",
 					      fdt_get_name(blob, src_node,
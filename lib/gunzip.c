@@ -13,6 +13,7 @@
 #include <memalign.h>
 #include <u-boot/zlib.h>
 #include <div64.h>
+#include <asm/unaligned.h>
 
 #define HEADER0			'\x1f'
 #define HEADER1			'\x8b'
@@ -23,6 +24,8 @@
 #define COMMENT			0x10
 #define RESERVED		0xe0
 #define DEFLATED		8
+/* deflate cannot expand data by more than this factor */
+#define DEFLATE_MAX_RATIO	1032
 
 void *gzalloc(void *x, unsigned items, unsigned size)
 {
@@ -79,6 +82,40 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	return zunzip(dst, dstlen, src, lenp, 1, offset);
 }
 
+int gunzip_exact(void *dst, int dstlen, unsigned char *src,
+		 unsigned long *lenp)
+{
+	int offset = gzip_parse_header(src, *lenp);
+	unsigned long len, size;
+	int ret;
+
+	if (offset < 0)
+		return offset;
+	if (*lenp < offset + 8)
+		return gunzip(dst, dstlen, src, lenp);
+
+	/*
+	 * ISIZE, the uncompressed size modulo 2^32, ends the trailer. If the
+	 * stream is followed by padding (e.g. from dd) this is something else,
+	 * so use gunzip() if the size is not plausible.
+	 */
+	size = get_unaligned_le32(src + *lenp - 4);
+	if (!size || size > dstlen || size / DEFLATE_MAX_RATIO > *lenp)
+		return gunzip(dst, dstlen, src, lenp);
+
+	/* Exclude the CRC32 and ISIZE fields */
+	len = *lenp - 8;
+	ret = zunzip(dst, size, src, &len, 1, offset);
+	if (ret || len != size) {
+		debug("%s: size %lu does not match trailer %lu\n", __func__,
+		      len, size);
+		return gunzip(dst, dstlen, src, lenp);
+	}
+	*lenp = len;
+
+	return 0;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(u64 expectedsize)
@@ -9,6 +9,7 @@
 
 #include <common.h>
 #include <bootstage.h>
+#include <serial.h>
 
 /**
  * hang - stop processing by staying in an endless loop
@@ -25,6 +26,7 @@ void hang(void)
 		 CONFIG_IS_ENABLED(SERIAL_SUPPORT))
 	puts("### ERROR ### Please RESET the board ###\n");
 #endif
+	serial_flush();
 	bootstage_error(BOOTSTAGE_ID_NEED_RESET);
 	for (;;)
 		;
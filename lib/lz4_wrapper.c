@@ -5,6 +5,8 @@
 
 #include <common.h>
 #include <compiler.h>
+#include <malloc.h>
+#include <smp.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
 
@@ -62,35 +64,229 @@ struct lz4_block_header {
 	/* + u32 block_checksum iff has_block_checksum is set */
 } __packed;
 
+/* Check the frame header, returning its length or -ve on error */
+static int lz4_parse_header(const void *src, size_t srcn,
+			    int *has_block_checksum, size_t *block_max)
+{
+	const struct lz4_frame_header *h = src;
+	int len = sizeof(*h);
+
+	if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
+		return -EINVAL;	/* input overrun */
+
+	/* We assume there's always only a single, standard frame. */
+	if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if (h->reserved0 || h->reserved1 || h->reserved2)
+		return -EINVAL;	/* reserved must be zero */
+	if (!h->independent_blocks)
+		return -EPROTONOSUPPORT; /* we can't support this yet */
+	*has_block_checksum = h->has_block_checksum;
+	/* 4 = 64KiB, 5 = 256KiB, 6 = 1MiB, 7 = 4MiB; others are invalid */
+	*block_max = h->max_block_size >= 4 ?
+		1 << (8 + 2 * h->max_block_size) : 0;
+
+	if (h->has_content_size)
+		len += sizeof(u64);
+	len += sizeof(u8);
+
+	return len;
+}
+
+/* Decode one block to *@outp, advancing it past the bytes written */
+static int lz4_decode_block(const void *in, u32 size, bool not_compressed,
+			    void **outp, const void *end)
+{
+	void *out = *outp;
+	int ret;
+
+	if (not_compressed) {
+		size_t len = min((ptrdiff_t)size, end - out);
+
+		memcpy(out, in, len);
+		*outp = out + len;
+		if (len < size)
+			return -ENOBUFS;	/* output overrun */
+		return 0;
+	}
+
+	/* constant folding essential, do not touch params! */
+	ret = LZ4_decompress_generic(in, out, size, end - out, endOnInputSize,
+				     full, 0, noDict, out, NULL, 0);
+	if (ret < 0)
+		return -EPROTO;	/* decompression error */
+	*outp = out + ret;
+
+	return 0;
+}
+
+#if CONFIG_IS_ENABLED(LZ4_PARALLEL)
+/**
+ * struct lz4_block - Entry in the block index of a frame
+ *
+ * @src:	Block data
+ * @dst:	Where the block is decoded to
+ * @size:	Size of the block data in bytes
+ * @not_compressed: true if the block is stored uncompressed
+ * @ret:	Number of bytes decoded, or -ve on error
+ */
+struct lz4_block {
+	const void *src;
+	void *dst;
+	u32 size;
+	bool not_compressed;
+	int ret;
+};
+
+/**
+ * struct lz4_job - A set of independent blocks to decode
+ *
+ * @blocks:	Block index
+ * @count:	Number of blocks
+ * @end:	End of the output buffer
+ * @block_max:	Decoded size of each block except the last
+ */
+struct lz4_job {
+	struct lz4_block *blocks;
+	int count;
+	const void *end;
+	size_t block_max;
+};
+
+/* Decode every @ncpus'th block, starting at block @cpu */
+static void lz4_decode_job(void *arg, uint cpu, uint ncpus)
+{
+	struct lz4_job *job = arg;
+	int i;
+
+	for (i = cpu; i < job->count; i += ncpus) {
+		struct lz4_block *b = &job->blocks[i];
+		const void *end = min(job->end, (const void *)b->dst +
+				      job->block_max);
+		void *out = b->dst;
+
+		b->ret = lz4_decode_block(b->src, b->size, b->not_compressed,
+					  &out, end);
+		if (!b->ret)
+			b->ret = out - b->dst;
+	}
+}
+
+/**
+ * ulz4fn_parallel() - Decode a frame using a block index
+ *
+ * The frame is scanned first to find each block. Since all but the last
+ * block of a frame written by the lz4 tool decode to exactly the maximum
+ * block size, each block's output position is known up front and the blocks
+ * can be decoded in any order, on any CPU.
+ *
+ * @return 0 if OK, -EAGAIN if the frame is not suitable or any block failed
+ *	to decode, in which case the caller should fall back to serial
+ *	decoding to get a deterministic result
+ */
+static int ulz4fn_parallel(const void *src, size_t srcn, void *dst,
+			   size_t *dstn)
+{
+	const void *end = dst + *dstn;
+	const void *in = src;
+	struct lz4_job job;
+	int has_block_checksum;
+	size_t block_max;
+	int count, ret, i;
+
+	/* In-place decompression relies on decoding in order */
+	if (src < end && dst < src + srcn)
+		return -EAGAIN;
+
+	ret = lz4_parse_header(src, srcn, &has_block_checksum, &block_max);
+	if (ret < 0 || !block_max)
+		return -EAGAIN;
+	in += ret;
+
+	/* First pass: count the blocks and check the frame is complete */
+	for (count = 0; ; count++) {
+		struct lz4_block_header b;
+
+		if (in - src + sizeof(b) > srcn)
+			return -EAGAIN;
+		b.raw = le32_to_cpu(*(u32 *)in);
+		in += sizeof(b);
+		if (!b.size)
+			break;
+		in += b.size;
+		if (has_block_checksum)
+			in += sizeof(u32);
+		if (in - src > srcn)
+			return -EAGAIN;
+	}
+	if (count < 2 || (count - 1) * block_max >= *dstn)
+		return -EAGAIN;
+
+	job.blocks = calloc(count, sizeof(struct lz4_block));
+	if (!job.blocks)
+		return -EAGAIN;
+	job.count = count;
+	job.end = end;
+	job.block_max = block_max;
+
+	/* Second pass: fill in the index */
+	in = src + lz4_parse_header(src, srcn, &has_block_checksum,
+				    &block_max);
+	for (i = 0; i < count; i++) {
+		struct lz4_block *blk = &job.blocks[i];
+		struct lz4_block_header b;
+
+		b.raw = le32_to_cpu(*(u32 *)in);
+		in += sizeof(b);
+		blk->src = in;
+		blk->dst = dst + i * block_max;
+		blk->size = b.size;
+		blk->not_compressed = b.not_compressed;
+		in += b.size;
+		if (has_block_checksum)
+			in += sizeof(u32);
+	}
+
+	ret = smp_run_on_cpus(lz4_decode_job, &job);
+	/* A CPU which did not finish may still use the blocks and output */
+	if (ret == -ETIMEDOUT)
+		return ret;
+
+	/* Any short block means our output positions were wrong */
+	for (i = 0; !ret && i < count; i++) {
+		if (job.blocks[i].ret < 0 ||
+		    (i < count - 1 && job.blocks[i].ret != block_max))
+			ret = -EAGAIN;
+	}
+	if (!ret)
+		*dstn = (count - 1) * block_max + job.blocks[count - 1].ret;
+	free(job.blocks);
+
+	return ret ? -EAGAIN : 0;
+}
+#endif
+
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
 	const void *in = src;
 	void *out = dst;
 	int has_block_checksum;
+	size_t block_max;
 	int ret;
+
+#if CONFIG_IS_ENABLED(LZ4_PARALLEL)
+	ret = ulz4fn_parallel(src, srcn, dst, dstn);
+	if (ret != -EAGAIN)
+		return ret;
+#endif
 	*dstn = 0;
 
-	{ /* With in-place decompression the header may become invalid later. */
-		const struct lz4_frame_header *h = in;
-
-		if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
-			return -EINVAL;	/* input overrun */
-
-		/* We assume there's always only a single, standard frame. */
-		if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
-			return -EPROTONOSUPPORT;	/* unknown format */
-		if (h->reserved0 || h->reserved1 || h->reserved2)
-			return -EINVAL;	/* reserved must be zero */
-		if (!h->independent_blocks)
-			return -EPROTONOSUPPORT; /* we can't support this yet */
-		has_block_checksum = h->has_block_checksum;
-
-		in += sizeof(*h);
-		if (h->has_content_size)
-			in += sizeof(u64);
-		in += sizeof(u8);
-	}
+	/* With in-place decompression the header may become invalid later. */
+	ret = lz4_parse_header(in, srcn, &has_block_checksum, &block_max);
+	if (ret < 0)
+		return ret;
+	in += ret;
 
 	while (1) {
 		struct lz4_block_header b;
@@ -108,25 +304,9 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 			break;
 		}
 
-		if (b.not_compressed) {
-			size_t size = min((ptrdiff_t)b.size, end - out);
-			memcpy(out, in, size);
-			out += size;
-			if (size < b.size) {
-				ret = -ENOBUFS;	/* output overrun */
-				break;
-			}
-		} else {
-			/* constant folding essential, do not touch params! */
-			ret = LZ4_decompress_generic(in, out, b.size,
-					end - out, endOnInputSize,
-					full, 0, noDict, out, NULL, 0);
-			if (ret < 0) {
-				ret = -EPROTO;	/* decompression error */
-				break;
-			}
-			out += ret;
-		}
+		ret = lz4_decode_block(in, b.size, b.not_compressed, &out, end);
+		if (ret)
+			break;
 
 		in += b.size;
 		if (has_block_checksum)
@@ -329,6 +329,11 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp)
 		debug("Failed to scan live tree aliases: err=%d\n", ret);
 		return ret;
 	}
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	/* The index is only an accelerator, so carry on without it */
+	if (of_populate_phandle_cache())
+		debug("Failed to index live tree phandles\n");
+#endif
 	debug("%s: stop\n", __func__);
 
 	return ret;
@@ -10,6 +10,7 @@
  */
 
 #include <common.h>
+#include <serial.h>
 #if !defined(CONFIG_PANIC_HANG)
 #include <command.h>
 #endif
@@ -19,6 +20,8 @@ static void panic_finish(void) __attribute__ ((noreturn));
 static void panic_finish(void)
 {
 	putc('\n');
+	/* Do not leave the message in the TX buffer */
+	serial_flush();
 #if defined(CONFIG_PANIC_HANG)
 	hang();
 #else
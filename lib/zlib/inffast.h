@@ -8,4 +8,11 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/* Minimum input inflate() must have before calling inflate_fast() */
+#if BITS_PER_LONG == 64
+#define INFLATE_FAST_MIN_HAVE	8
+#else
+#define INFLATE_FAST_MIN_HAVE	6
+#endif
+
 void inflate_fast OF((z_streamp strm, unsigned start));
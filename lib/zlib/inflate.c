@@ -722,7 +722,7 @@ int ZEXPORT inflate(z_streamp strm, int flush)
             state->mode = LEN;
         case LEN:
 	    WATCHDOG_RESET();
-            if (have >= 6 && left >= 258) {
+            if (have >= INFLATE_FAST_MIN_HAVE && left >= 258) {
                 RESTORE();
                 inflate_fast(strm, out);
                 LOAD();
@@ -0,0 +1,1077 @@
+// SPDX-License-Identifier: GPL-2.0+ OR BSD-3-Clause
+/*
+ * Zstandard decompression
+ *
+ * This is a compact, single-pass decoder for the frame format described in
+ * RFC 8878. It decodes straight into the caller's buffer and does not
+ * support dictionaries, since neither the zstd tool nor mkimage produce them
+ * for boot images.
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <linux/kernel.h>
+#include <linux/types.h>
+#include <u-boot/zstd.h>
+
+#define ZSTD_MAGIC		0xfd2fb528
+#define ZSTD_SKIP_MAGIC		0x184d2a50
+#define ZSTD_SKIP_MAGIC_MASK	0xfffffff0
+
+#define ZSTD_BLOCK_MAX		(128 << 10)
+#define ZSTD_REP_COUNT		3
+
+enum {
+	ZSTD_BLOCK_RAW,
+	ZSTD_BLOCK_RLE,
+	ZSTD_BLOCK_COMPRESSED,
+	ZSTD_BLOCK_RESERVED,
+};
+
+enum {
+	ZSTD_LIT_RAW,
+	ZSTD_LIT_RLE,
+	ZSTD_LIT_COMPRESSED,
+	ZSTD_LIT_TREELESS,
+};
+
+enum {
+	ZSTD_SEQ_PREDEFINED,
+	ZSTD_SEQ_RLE,
+	ZSTD_SEQ_FSE,
+	ZSTD_SEQ_REPEAT,
+};
+
+#define HUF_MAX_BITS		11
+#define HUF_MAX_SYMBOLS		256
+#define HUF_WEIGHT_LOG_MAX	6
+
+#define LL_LOG_MAX		9
+#define ML_LOG_MAX		9
+#define OF_LOG_MAX		8
+#define LL_MAX_CODE		35
+#define ML_MAX_CODE		52
+#define OF_MAX_CODE		31
+
+/**
+ * struct zstd_fse - Entry in an FSE decoding table
+ *
+ * @symbol:	Symbol decoded in this state
+ * @nbits:	Number of bits to read for the next state
+ * @base:	Value to add to those bits to get the next state
+ */
+struct zstd_fse {
+	u8 symbol;
+	u8 nbits;
+	u16 base;
+};
+
+/**
+ * struct zstd_huf - Huffman decoding table for literals
+ *
+ * @max_bits:	Length of the longest code, 0 if there is no table yet
+ * @symbol:	Symbol for each max_bits-wide prefix
+ * @nbits:	Code length for each max_bits-wide prefix
+ */
+struct zstd_huf {
+	int max_bits;
+	u8 symbol[1 << HUF_MAX_BITS];
+	u8 nbits[1 << HUF_MAX_BITS];
+};
+
+/**
+ * struct zstd_seq_table - FSE table for one sequence field
+ *
+ * @log:	Accuracy log of the table, or -1 if not set up yet
+ * @table:	Decoding table, with 1 << @log entries
+ */
+struct zstd_seq_table {
+	int log;
+	struct zstd_fse *table;
+};
+
+/**
+ * struct zstd_ctx - Decoder state which persists across blocks of a frame
+ *
+ * @huf:	Literals Huffman table, reused by treeless literal blocks
+ * @ll:		Literal-length table
+ * @of:		Offset table
+ * @ml:		Match-length table
+ * @rep:	Repeat offsets
+ * @ll_buf:	Storage for @ll
+ * @of_buf:	Storage for @of
+ * @ml_buf:	Storage for @ml
+ * @lit_buf:	Decoded literals of the current block
+ */
+struct zstd_ctx {
+	struct zstd_huf huf;
+	struct zstd_seq_table ll;
+	struct zstd_seq_table of;
+	struct zstd_seq_table ml;
+	u32 rep[ZSTD_REP_COUNT];
+	struct zstd_fse ll_buf[1 << LL_LOG_MAX];
+	struct zstd_fse of_buf[1 << OF_LOG_MAX];
+	struct zstd_fse ml_buf[1 << ML_LOG_MAX];
+	u8 lit_buf[ZSTD_BLOCK_MAX];
+};
+
+/**
+ * struct zstd_bits - Reader for a bitstream which is consumed backwards
+ *
+ * Entropy-coded streams are written forwards and read from the end. The
+ * last byte holds a 1 bit marking where the data starts. Reading past the
+ * start yields zero bits; callers check @pos afterwards to detect this.
+ *
+ * @src:	Start of the stream
+ * @len:	Length of the stream in bytes
+ * @pos:	Number of bits not yet read (may go negative)
+ */
+struct zstd_bits {
+	const u8 *src;
+	size_t len;
+	long pos;
+};
+
+static const u32 ll_base[LL_MAX_CODE + 1] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048,
+	4096, 8192, 16384, 32768, 65536,
+};
+
+static const u8 ll_bits[LL_MAX_CODE + 1] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+	13, 14, 15, 16,
+};
+
+static const u32 ml_base[ML_MAX_CODE + 1] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+	19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+	35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+	4099, 8195, 16387, 32771, 65539,
+};
+
+static const u8 ml_bits[ML_MAX_CODE + 1] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+	12, 13, 14, 15, 16,
+};
+
+/* Predefined distributions, used when a block does not supply its own */
+static const s16 ll_default[LL_MAX_CODE + 1] = {
+	4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+	-1, -1, -1, -1,
+};
+
+static const s16 ml_default[ML_MAX_CODE + 1] = {
+	1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+	-1, -1, -1, -1, -1,
+};
+
+static const s16 of_default[29] = {
+	1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+};
+
+static inline int highbit(u32 val)
+{
+	return fls(val) - 1;
+}
+
+static inline u32 zstd_le32(const u8 *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (u32)p[3] << 24;
+}
+
+/* Read @n bits (at most 25) at bit @pos of a forwards bitstream */
+static u32 zstd_fwd_bits(const u8 *src, size_t len, size_t pos, int n)
+{
+	size_t byte = pos >> 3;
+	u32 val = 0;
+	int i;
+
+	for (i = 3; i >= 0; i--)
+		val = val << 8 | (byte + i < len ? src[byte + i] : 0);
+
+	return (val >> (pos & 7)) & ((1 << n) - 1);
+}
+
+static inline u64 zstd_load_le64(const u8 *p)
+{
+	u64 val;
+
+	memcpy(&val, p, sizeof(val));
+
+	return le64_to_cpu(val);
+}
+
+static int zstd_bits_init(struct zstd_bits *bits, const u8 *src, size_t len)
+{
+	if (!len || !src[len - 1])
+		return -EINVAL;
+	bits->src = src;
+	bits->len = len;
+	bits->pos = len * 8 - 8 + highbit(src[len - 1]);
+
+	return 0;
+}
+
+/* Read bits starting at bit @pos, which must be within the stream */
+static inline u64 zstd_bits_peek(const struct zstd_bits *bits, long pos)
+{
+	size_t byte = pos >> 3;
+	u64 val = 0;
+	int i;
+
+	if (byte + 8 <= bits->len)
+		return zstd_load_le64(bits->src + byte) >> (pos & 7);
+	for (i = bits->len - byte - 1; i >= 0; i--)
+		val = val << 8 | bits->src[byte + i];
+
+	return val >> (pos & 7);
+}
+
+/* Read @n bits (at most 32) from a backwards bitstream */
+static inline u32 zstd_bits_read(struct zstd_bits *bits, int n)
+{
+	u64 mask = (1ULL << n) - 1;
+	long pos;
+
+	if (!n)
+		return 0;
+	bits->pos -= n;
+	pos = bits->pos;
+	if (pos >= 0)
+		return zstd_bits_peek(bits, pos) & mask;
+	if (pos <= -n)
+		return 0;
+
+	/* Some of the bits are before the start, so read as zeroes */
+	return (zstd_bits_peek(bits, 0) & (mask >> -pos)) << -pos;
+}
+
+static void zstd_fse_build(struct zstd_fse *table, const s16 *probs,
+			   int nsymbols, int log)
+{
+	u16 next[HUF_MAX_SYMBOLS];
+	int size = 1 << log;
+	int high = size - 1;
+	int step = (size >> 1) + (size >> 3) + 3;
+	int pos = 0;
+	int s, i;
+
+	/* Symbols with a 'less than 1' probability go at the top */
+	for (s = 0; s < nsymbols; s++) {
+		if (probs[s] == -1) {
+			table[high--].symbol = s;
+			next[s] = 1;
+		} else {
+			next[s] = probs[s];
+		}
+	}
+
+	/* Spread the rest through the table */
+	for (s = 0; s < nsymbols; s++) {
+		for (i = 0; i < probs[s]; i++) {
+			table[pos].symbol = s;
+			do {
+				pos = (pos + step) & (size - 1);
+			} while (pos > high);
+		}
+	}
+
+	for (i = 0; i < size; i++) {
+		u16 state = next[table[i].symbol]++;
+		int nbits = log - highbit(state);
+
+		table[i].nbits = nbits;
+		table[i].base = (state << nbits) - size;
+	}
+}
+
+
+/**
+ * zstd_fse_read() - Read an FSE table description and build the table
+ *
+ * @table:	Returns the decoding table
+ * @src:	Table description
+ * @len:	Bytes available at @src
+ * @max_symbol:	Largest symbol value allowed
+ * @max_log:	Largest accuracy log allowed
+ * @logp:	Returns the accuracy log
+ * @return number of bytes used, or -ve on error
+ */
+static int zstd_fse_read(struct zstd_fse *table, const u8 *src, size_t len,
+			 int max_symbol, int max_log, int *logp)
+{
+	s16 probs[HUF_MAX_SYMBOLS];
+	int remaining, log, repeat, i, symbol = 0;
+	size_t pos = 4;
+
+	if (!len)
+		return -EINVAL;
+	log = (src[0] & 0xf) + 5;
+	if (log > max_log)
+		return -EINVAL;
+	remaining = 1 << log;
+
+	while (remaining > 0 && symbol <= max_symbol) {
+		int nbits = highbit(remaining + 1) + 1;
+		u32 low_mask = (1 << (nbits - 1)) - 1;
+		u32 threshold = (1 << nbits) - 1 - (remaining + 1);
+		u32 val;
+		int prob;
+
+		val = zstd_fwd_bits(src, len, pos, nbits);
+		if ((val & low_mask) < threshold) {
+			val &= low_mask;
+			pos += nbits - 1;
+		} else {
+			if (val > low_mask)
+				val -= threshold;
+			pos += nbits;
+		}
+		prob = (int)val - 1;
+		remaining -= prob < 0 ? -prob : prob;
+		probs[symbol++] = prob;
+
+		/* A zero probability is followed by 2-bit repeat counts */
+		if (!prob) {
+			do {
+				repeat = zstd_fwd_bits(src, len, pos, 2);
+				pos += 2;
+				for (i = 0; i < repeat; i++) {
+					if (symbol > max_symbol)
+						return -EINVAL;
+					probs[symbol++] = 0;
+				}
+			} while (repeat == 3);
+		}
+	}
+	if (remaining || (pos + 7) / 8 > len)
+		return -EINVAL;
+
+	zstd_fse_build(table, probs, symbol, log);
+	*logp = log;
+
+	return (pos + 7) / 8;
+}
+
+static inline int zstd_fse_init_state(int log, struct zstd_bits *bits)
+{
+	return zstd_bits_read(bits, log);
+}
+
+static inline int zstd_fse_next_state(const struct zstd_fse *table,
+				      int state, struct zstd_bits *bits)
+{
+	return table[state].base + zstd_bits_read(bits, table[state].nbits);
+}
+
+/**
+ * zstd_huf_read() - Read a Huffman tree description and build the table
+ *
+ * @huf:	Returns the decoding table
+ * @src:	Tree description
+ * @len:	Bytes available at @src
+ * @return number of bytes used, or -ve on error
+ */
+static int zstd_huf_read(struct zstd_huf *huf, const u8 *src, size_t len)
+{
+	struct zstd_fse table[1 << HUF_WEIGHT_LOG_MAX];
+	u8 weights[HUF_MAX_SYMBOLS];
+	u16 rank_count[HUF_MAX_BITS + 1];
+	u16 rank_idx[HUF_MAX_BITS + 1];
+	int nweights, used, max_bits, i;
+	u32 total, left;
+
+	if (!len)
+		return -EINVAL;
+	if (src[0] >= 128) {
+		/* Weights stored directly as 4-bit values */
+		nweights = src[0] - 127;
+		used = 1 + (nweights + 1) / 2;
+		if (used > len)
+			return -EINVAL;
+		for (i = 0; i < nweights; i++)
+			weights[i] = src[1 + i / 2] >> (i & 1 ? 0 : 4) & 0xf;
+	} else {
+		/* Weights compressed with FSE, using two interleaved states */
+		struct zstd_bits bits;
+		int log, hdr, state1, state2;
+
+		used = 1 + src[0];
+		if (used > len)
+			return -EINVAL;
+		hdr = zstd_fse_read(table, src + 1, src[0], HUF_MAX_BITS,
+				    HUF_WEIGHT_LOG_MAX, &log);
+		if (hdr < 0)
+			return hdr;
+		if (zstd_bits_init(&bits, src + 1 + hdr, src[0] - hdr))
+			return -EINVAL;
+		state1 = zstd_fse_init_state(log, &bits);
+		state2 = zstd_fse_init_state(log, &bits);
+		for (nweights = 0; nweights < HUF_MAX_SYMBOLS - 2; ) {
+			weights[nweights++] = table[state1].symbol;
+			state1 = zstd_fse_next_state(table, state1, &bits);
+			if (bits.pos < 0) {
+				weights[nweights++] = table[state2].symbol;
+				break;
+			}
+			weights[nweights++] = table[state2].symbol;
+			state2 = zstd_fse_next_state(table, state2, &bits);
+			if (bits.pos < 0) {
+				weights[nweights++] = table[state1].symbol;
+				break;
+			}
+		}
+		if (bits.pos >= 0)
+			return -EINVAL;
+	}
+
+	/* The weight of the last symbol is implied by the others */
+	total = 0;
+	for (i = 0; i < nweights; i++) {
+		if (weights[i] > HUF_MAX_BITS)
+			return -EINVAL;
+		if (weights[i])
+			total += 1 << (weights[i] - 1);
+	}
+	if (!total || nweights >= HUF_MAX_SYMBOLS)
+		return -EINVAL;
+	max_bits = highbit(total) + 1;
+	if (max_bits > HUF_MAX_BITS)
+		return -EINVAL;
+	left = (1 << max_bits) - total;
+	if (left & (left - 1))
+		return -EINVAL;
+	weights[nweights++] = highbit(left) + 1;
+
+	/* Convert weights to code lengths and count them */
+	memset(rank_count, '\0', sizeof(rank_count));
+	for (i = 0; i < nweights; i++) {
+		if (weights[i])
+			weights[i] = max_bits + 1 - weights[i];
+		rank_count[weights[i]]++;
+	}
+
+	/* Longest codes take the lowest prefixes */
+	rank_idx[max_bits] = 0;
+	for (i = max_bits; i >= 1; i--) {
+		rank_idx[i - 1] = rank_idx[i] + rank_count[i] *
+			(1 << (max_bits - i));
+		memset(&huf->nbits[rank_idx[i]], i,
+		       rank_idx[i - 1] - rank_idx[i]);
+	}
+	if (rank_idx[0] != 1 << max_bits)
+		return -EINVAL;
+	for (i = 0; i < nweights; i++) {
+		int nbits = weights[i];
+		int count;
+
+		if (!nbits)
+			continue;
+		count = 1 << (max_bits - nbits);
+		memset(&huf->symbol[rank_idx[nbits]], i, count);
+		rank_idx[nbits] += count;
+	}
+	huf->max_bits = max_bits;
+
+	return used;
+}
+
+static int zstd_huf_stream(const struct zstd_huf *huf, u8 *dst, size_t count,
+			   const u8 *src, size_t len)
+{
+	struct zstd_bits bits;
+	int max_bits = huf->max_bits;
+	int mask = (1 << max_bits) - 1;
+	int state;
+	u8 *end = dst + count;
+
+	if (zstd_bits_init(&bits, src, len))
+		return -EINVAL;
+	state = zstd_bits_read(&bits, max_bits);
+	while (dst < end) {
+		int nbits = huf->nbits[state];
+
+		*dst++ = huf->symbol[state];
+		state = ((state << nbits) | zstd_bits_read(&bits, nbits)) &
+			mask;
+	}
+	if (bits.pos != -max_bits)
+		return -EINVAL;
+
+	return 0;
+}
+
+/**
+ * zstd_literals() - Decode the literals section of a compressed block
+ *
+ * Raw literals are used in place. Others are decoded into @ctx->lit_buf,
+ * since the output buffer may be much larger than the data and nothing may
+ * be written past the end of the decompressed data.
+ *
+ * @ctx:	Decoder context
+ * @src:	Start of the literals section
+ * @len:	Size of the block
+ * @litp:	Returns a pointer to the literals
+ * @lit_sizep:	Returns the number of literals
+ * @return number of bytes of @src used, or -ve on error
+ */
+static int zstd_literals(struct zstd_ctx *ctx, const u8 *src, size_t len,
+			 const u8 **litp, size_t *lit_sizep)
+{
+	int type = src[0] & 3;
+	int format = (src[0] >> 2) & 3;
+	size_t regen, comp, hdr, total_comp;
+	u8 *lit = ctx->lit_buf;
+	int ret;
+
+	if (type == ZSTD_LIT_RAW || type == ZSTD_LIT_RLE) {
+		switch (format) {
+		case 0:
+		case 2:
+			hdr = 1;
+			regen = src[0] >> 3;
+			break;
+		case 1:
+			hdr = 2;
+			if (len < hdr)
+				return -EINVAL;
+			regen = (src[0] >> 4) + (src[1] << 4);
+			break;
+		default:
+			hdr = 3;
+			if (len < hdr)
+				return -EINVAL;
+			regen = (src[0] >> 4) + (src[1] << 4) + (src[2] << 12);
+			break;
+		}
+		if (regen > ZSTD_BLOCK_MAX)
+			return -EINVAL;
+		if (type == ZSTD_LIT_RAW) {
+			if (hdr + regen > len)
+				return -EINVAL;
+			*litp = src + hdr;
+			*lit_sizep = regen;
+			return hdr + regen;
+		}
+		if (hdr + 1 > len)
+			return -EINVAL;
+		memset(lit, src[hdr], regen);
+		*litp = lit;
+		*lit_sizep = regen;
+		return hdr + 1;
+	}
+
+	/* Huffman-coded literals, in one or four streams */
+	hdr = format < 2 ? 3 : format + 2;
+	if (len < hdr)
+		return -EINVAL;
+	if (hdr == 5) {
+		u32 h = zstd_le32(src);
+
+		regen = (h >> 4) & 0x3ffff;
+		comp = (h >> 22) | (src[4] << 10);
+	} else {
+		u32 h = src[0] | src[1] << 8 | src[2] << 16;
+
+		if (hdr == 4)
+			h |= (u32)src[3] << 24;
+		regen = (h >> 4) & (hdr == 3 ? 0x3ff : 0x3fff);
+		comp = h >> (hdr == 3 ? 14 : 18);
+	}
+	if (regen > ZSTD_BLOCK_MAX || hdr + comp > len)
+		return -EINVAL;
+	total_comp = comp;
+	src += hdr;
+
+	if (type == ZSTD_LIT_COMPRESSED) {
+		ret = zstd_huf_read(&ctx->huf, src, comp);
+		if (ret < 0)
+			return ret;
+		src += ret;
+		comp -= ret;
+	} else if (!ctx->huf.max_bits) {
+		return -EINVAL;
+	}
+
+	if (format == 0) {
+		ret = zstd_huf_stream(&ctx->huf, lit, regen, src, comp);
+	} else {
+		size_t seg = (regen + 3) / 4;
+		size_t size[4], total = 6;
+		int i;
+
+		if (comp < 6 || regen < 3 * seg)
+			return -EINVAL;
+		for (i = 0; i < 3; i++) {
+			size[i] = src[2 * i] | src[2 * i + 1] << 8;
+			total += size[i];
+		}
+		if (total > comp)
+			return -EINVAL;
+		size[3] = comp - total;
+		src += 6;
+		for (i = 0, ret = 0; i < 4 && !ret; i++) {
+			ret = zstd_huf_stream(&ctx->huf, lit + i * seg,
+					      i < 3 ? seg : regen - 3 * seg,
+					      src, size[i]);
+			src += size[i];
+		}
+	}
+	if (ret)
+		return ret;
+	*litp = lit;
+	*lit_sizep = regen;
+
+	return hdr + total_comp;
+}
+
+static int zstd_seq_table(struct zstd_seq_table *seq, struct zstd_fse *buf,
+			  int mode, const u8 *src, size_t len,
+			  const s16 *def, int ndef, int def_log,
+			  int max_symbol, int max_log)
+{
+	switch (mode) {
+	case ZSTD_SEQ_PREDEFINED:
+		zstd_fse_build(buf, def, ndef, def_log);
+		seq->log = def_log;
+		seq->table = buf;
+		return 0;
+	case ZSTD_SEQ_RLE:
+		if (!len || src[0] > max_symbol)
+			return -EINVAL;
+		buf[0].symbol = src[0];
+		buf[0].nbits = 0;
+		buf[0].base = 0;
+		seq->log = 0;
+		seq->table = buf;
+		return 1;
+	case ZSTD_SEQ_FSE:
+		seq->table = buf;
+		return zstd_fse_read(buf, src, len, max_symbol, max_log,
+				     &seq->log);
+	default:
+		/* Repeat the table used by the previous block */
+		return seq->log < 0 ? -EINVAL : 0;
+	}
+}
+
+static void zstd_copy_match(u8 *op, size_t offset, size_t len)
+{
+	const u8 *match = op - offset;
+
+	if (offset >= len) {
+		memcpy(op, match, len);
+		return;
+	}
+
+	/* Overlapping match: copy in chunks no larger than the offset */
+	if (offset >= 8) {
+		for (; len >= 8; len -= 8, op += 8, match += 8)
+			memcpy(op, match, 8);
+	}
+	while (len--)
+		*op++ = *match++;
+}
+
+/**
+ * zstd_sequences() - Decode and execute the sequences of a compressed block
+ *
+ * @ctx:	Decoder context
+ * @src:	Start of the sequences section
+ * @len:	Size of the sequences section
+ * @opp:	Current output position, updated on exit
+ * @fstart:	Start of output for this frame, the limit for match offsets
+ * @oend:	End of the output buffer
+ * @lit:	Literals for this block
+ * @lit_size:	Number of literals
+ * @return 0 if OK, -ve on error
+ */
+static int zstd_sequences(struct zstd_ctx *ctx, const u8 *src, size_t len,
+			  u8 **opp, u8 *fstart, u8 *oend, const u8 *lit,
+			  size_t lit_size)
+{
+	const u8 *lit_end = lit + lit_size;
+	const u8 *end = src + len;
+	struct zstd_bits bits;
+	int ll_state, of_state, ml_state;
+	u8 *op = *opp;
+	int nseq, ret;
+
+	if (!len)
+		return -EINVAL;
+	nseq = *src++;
+	if (nseq >= 128) {
+		if (src >= end)
+			return -EINVAL;
+		if (nseq == 255) {
+			if (end - src < 2)
+				return -EINVAL;
+			nseq = src[0] + (src[1] << 8) + 0x7f00;
+			src += 2;
+		} else {
+			nseq = ((nseq - 128) << 8) + *src++;
+		}
+	}
+
+	if (nseq) {
+		int modes;
+
+		if (src >= end)
+			return -EINVAL;
+		modes = *src++;
+		if (modes & 3)
+			return -EINVAL;
+		ret = zstd_seq_table(&ctx->ll, ctx->ll_buf, modes >> 6, src,
+				     end - src, ll_default,
+				     ARRAY_SIZE(ll_default), 6, LL_MAX_CODE,
+				     LL_LOG_MAX);
+		if (ret < 0)
+			return ret;
+		src += ret;
+		ret = zstd_seq_table(&ctx->of, ctx->of_buf, (modes >> 4) & 3,
+				     src, end - src, of_default,
+				     ARRAY_SIZE(of_default), 5, OF_MAX_CODE,
+				     OF_LOG_MAX);
+		if (ret < 0)
+			return ret;
+		src += ret;
+		ret = zstd_seq_table(&ctx->ml, ctx->ml_buf, (modes >> 2) & 3,
+				     src, end - src, ml_default,
+				     ARRAY_SIZE(ml_default), 6, ML_MAX_CODE,
+				     ML_LOG_MAX);
+		if (ret < 0)
+			return ret;
+		src += ret;
+
+		if (zstd_bits_init(&bits, src, end - src))
+			return -EINVAL;
+		ll_state = zstd_fse_init_state(ctx->ll.log, &bits);
+		of_state = zstd_fse_init_state(ctx->of.log, &bits);
+		ml_state = zstd_fse_init_state(ctx->ml.log, &bits);
+	} else {
+		if (src != end)
+			return -EINVAL;
+		bits.pos = 0;
+	}
+
+	while (nseq--) {
+		int ll_code = ctx->ll.table[ll_state].symbol;
+		int of_code = ctx->of.table[of_state].symbol;
+		int ml_code = ctx->ml.table[ml_state].symbol;
+		size_t ll, ml;
+		u32 offset;
+
+		offset = (1U << of_code) + zstd_bits_read(&bits, of_code);
+		ml = ml_base[ml_code] + zstd_bits_read(&bits, ml_bits[ml_code]);
+		ll = ll_base[ll_code] + zstd_bits_read(&bits, ll_bits[ll_code]);
+		if (nseq) {
+			ll_state = zstd_fse_next_state(ctx->ll.table, ll_state,
+						       &bits);
+			ml_state = zstd_fse_next_state(ctx->ml.table, ml_state,
+						       &bits);
+			of_state = zstd_fse_next_state(ctx->of.table, of_state,
+						       &bits);
+		}
+
+		if (offset > ZSTD_REP_COUNT) {
+			offset -= ZSTD_REP_COUNT;
+			ctx->rep[2] = ctx->rep[1];
+			ctx->rep[1] = ctx->rep[0];
+			ctx->rep[0] = offset;
+		} else {
+			int idx = offset - 1 + !ll;
+
+			if (idx) {
+				offset = idx < ZSTD_REP_COUNT ? ctx->rep[idx] :
+					ctx->rep[0] - 1;
+				if (idx > 1)
+					ctx->rep[2] = ctx->rep[1];
+				ctx->rep[1] = ctx->rep[0];
+				ctx->rep[0] = offset;
+			} else {
+				offset = ctx->rep[0];
+			}
+		}
+
+		if (ll > lit_end - lit)
+			return -EINVAL;
+		if (ll > oend - op)
+			return -ENOBUFS;
+		memmove(op, lit, ll);
+		op += ll;
+		lit += ll;
+
+		if (!offset || offset > op - fstart)
+			return -EINVAL;
+		if (ml > oend - op)
+			return -ENOBUFS;
+		zstd_copy_match(op, offset, ml);
+		op += ml;
+	}
+	if (bits.pos)
+		return -EINVAL;
+
+	/* Whatever literals are left go at the end of the block */
+	if (lit_end - lit > oend - op)
+		return -ENOBUFS;
+	memmove(op, lit, lit_end - lit);
+	*opp = op + (lit_end - lit);
+
+	return 0;
+}
+
+#define XXH_PRIME64_1	0x9e3779b185ebca87ULL
+#define XXH_PRIME64_2	0xc2b2ae3d27d4eb4fULL
+#define XXH_PRIME64_3	0x165667b19e3779f9ULL
+#define XXH_PRIME64_4	0x85ebca77c2b2ae63ULL
+#define XXH_PRIME64_5	0x27d4eb2f165667c5ULL
+
+static inline u64 xxh64_rotl(u64 val, int bits)
+{
+	return val << bits | val >> (64 - bits);
+}
+
+static inline u64 xxh64_round(u64 acc, u64 input)
+{
+	acc += input * XXH_PRIME64_2;
+
+	return xxh64_rotl(acc, 31) * XXH_PRIME64_1;
+}
+
+static inline u64 xxh64_merge(u64 acc, u64 val)
+{
+	acc ^= xxh64_round(0, val);
+
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+/* XXH64 with a seed of 0, as used for the zstd content checksum */
+static u64 xxh64(const u8 *p, size_t len)
+{
+	const u8 *end = p + len;
+	u64 hash;
+
+	if (len >= 32) {
+		u64 v1 = XXH_PRIME64_1 + XXH_PRIME64_2;
+		u64 v2 = XXH_PRIME64_2;
+		u64 v3 = 0;
+		u64 v4 = -XXH_PRIME64_1;
+
+		do {
+			v1 = xxh64_round(v1, zstd_load_le64(p));
+			v2 = xxh64_round(v2, zstd_load_le64(p + 8));
+			v3 = xxh64_round(v3, zstd_load_le64(p + 16));
+			v4 = xxh64_round(v4, zstd_load_le64(p + 24));
+			p += 32;
+		} while (end - p >= 32);
+		hash = xxh64_rotl(v1, 1) + xxh64_rotl(v2, 7) +
+			xxh64_rotl(v3, 12) + xxh64_rotl(v4, 18);
+		hash = xxh64_merge(hash, v1);
+		hash = xxh64_merge(hash, v2);
+		hash = xxh64_merge(hash, v3);
+		hash = xxh64_merge(hash, v4);
+	} else {
+		hash = XXH_PRIME64_5;
+	}
+	hash += len;
+
+	for (; end - p >= 8; p += 8) {
+		hash ^= xxh64_round(0, zstd_load_le64(p));
+		hash = xxh64_rotl(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+	}
+	if (end - p >= 4) {
+		hash ^= (u64)zstd_le32(p) * XXH_PRIME64_1;
+		hash = xxh64_rotl(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		hash ^= *p * XXH_PRIME64_5;
+		hash = xxh64_rotl(hash, 11) * XXH_PRIME64_1;
+	}
+	hash ^= hash >> 33;
+	hash *= XXH_PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= XXH_PRIME64_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+/**
+ * zstd_frame() - Decode a single Zstandard frame
+ *
+ * @ctx:	Decoder context
+ * @srcp:	Start of the frame (after the magic number), updated to
+ *		point just past it on exit
+ * @send:	End of the input
+ * @opp:	Output position, updated on exit
+ * @oend:	End of the output buffer
+ * @return 0 if OK, -ve on error
+ */
+static int zstd_frame(struct zstd_ctx *ctx, const u8 **srcp, const u8 *send,
+		      u8 **opp, u8 *oend)
+{
+	static const u8 fcs_size[] = { 0, 2, 4, 8 };
+	static const u8 did_size[] = { 0, 1, 2, 4 };
+	const u8 *src = *srcp;
+	u8 *fstart = *opp;
+	u8 *op = fstart;
+	int fhd, fcs_len, did_len, i;
+	u64 content_size = 0;
+	u32 dict_id = 0;
+	bool last;
+
+	if (src >= send)
+		return -EINVAL;
+	fhd = *src++;
+	if (fhd & 0x08)
+		return -EINVAL;
+	fcs_len = fcs_size[fhd >> 6];
+	if (!fcs_len && (fhd & 0x20))
+		fcs_len = 1;
+	did_len = did_size[fhd & 3];
+	if (send - src < !(fhd & 0x20) + did_len + fcs_len)
+		return -EINVAL;
+
+	/* The window size does not matter as we decode to a flat buffer */
+	if (!(fhd & 0x20))
+		src++;
+	for (i = did_len - 1; i >= 0; i--)
+		dict_id = dict_id << 8 | src[i];
+	src += did_len;
+	if (dict_id)
+		return -EPROTONOSUPPORT;
+	for (i = fcs_len - 1; i >= 0; i--)
+		content_size = content_size << 8 | src[i];
+	if (fcs_len == 2)
+		content_size += 256;
+	src += fcs_len;
+
+	ctx->huf.max_bits = 0;
+	ctx->ll.log = -1;
+	ctx->of.log = -1;
+	ctx->ml.log = -1;
+	ctx->rep[0] = 1;
+	ctx->rep[1] = 4;
+	ctx->rep[2] = 8;
+
+	do {
+		u32 hdr, size;
+		int type, ret;
+
+		if (send - src < 3)
+			return -EINVAL;
+		hdr = src[0] | src[1] << 8 | src[2] << 16;
+		src += 3;
+		last = hdr & 1;
+		type = (hdr >> 1) & 3;
+		size = hdr >> 3;
+		if (size > ZSTD_BLOCK_MAX)
+			return -EINVAL;
+
+		switch (type) {
+		case ZSTD_BLOCK_RAW:
+			if (size > send - src)
+				return -EINVAL;
+			if (size > oend - op)
+				return -ENOBUFS;
+			memcpy(op, src, size);
+			op += size;
+			src += size;
+			break;
+		case ZSTD_BLOCK_RLE:
+			if (src >= send)
+				return -EINVAL;
+			if (size > oend - op)
+				return -ENOBUFS;
+			memset(op, *src++, size);
+			op += size;
+			break;
+		case ZSTD_BLOCK_COMPRESSED: {
+			const u8 *lit;
+			size_t lit_size;
+
+			if (!size || size > send - src)
+				return -EINVAL;
+			ret = zstd_literals(ctx, src, size, &lit, &lit_size);
+			if (ret < 0)
+				return ret;
+			ret = zstd_sequences(ctx, src + ret, size - ret, &op,
+					     fstart, oend, lit, lit_size);
+			if (ret)
+				return ret;
+			src += size;
+			break;
+		}
+		default:
+			return -EINVAL;
+		}
+	} while (!last);
+
+	if (fcs_len && op - fstart != content_size)
+		return -EINVAL;
+	if (fhd & 0x04) {
+		if (send - src < 4)
+			return -EINVAL;
+		if ((u32)xxh64(fstart, op - fstart) != zstd_le32(src))
+			return -EINVAL;
+		src += 4;
+	}
+	*srcp = src;
+	*opp = op;
+
+	return 0;
+}
+
+int zstd_decompress(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	const u8 *in = src, *end = in + srcn;
+	u8 *op = dst, *oend = op + *dstn;
+	struct zstd_ctx *ctx;
+	int ret = 0;
+
+	ctx = malloc(sizeof(*ctx));
+	if (!ctx)
+		return -ENOMEM;
+
+	while (in < end) {
+		u32 magic;
+
+		if (end - in < 8) {
+			ret = -EINVAL;
+			break;
+		}
+		magic = zstd_le32(in);
+		in += 4;
+		if ((magic & ZSTD_SKIP_MAGIC_MASK) == ZSTD_SKIP_MAGIC) {
+			u32 size = zstd_le32(in);
+
+			if (size > end - in - 4) {
+				ret = -EINVAL;
+				break;
+			}
+			in += 4 + size;
+			continue;
+		}
+		if (magic != ZSTD_MAGIC) {
+			ret = -EINVAL;
+			break;
+		}
+		ret = zstd_frame(ctx, &in, end, &op, oend);
+		if (ret)
+			break;
+	}
+	*dstn = op - (u8 *)dst;
+	free(ctx);
+
+	return ret;
+}
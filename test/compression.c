@@ -9,6 +9,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/zlib.h>
 #include <bzlib.h>
@@ -18,6 +19,7 @@
 #include <lzma/LzmaTools.h>
 
 #include <linux/lzo.h>
+#include <u-boot/zstd.h>
 #include <test/compression.h>
 #include <test/suites.h>
 #include <test/ut.h>
@@ -117,6 +119,23 @@ static const char lz4_compressed[] =
 	"\x9d\x12\x8c\x9d";
 static const unsigned long lz4_compressed_size = 276;
 
+/* zstd -19 -c /tmp/plain.txt > /tmp/plain.zst */
+static const char zstd_compressed[] =
+	"\x28\xb5\x2f\xfd\x64\x5e\x00\xad\x05\x00\x42\x4e\x26\x17\x90\x3b"
+	"\x07\x04\x5a\x13\x8b\xa7\x65\x34\x12\x21\x6d\xb0\x39\xbb\xae\xe8"
+	"\xba\xc9\xcd\x5e\x02\x49\xd0\x2b\xa9\xfa\x96\x92\xe7\x1f\x19\x19"
+	"\x7c\x8f\xf1\x9d\x54\x37\xfc\xd6\x0a\xf3\x0c\x93\x56\xc7\x52\x4f"
+	"\x0a\x62\x3e\xd1\xa5\x83\x17\x31\xab\x5d\x8f\x57\xf3\xcc\x3b\x58"
+	"\xf8\x91\x8c\xf1\x2a\x5c\x89\xdd\xf2\x9b\x15\xb7\x92\x5b\xbe\xba"
+	"\xab\xd5\xd1\x34\xdf\xf0\x02\x0e\x61\xcd\x7b\xd6\x01\xfc\xc2\xa7"
+	"\xd4\xd1\x3d\x26\x9c\x10\x49\xb8\x5b\xcd\xba\x7c\xf7\xac\x4b\xad"
+	"\xb7\x31\x1c\xbc\xf9\xcb\x62\x8e\x2e\x9b\x0f\xd3\x87\x57\x45\x12"
+	"\x16\xfa\x3a\x79\xde\x65\xf8\xcc\x48\xd5\x43\xa6\xbd\xc3\x91\x29"
+	"\x65\x29\xa7\x5b\x9a\x08\x08\x00\x60\x13\x00\x63\xa3\x8e\x28\x94"
+	"\x79\x41\x2a\x78\xc2\x91\x70\x9f\xaa\x6a\x21\x7a\xa1\xaa\x0c\xe4"
+	"\xf4\x6e\xfa";
+static const unsigned long zstd_compressed_size = 195;
+
 
 #define TEST_BUFFER_SIZE	512
 
@@ -292,6 +311,48 @@ static int uncompress_using_lz4(struct unit_test_state *uts,
 	return (ret != 0);
 }
 
+static int compress_using_zstd(struct unit_test_state *uts,
+			       void *in, unsigned long in_size,
+			       void *out, unsigned long out_max,
+			       unsigned long *out_size)
+{
+	/* There is no zstd compression in u-boot, so fake it. */
+	ut_asserteq(in_size, strlen(plain));
+	ut_asserteq(0, memcmp(plain, in, in_size));
+
+	if (zstd_compressed_size > out_max)
+		return -1;
+
+	memcpy(out, zstd_compressed, zstd_compressed_size);
+	if (out_size)
+		*out_size = zstd_compressed_size;
+
+	return 0;
+}
+
+static int uncompress_using_zstd(struct unit_test_state *uts,
+				 void *in, unsigned long in_size,
+				 void *out, unsigned long out_max,
+				 unsigned long *out_size)
+{
+	size_t output_size = out_max;
+	char *ptr;
+	int ret;
+
+	/* Nothing may be written past the decompressed data */
+	memset(out, 'A', out_max);
+	ret = zstd_decompress(in, in_size, out, &output_size);
+	if (out_size)
+		*out_size = output_size;
+	for (ptr = out + output_size; !ret && ptr < (char *)out + out_max;
+	     ptr++) {
+		if (*ptr != 'A')
+			return 1;
+	}
+
+	return (ret != 0);
+}
+
 #define errcheck(statement) if (!(statement)) { \
 	fprintf(stderr, "\tFailed: %s\n", #statement); \
 	ret = 1; \
@@ -410,6 +471,52 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_gzip, 0);
 
+/* Test gunzip_exact() with and without padding after the gzip stream */
+static int compression_test_gzip_exact(struct unit_test_state *uts)
+{
+	unsigned long size, comp_size, plain_size = strlen(plain);
+	const int pad = 64;
+	void *comp, *out;
+
+	comp = malloc(TEST_BUFFER_SIZE + pad);
+	out = malloc(TEST_BUFFER_SIZE);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(out);
+
+	comp_size = TEST_BUFFER_SIZE;
+	ut_assertok(gzip(comp, &comp_size, (void *)plain, plain_size));
+
+	size = comp_size;
+	ut_assertok(gunzip_exact(out, TEST_BUFFER_SIZE, comp, &size));
+	ut_asserteq(plain_size, size);
+	ut_assertok(memcmp(plain, out, plain_size));
+
+	/* Too small a buffer */
+	size = comp_size;
+	ut_assert(gunzip_exact(out, plain_size - 1, comp, &size) != 0);
+
+	/* Padding with zeroes or 0xff bytes, as dd produces */
+	memset(comp + comp_size, '\0', pad);
+	size = comp_size + pad;
+	memset(out, '\0', TEST_BUFFER_SIZE);
+	ut_assertok(gunzip_exact(out, TEST_BUFFER_SIZE, comp, &size));
+	ut_asserteq(plain_size, size);
+	ut_assertok(memcmp(plain, out, plain_size));
+
+	memset(comp + comp_size, '\xff', pad);
+	size = comp_size + pad;
+	memset(out, '\0', TEST_BUFFER_SIZE);
+	ut_assertok(gunzip_exact(out, TEST_BUFFER_SIZE, comp, &size));
+	ut_asserteq(plain_size, size);
+	ut_assertok(memcmp(plain, out, plain_size));
+
+	free(out);
+	free(comp);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_exact, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -436,6 +543,93 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lz4, 0);
 
+#define LZ4_BLOCK_MAX		(64 << 10)
+
+/*
+ * Build an LZ4 frame with 64KiB maximum block size, holding a stored block
+ * of @first_size bytes, a full stored block, then the compressed block from
+ * lz4_compressed (which decodes to plain). Returns the frame size.
+ */
+static size_t lz4_build_frame(u8 *frame, u8 *expect, size_t first_size)
+{
+	static const u8 header[] = { 0x04, 0x22, 0x4d, 0x18, 0x60, 0x40, 0 };
+	const size_t sizes[] = { first_size, LZ4_BLOCK_MAX };
+	u8 *ptr = frame;
+	int i, j;
+
+	memcpy(ptr, header, sizeof(header));
+	ptr += sizeof(header);
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		put_unaligned_le32(sizes[i] | 0x80000000, ptr);
+		ptr += 4;
+		for (j = 0; j < sizes[i]; j++)
+			*expect++ = *ptr++ = (j ^ (j >> 8) ^ i) & 0xff;
+	}
+
+	/* The compressed block is 257 bytes after the 7-byte header */
+	memcpy(ptr, lz4_compressed + 7, 4 + 257);
+	ptr += 4 + 257;
+	memcpy(expect, plain, strlen(plain));
+	put_unaligned_le32(0, ptr);
+
+	return ptr + 4 - frame;
+}
+
+/* Check decoding of frames with several independent blocks */
+static int compression_test_lz4_blocks(struct unit_test_state *uts)
+{
+	const size_t max = 2 * LZ4_BLOCK_MAX + TEST_BUFFER_SIZE;
+	size_t frame_size, size, expect_size;
+	u8 *frame, *expect, *out;
+
+	frame = malloc(max);
+	expect = malloc(max);
+	out = malloc(max);
+	ut_assertnonnull(frame);
+	ut_assertnonnull(expect);
+	ut_assertnonnull(out);
+
+	/* Full blocks, so this can use the block index */
+	frame_size = lz4_build_frame(frame, expect, LZ4_BLOCK_MAX);
+	expect_size = 2 * LZ4_BLOCK_MAX + strlen(plain);
+	size = max;
+	ut_assertok(ulz4fn(frame, frame_size, out, &size));
+	ut_asserteq(expect_size, size);
+	ut_assertok(memcmp(expect, out, expect_size));
+
+	/* Exactly the right size */
+	size = expect_size;
+	ut_assertok(ulz4fn(frame, frame_size, out, &size));
+	ut_asserteq(expect_size, size);
+
+	/* Too small */
+	size = expect_size - 1;
+	ut_assert(ulz4fn(frame, frame_size, out, &size) != 0);
+
+	/* A short first block forces the serial fallback */
+	frame_size = lz4_build_frame(frame, expect, 1000);
+	expect_size = 1000 + LZ4_BLOCK_MAX + strlen(plain);
+	size = max;
+	memset(out, '\0', max);
+	ut_assertok(ulz4fn(frame, frame_size, out, &size));
+	ut_asserteq(expect_size, size);
+	ut_assertok(memcmp(expect, out, expect_size));
+
+	free(out);
+	free(expect);
+	free(frame);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_lz4_blocks, 0);
+
+static int compression_test_zstd(struct unit_test_state *uts)
+{
+	return run_test(uts, "zstd", compress_using_zstd,
+			uncompress_using_zstd);
+}
+COMPRESSION_TEST(compression_test_zstd, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -526,6 +720,12 @@ static int compression_test_bootm_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_bootm_lz4, 0);
 
+static int compression_test_bootm_zstd(struct unit_test_state *uts)
+{
+	return run_bootm_test(uts, IH_COMP_ZSTD, compress_using_zstd);
+}
+COMPRESSION_TEST(compression_test_bootm_zstd, 0);
+
 static int compression_test_bootm_none(struct unit_test_state *uts)
 {
 	return run_bootm_test(uts, IH_COMP_NONE, compress_using_none);
@@ -4,6 +4,7 @@
  */
 
 #include <common.h>
+#include <clk.h>
 #include <dm.h>
 #include <asm/clk.h>
 #include <dm/test.h>
@@ -138,3 +139,48 @@ static int dm_test_clk_bulk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_clk_bulk, DM_TESTF_SCAN_FDT);
+
+static int dm_test_clk_rate_cache(struct unit_test_state *uts)
+{
+	struct udevice *dev_clk, *dev_test;
+	struct clk_cache_stats base, stats;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_CLK, "clk-sbox",
+					      &dev_clk));
+	ut_assertok(uclass_get_device_by_name(UCLASS_MISC, "clk-test",
+					      &dev_test));
+	ut_assertok(sandbox_clk_test_get(dev_test));
+
+	/* Setting any rate means that all rates are read again */
+	ut_asserteq(0, sandbox_clk_test_set_rate(dev_test,
+						 SANDBOX_CLK_TEST_ID_SPI,
+						 1000));
+	ut_assertok(clk_get_cache_stats(dev_clk, &base));
+
+	/* Only the first request for each clock goes to the driver */
+	ut_asserteq(1000, sandbox_clk_test_get_rate(dev_test,
+						    SANDBOX_CLK_TEST_ID_SPI));
+	ut_asserteq(1000, sandbox_clk_test_get_rate(dev_test,
+						    SANDBOX_CLK_TEST_ID_SPI));
+	ut_asserteq(0, sandbox_clk_test_get_rate(dev_test,
+						 SANDBOX_CLK_TEST_ID_I2C));
+	ut_assertok(clk_get_cache_stats(dev_clk, &stats));
+	ut_asserteq(base.hits + 1, stats.hits);
+	ut_asserteq(base.misses + 2, stats.misses);
+
+	ut_asserteq(0, sandbox_clk_test_set_rate(dev_test,
+						 SANDBOX_CLK_TEST_ID_I2C,
+						 2000));
+	ut_asserteq(1000, sandbox_clk_test_get_rate(dev_test,
+						    SANDBOX_CLK_TEST_ID_SPI));
+	ut_asserteq(2000, sandbox_clk_test_get_rate(dev_test,
+						    SANDBOX_CLK_TEST_ID_I2C));
+	ut_asserteq(2000, sandbox_clk_test_get_rate(dev_test,
+						    SANDBOX_CLK_TEST_ID_I2C));
+	ut_assertok(clk_get_cache_stats(dev_clk, &stats));
+	ut_asserteq(base.hits + 2, stats.hits);
+	ut_asserteq(base.misses + 4, stats.misses);
+
+	return 0;
+}
+DM_TEST(dm_test_clk_rate_cache, DM_TESTF_SCAN_FDT);
@@ -6,10 +6,12 @@
  */
 
 #include <common.h>
+#include <bloblist.h>
 #include <errno.h>
 #include <dm.h>
 #include <fdtdec.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <dm/device-internal.h>
 #include <dm/root.h>
 #include <dm/util.h>
@@ -103,6 +105,31 @@ int dm_leak_check_end(struct unit_test_state *uts)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BLOBLIST)
+int dm_test_with_bloblist(struct unit_test_state *uts, uint size,
+			  int (*func)(struct unit_test_state *uts))
+{
+	struct bloblist_hdr *old_bloblist = gd->bloblist;
+	void *buf = NULL;
+	int ret;
+
+	gd->bloblist = NULL;
+	if (size) {
+		/* Allocated memory is in sandbox RAM, so keeps its alignment */
+		buf = memalign(BLOBLIST_ALIGN, size);
+		ret = buf ? bloblist_new(map_to_sysmem(buf), size, 0) : -ENOMEM;
+		if (ret)
+			goto out;
+	}
+	ret = func(uts);
+out:
+	gd->bloblist = old_bloblist;
+	free(buf);
+
+	return ret;
+}
+#endif
+
 /* Test that binding with platdata occurs correctly */
 static int dm_test_autobind(struct unit_test_state *uts)
 {
@@ -6,6 +6,7 @@
 #include <common.h>
 #include <fdtdec.h>
 #include <dm.h>
+#include <dm/device-internal.h>
 #include <dm/root.h>
 #include <dm/test.h>
 #include <dm/util.h>
@@ -247,3 +248,72 @@ static int dm_test_gpio_phandles(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_gpio_phandles, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test that name lookups are cached and the cache follows the GPIO banks */
+static int dm_test_gpio_lookup_cache(struct unit_test_state *uts)
+{
+	unsigned int offset, gpio, gpio2;
+	struct udevice *dev, *dev2;
+
+	ut_assertok(gpio_lookup_name("b4", &dev, &offset, &gpio));
+	ut_asserteq_str("extra-gpios", dev->name);
+	ut_assertok(gpio_lookup_name("b4", &dev2, &offset, &gpio2));
+	ut_asserteq_ptr(dev, dev2);
+	ut_asserteq(4, offset);
+	ut_asserteq(gpio, gpio2);
+
+	/* A removed bank must be probed again, not returned from the cache */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_asserteq(false, !!device_active(dev));
+	ut_assertok(gpio_lookup_name("b4", &dev2, &offset, &gpio2));
+	ut_asserteq_ptr(dev, dev2);
+	ut_asserteq(true, !!device_active(dev));
+	ut_asserteq(gpio, gpio2);
+
+	ut_asserteq(-EINVAL, gpio_lookup_name("zz4", &dev, NULL, NULL));
+	ut_asserteq(-EINVAL, gpio_lookup_name("zz4", &dev, NULL, NULL));
+
+	return 0;
+}
+DM_TEST(dm_test_gpio_lookup_cache, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test getting and setting a list of GPIOs at once */
+static int dm_test_gpio_bulk(struct unit_test_state *uts)
+{
+	struct gpio_desc desc_list[8];
+	struct udevice *dev, *gpio_a, *gpio_b;
+	ulong values;
+
+	ut_assertok(uclass_get_device(UCLASS_TEST_FDT, 0, &dev));
+	ut_asserteq(3, gpio_request_list_by_name(dev, "test-gpios", desc_list,
+						 ARRAY_SIZE(desc_list),
+						 GPIOD_IS_OUT));
+	gpio_a = desc_list[0].dev;
+	gpio_b = desc_list[2].dev;
+
+	/* a1 and a4 are set together, b5 separately */
+	ut_assertok(dm_gpios_set_values(desc_list, 3, 5));
+	ut_asserteq(1, sandbox_gpio_get_value(gpio_a, 1));
+	ut_asserteq(0, sandbox_gpio_get_value(gpio_a, 4));
+	ut_asserteq(1, sandbox_gpio_get_value(gpio_b, 5));
+	ut_assertok(dm_gpios_get_values(desc_list, 3, &values));
+	ut_asserteq(5, values);
+
+	/* Active low inverts the value, as with dm_gpio_set_value() */
+	desc_list[1].flags |= GPIOD_ACTIVE_LOW;
+	ut_assertok(dm_gpios_set_values(desc_list, 3, 7));
+	ut_asserteq(1, sandbox_gpio_get_value(gpio_a, 1));
+	ut_asserteq(0, sandbox_gpio_get_value(gpio_a, 4));
+	ut_asserteq(1, sandbox_gpio_get_value(gpio_b, 5));
+	ut_assertok(dm_gpios_get_values(desc_list, 3, &values));
+	ut_asserteq(7, values);
+	ut_asserteq(7, dm_gpio_get_values_as_int(desc_list, 3));
+
+	ut_asserteq(-EINVAL, dm_gpios_get_values(desc_list, BITS_PER_LONG + 1,
+						 &values));
+	ut_assertok(gpio_free_list(dev, desc_list, 3));
+	ut_asserteq(-EBUSY, dm_gpios_set_values(desc_list, 3, 0));
+
+	return 0;
+}
+DM_TEST(dm_test_gpio_bulk, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
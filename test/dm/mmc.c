@@ -41,3 +41,82 @@ static int dm_test_mmc_blk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_mmc_blk, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(MMC_TUNING_HANDOFF)
+/* Set up a card which differs from the others only by its CID */
+static void mmc_tuning_card(struct mmc *mmc, u32 cid)
+{
+	memset(mmc, '\0', sizeof(*mmc));
+	mmc->cid[0] = cid;
+	mmc->host_caps = MMC_MODE_HS200 | MMC_MODE_8BIT;
+}
+
+/* Nothing can be recorded without a bloblist */
+static int mmc_tuning_no_bloblist(struct unit_test_state *uts)
+{
+	const u32 data[MMC_TUNING_WORDS] = {12};
+	struct mmc mmc;
+
+	mmc_tuning_card(&mmc, 1);
+	ut_asserteq(-ENOENT, mmc_tuning_put(&mmc, MMC_HS_200, 2, data));
+	ut_assertnull(mmc_tuning_find(&mmc));
+
+	return 0;
+}
+
+static int mmc_tuning_records(struct unit_test_state *uts)
+{
+	const u32 data[MMC_TUNING_WORDS] = {12};
+	struct mmc mmc, mmc2, mmc3;
+	struct mmc_tuning_rec *rec;
+
+	mmc_tuning_card(&mmc, 1);
+	mmc_tuning_card(&mmc2, 2);
+	mmc_tuning_card(&mmc3, 3);
+
+	ut_assertnull(mmc_tuning_find(&mmc));
+	ut_assertok(mmc_tuning_put(&mmc, MMC_HS_200, 2, data));
+	rec = mmc_tuning_find(&mmc);
+	ut_assertnonnull(rec);
+	ut_asserteq(MMC_HS_200, rec->mode);
+	ut_asserteq(2, rec->ext_csd_bits);
+	ut_asserteq(MMC_TUNINGF_DATA, rec->flags);
+	ut_asserteq(12, rec->data[0]);
+
+	/* The record is not used for another card or other host caps */
+	ut_assertnull(mmc_tuning_find(&mmc2));
+	mmc.host_caps |= MMC_MODE_HS400;
+	ut_assertnull(mmc_tuning_find(&mmc));
+
+	/* Recording the card again replaces its record */
+	ut_assertok(mmc_tuning_put(&mmc, MMC_DDR_52, 6, NULL));
+	rec = mmc_tuning_find(&mmc);
+	ut_assertnonnull(rec);
+	ut_asserteq(MMC_DDR_52, rec->mode);
+	ut_asserteq(0, rec->flags);
+
+	/* There is only room for MMC_TUNING_MAX cards */
+	ut_asserteq(2, MMC_TUNING_MAX);
+	ut_assertok(mmc_tuning_put(&mmc2, MMC_HS_200, 2, data));
+	ut_asserteq(-ENOSPC, mmc_tuning_put(&mmc3, MMC_HS_200, 2, data));
+
+	/* Dropping a record keeps the others, and makes room */
+	mmc_tuning_drop(&mmc);
+	ut_assertnull(mmc_tuning_find(&mmc));
+	ut_assertnonnull(mmc_tuning_find(&mmc2));
+	ut_assertok(mmc_tuning_put(&mmc3, MMC_HS_200, 2, data));
+	ut_assertnonnull(mmc_tuning_find(&mmc3));
+
+	return 0;
+}
+
+/* Test the records of the selected mode passed between boot phases */
+static int dm_test_mmc_tuning_handoff(struct unit_test_state *uts)
+{
+	ut_assertok(dm_test_with_bloblist(uts, 0, mmc_tuning_no_bloblist));
+	ut_assertok(dm_test_with_bloblist(uts, 0x400, mmc_tuning_records));
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_tuning_handoff, 0);
+#endif
@@ -58,3 +58,34 @@ static int dm_test_ofnode_fmap(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_ofnode_fmap, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+static int dm_test_ofnode_get_by_phandle(struct unit_test_state *uts)
+{
+	struct ofnode_phandle_args args;
+	ofnode node, gpio_a, gpio_b;
+
+	node = ofnode_path("/a-test");
+	gpio_a = ofnode_path("/base-gpios");
+	gpio_b = ofnode_path("/extra-gpios");
+	ut_assert(ofnode_valid(node));
+	ut_assert(ofnode_valid(gpio_a));
+	ut_assert(ofnode_valid(gpio_b));
+
+	/* Repeated lookups must give the same answer as the first */
+	ut_assert(ofnode_equal(gpio_a, ofnode_path("/base-gpios")));
+	ut_assert(!ofnode_valid(ofnode_path("/no-such-node")));
+	ut_assert(!ofnode_valid(ofnode_path("/no-such-node")));
+
+	ut_assertok(ofnode_parse_phandle_with_args(node, "test-gpios",
+						   "#gpio-cells", 0, 0,
+						   &args));
+	ut_assert(ofnode_equal(gpio_a, args.node));
+	ut_assertok(ofnode_parse_phandle_with_args(node, "test-gpios",
+						   "#gpio-cells", 0, 2,
+						   &args));
+	ut_assert(ofnode_equal(gpio_b, args.node));
+	ut_assert(!ofnode_valid(ofnode_get_by_phandle(0xfffff)));
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_get_by_phandle, DM_TESTF_SCAN_FDT);
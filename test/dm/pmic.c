@@ -16,6 +16,7 @@
 #include <dm/util.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
+#include <i2c.h>
 #include <power/pmic.h>
 #include <power/sandbox_pmic.h>
 #include <test/ut.h>
@@ -128,3 +129,97 @@ static int dm_test_power_pmic_mc34708_rw_val(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_power_pmic_mc34708_rw_val, DM_TESTF_SCAN_FDT);
+
+/* Check a register as seen by the device, bypassing the PMIC cache */
+static int pmic_check_hw(struct unit_test_state *uts, struct udevice *dev,
+			 uint reg, u8 expect)
+{
+	u8 val;
+
+	ut_assertok(dm_i2c_read(dev, reg, &val, 1));
+	ut_asserteq(expect, val);
+
+	return 0;
+}
+
+/* Test the PMIC register cache and batched writes */
+static int dm_test_power_pmic_cache(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	u8 val, buf[2];
+
+	ut_assertok(pmic_get("sandbox_pmic", &dev));
+
+	/* Writes go to the device, later reads come from the cache */
+	ut_assertok(pmic_reg_write(dev, 12, 0x12));
+	ut_assertok(pmic_check_hw(uts, dev, 12, 0x12));
+	val = 0x34;
+	ut_assertok(dm_i2c_write(dev, 12, &val, 1));
+	ut_asserteq(0x12, pmic_reg_read(dev, 12));
+	pmic_cache_invalidate(dev);
+	ut_asserteq(0x34, pmic_reg_read(dev, 12));
+
+	/* Volatile registers are always read from the device */
+	ut_assertok(pmic_reg_write(dev, 15, 0x56));
+	val = 0x78;
+	ut_assertok(dm_i2c_write(dev, 15, &val, 1));
+	ut_asserteq(0x78, pmic_reg_read(dev, 15));
+
+	/* Batched writes are held back until the batch ends */
+	ut_assertok(pmic_batch_start(dev));
+	ut_assertok(pmic_batch_start(dev));
+	ut_assertok(pmic_clrsetbits(dev, 12, 0xf0, 0xa0));
+	ut_assertok(pmic_reg_write(dev, 13, 0x9a));
+	ut_asserteq(0xa4, pmic_reg_read(dev, 12));
+	ut_assertok(pmic_read(dev, 12, buf, 2));
+	ut_asserteq(0xa4, buf[0]);
+	ut_asserteq(0x9a, buf[1]);
+	ut_assertok(pmic_check_hw(uts, dev, 12, 0x34));
+	ut_assertok(pmic_batch_end(dev));
+	ut_assertok(pmic_check_hw(uts, dev, 12, 0x34));
+
+	/* A volatile write sends the held-back writes first */
+	ut_assertok(pmic_reg_write(dev, 15, 0xbc));
+	ut_assertok(pmic_check_hw(uts, dev, 12, 0xa4));
+	ut_assertok(pmic_check_hw(uts, dev, 13, 0x9a));
+	ut_assertok(pmic_check_hw(uts, dev, 15, 0xbc));
+
+	ut_assertok(pmic_reg_write(dev, 14, 0xde));
+	ut_assertok(pmic_batch_end(dev));
+	ut_assertok(pmic_check_hw(uts, dev, 14, 0xde));
+	ut_asserteq(-EINVAL, pmic_batch_end(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_power_pmic_cache, DM_TESTF_SCAN_FDT);
+
+/* Test accesses which include both cached and volatile registers */
+static int dm_test_power_pmic_cache_volatile(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	u8 buf[2];
+
+	ut_assertok(pmic_get("sandbox_pmic", &dev));
+
+	/* A write across a volatile register updates the cached ones */
+	ut_assertok(pmic_reg_write(dev, 14, 0x11));
+	buf[0] = 0x22;
+	buf[1] = 0x33;
+	ut_assertok(pmic_write(dev, 14, buf, 2));
+	ut_assertok(pmic_check_hw(uts, dev, 14, 0x22));
+	ut_assertok(pmic_check_hw(uts, dev, 15, 0x33));
+	ut_asserteq(0x22, pmic_reg_read(dev, 14));
+
+	/* A read across a volatile register sees held-back writes */
+	ut_assertok(pmic_batch_start(dev));
+	ut_assertok(pmic_reg_write(dev, 14, 0x44));
+	ut_assertok(pmic_read(dev, 14, buf, 2));
+	ut_asserteq(0x44, buf[0]);
+	ut_asserteq(0x33, buf[1]);
+	ut_assertok(pmic_check_hw(uts, dev, 14, 0x22));
+	ut_assertok(pmic_batch_end(dev));
+	ut_assertok(pmic_check_hw(uts, dev, 14, 0x44));
+
+	return 0;
+}
+DM_TEST(dm_test_power_pmic_cache_volatile, DM_TESTF_SCAN_FDT);
@@ -6,6 +6,9 @@
 #include <common.h>
 #include <serial.h>
 #include <dm.h>
+#include <hexdump.h>
+#include <stdio_dev.h>
+#include <asm/test.h>
 #include <dm/test.h>
 #include <test/ut.h>
 
@@ -64,3 +67,32 @@ static int dm_test_serial(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_serial, DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+static int dm_test_serial_tx_buffer(struct unit_test_state *uts)
+{
+	struct serial_dev_priv *upriv;
+	struct stdio_dev *sdev;
+	struct udevice *dev;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_SERIAL, "serial", &dev));
+	upriv = dev_get_uclass_priv(dev);
+	ut_assertnonnull(upriv->tx_buf);
+	sdev = upriv->sdev;
+
+	/* Output is queued while the UART is busy, newlines translated */
+	sandbox_serial_set_tx_busy(dev, true);
+	sdev->puts(sdev, "tx\n");
+	ut_asserteq(4, upriv->tx_wr_ptr - upriv->tx_rd_ptr);
+	ut_asserteq_mem("tx\r\n", upriv->tx_buf + upriv->tx_rd_ptr, 4);
+
+	/* Checking for input sends whatever the UART will now accept */
+	sandbox_serial_set_tx_busy(dev, false);
+	sdev->tstc(sdev);
+	ut_asserteq(upriv->tx_wr_ptr, upriv->tx_rd_ptr);
+
+	return 0;
+}
+
+DM_TEST(dm_test_serial_tx_buffer, DM_TESTF_SCAN_FDT);
+#endif
@@ -12,6 +12,7 @@
 #include <dm/test.h>
 #include <dm/root.h>
 #include <dm/device-internal.h>
+#include <dm/handoff.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
 #include <dm/lists.h>
@@ -241,6 +242,31 @@ static int dm_test_fdt_pre_reloc(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_fdt_pre_reloc, 0);
 
+/* Number of passes made by dm_test_fdt_bind_repeat() */
+#define BIND_REPEAT_PASSES	20
+
+/*
+ * Test binding the device tree again and again, which looks up drivers by
+ * compatible string each time. Every pass must bind the same devices. See
+ * 'ut perf' for how long binding takes.
+ */
+static int dm_test_fdt_bind_repeat(struct unit_test_state *uts)
+{
+	struct uclass *uc;
+	int i;
+
+	ut_assertok(uclass_get(UCLASS_TEST_FDT, &uc));
+	for (i = 0; i < BIND_REPEAT_PASSES; i++) {
+		ut_assertok(dm_scan_fdt(gd->fdt_blob, false));
+		ut_asserteq(8, list_count_items(&uc->dev_head));
+		ut_assertok(device_chld_unbind(dm_root(), NULL));
+		ut_asserteq(0, list_count_items(&uc->dev_head));
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_bind_repeat, 0);
+
 /* Test that sequence numbers are allocated properly */
 static int dm_test_fdt_uclass_seq(struct unit_test_state *uts)
 {
@@ -326,6 +352,68 @@ static int dm_test_fdt_offset(struct unit_test_state *uts)
 DM_TEST(dm_test_fdt_offset,
 	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT | DM_TESTF_FLAT_TREE);
 
+/* Test that lookups stay correct as devices are renamed, removed and unbound */
+static int dm_test_fdt_uclass_lookup(struct unit_test_state *uts)
+{
+	struct udevice *dev, *found;
+	ofnode node;
+	int seq;
+
+	/* Every probed device can be found by seq, name and node */
+	for (uclass_first_device(UCLASS_TEST_FDT, &dev); dev;
+	     uclass_next_device(&dev)) {
+		ut_assertok(uclass_find_device_by_seq(UCLASS_TEST_FDT,
+						      dev->seq, false, &found));
+		ut_asserteq_ptr(dev, found);
+		ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT,
+							 dev_ofnode(dev),
+							 &found));
+		ut_asserteq_ptr(dev, found);
+		ut_assertok(uclass_find_device_by_name(UCLASS_TEST_FDT,
+						       dev->name, &found));
+		ut_asserteq_str(dev->name, found->name);
+	}
+
+	/* An exact match wins over an earlier device with a longer name */
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST_FDT, "a-test",
+					       &dev));
+	ut_assertok(device_set_name(dev, "b-test-long"));
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST_FDT, "b-test",
+					       &found));
+	ut_asserteq_str("b-test", found->name);
+
+	/* A name prefix still finds a device */
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST_FDT, "e-te", &dev));
+	ut_asserteq_str("e-test", dev->name);
+
+	ut_assertok(device_set_name(dev, "renamed-test"));
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST_FDT, "renamed-test",
+					       &found));
+	ut_asserteq_ptr(dev, found);
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST_FDT,
+							"e-test", &found));
+
+	/* Once removed, the device keeps its node but not its seq */
+	seq = dev->seq;
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST_FDT, seq,
+						       false, &found));
+	node = dev_ofnode(dev);
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT, node,
+						 &found));
+	ut_asserteq_ptr(dev, found);
+
+	ut_assertok(device_unbind(dev));
+	ut_asserteq(-ENODEV, uclass_find_device_by_ofnode(UCLASS_TEST_FDT,
+							  node, &found));
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST_FDT,
+							"renamed-test",
+							&found));
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_uclass_lookup, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 /**
  * Test various error conditions with uclass_first_device() and
  * uclass_next_device()
@@ -771,3 +859,106 @@ static int dm_test_read_int(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_read_int, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(DM_HANDOFF)
+/* Nothing can be saved without a bloblist */
+static int dev_handoff_no_bloblist(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	u32 val = 1234;
+
+	ut_assertok(uclass_get_device(UCLASS_TEST_FDT, 0, &dev));
+	ut_asserteq(-ENOENT, dev_handoff_save(dev, DEV_HANDOFF_TEST, &val,
+					      sizeof(val)));
+	ut_assertnull(dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val)));
+
+	return 0;
+}
+
+static int dev_handoff_records(struct unit_test_state *uts)
+{
+	u8 big[CONFIG_DM_HANDOFF_SIZE];
+	struct udevice *dev, *dev2;
+	const u32 *ptr;
+	u32 val = 1234;
+	u16 val16;
+
+	ut_assertok(uclass_get_device(UCLASS_TEST_FDT, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_TEST_FDT, 1, &dev2));
+
+	ut_assertnull(dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val)));
+	ut_assertok(dev_handoff_save(dev, DEV_HANDOFF_TEST, &val, sizeof(val)));
+	ptr = dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val));
+	ut_assertnonnull(ptr);
+	ut_asserteq(1234, *ptr);
+
+	/* The device, tag and size must all match */
+	ut_assertnull(dev_handoff_find(dev2, DEV_HANDOFF_TEST, sizeof(val)));
+	ut_assertnull(dev_handoff_find(dev, DEV_HANDOFF_NONE, sizeof(val)));
+	ut_assertnull(dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val16)));
+
+	/* Saving again replaces the state */
+	val = 5678;
+	ut_assertok(dev_handoff_save(dev, DEV_HANDOFF_TEST, &val, sizeof(val)));
+	val = 4321;
+	ut_assertok(dev_handoff_save(dev2, DEV_HANDOFF_TEST, &val,
+				     sizeof(val)));
+	ptr = dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val));
+	ut_assertnonnull(ptr);
+	ut_asserteq(5678, *ptr);
+
+	/* Changing the size moves the state but keeps other devices' */
+	val16 = 99;
+	ut_assertok(dev_handoff_save(dev, DEV_HANDOFF_TEST, &val16,
+				     sizeof(val16)));
+	ut_assertnull(dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val)));
+	ut_asserteq(99, *(u16 *)dev_handoff_find(dev, DEV_HANDOFF_TEST,
+						  sizeof(val16)));
+	ptr = dev_handoff_find(dev2, DEV_HANDOFF_TEST, sizeof(val));
+	ut_assertnonnull(ptr);
+	ut_asserteq(4321, *ptr);
+
+	dev_handoff_drop(dev, DEV_HANDOFF_TEST);
+	ut_assertnull(dev_handoff_find(dev, DEV_HANDOFF_TEST, sizeof(val16)));
+	ut_assertnonnull(dev_handoff_find(dev2, DEV_HANDOFF_TEST, sizeof(val)));
+
+	memset(big, '\0', sizeof(big));
+	ut_asserteq(-ENOSPC, dev_handoff_save(dev, DEV_HANDOFF_TEST, big,
+					      sizeof(big)));
+
+	return 0;
+}
+
+/* Test saving device state for a later boot phase */
+static int dm_test_dev_handoff(struct unit_test_state *uts)
+{
+	ut_assertok(dm_test_with_bloblist(uts, 0, dev_handoff_no_bloblist));
+	ut_assertok(dm_test_with_bloblist(uts, 0x400, dev_handoff_records));
+
+	return 0;
+}
+DM_TEST(dm_test_dev_handoff, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
+
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+/* Test probing the devices listed in /chosen/u-boot,dm-preload */
+static int dm_test_probe_preload(struct unit_test_state *uts)
+{
+	struct udevice *dev, *pwrdom;
+
+	ut_assertok(uclass_find_device_by_name(UCLASS_MISC,
+					       "power-domain-test", &dev));
+	ut_assertok(uclass_find_device_by_name(UCLASS_POWER_DOMAIN,
+					       "power-domain", &pwrdom));
+	ut_assert(!device_active(dev));
+	ut_assert(!device_active(pwrdom));
+
+	/* The power domain is probed as well, since the device refers to it */
+	ut_assertok(dm_probe_preload());
+	ut_assert(device_active(dev));
+	ut_assert(device_active(pwrdom));
+
+	return 0;
+}
+DM_TEST(dm_test_probe_preload, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the malloc() slab front-end and statistics
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+/* Index of the 48-byte size class */
+#define TEST_CLASS	2
+
+#define TEST_BIG_SIZE	0x1000
+#define TEST_ALIGN	0x100
+
+/* Test that small allocations come from the slab and are counted */
+static int lib_test_malloc_slab(struct unit_test_state *uts)
+{
+	struct malloc_stats start, stats;
+	char *ptr, *big, *aligned;
+	int i;
+
+	malloc_get_stats(&start);
+	ut_assert(start.slab_size);
+
+	ptr = calloc(1, 40);
+	ut_assertnonnull(ptr);
+	for (i = 0; i < 40; i++)
+		ut_asserteq(0, ptr[i]);
+	malloc_get_stats(&stats);
+	ut_asserteq(48, stats.slab[TEST_CLASS].size);
+	ut_asserteq(start.slab[TEST_CLASS].objs + 1,
+		    stats.slab[TEST_CLASS].objs);
+	ut_asserteq(start.slab_in_use + 48, stats.slab_in_use);
+	ut_asserteq(start.in_use + 48, stats.in_use);
+	ut_asserteq(start.hist[2] + 1, stats.hist[2]);
+
+	/* Growing within the object keeps it, beyond moves it */
+	ut_asserteq_ptr(ptr, realloc(ptr, 48));
+	strcpy(ptr, "slab");
+	ptr = realloc(ptr, 200);
+	ut_assertnonnull(ptr);
+	ut_asserteq_str("slab", ptr);
+	malloc_get_stats(&stats);
+	ut_asserteq(start.slab[TEST_CLASS].objs, stats.slab[TEST_CLASS].objs);
+	ut_asserteq(start.slab_in_use + 256, stats.slab_in_use);
+
+	/* Large and strictly aligned allocations go to dlmalloc */
+	big = malloc(TEST_BIG_SIZE);
+	ut_assertnonnull(big);
+	aligned = memalign(TEST_ALIGN, 32);
+	ut_assertnonnull(aligned);
+	ut_asserteq(0, (ulong)aligned % TEST_ALIGN);
+	malloc_get_stats(&stats);
+	ut_asserteq(start.slab_in_use + 256, stats.slab_in_use);
+	ut_assert(stats.in_use >= start.in_use + 256 + TEST_BIG_SIZE + 32);
+	ut_assert(stats.peak >= stats.in_use);
+	ut_asserteq(start.allocs + 4, stats.allocs);
+
+	free(aligned);
+	free(big);
+	free(ptr);
+	malloc_get_stats(&stats);
+	ut_asserteq(start.in_use, stats.in_use);
+	ut_asserteq(start.slab_in_use, stats.slab_in_use);
+	ut_asserteq(start.frees + 4, stats.frees);
+
+	return 0;
+}
+DM_TEST(lib_test_malloc_slab, 0);
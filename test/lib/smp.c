@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for running jobs on several CPUs
+ */
+
+#include <common.h>
+#include <smp.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+struct smp_test_job {
+	uint calls[CONFIG_SMP_JOBS_MAX_CPUS];
+	uint ncpus[CONFIG_SMP_JOBS_MAX_CPUS];
+};
+
+static void smp_test_fn(void *arg, uint cpu, uint ncpus)
+{
+	struct smp_test_job *job = arg;
+
+	job->calls[cpu]++;
+	job->ncpus[cpu] = ncpus;
+}
+
+static int smp_test_run(struct unit_test_state *uts)
+{
+	struct smp_test_job job;
+	int i;
+
+	memset(&job, '\0', sizeof(job));
+	ut_assertok(smp_run_on_cpus(smp_test_fn, &job));
+	for (i = 0; i < CONFIG_SMP_JOBS_MAX_CPUS; i++) {
+		ut_asserteq(1, job.calls[i]);
+		ut_asserteq(CONFIG_SMP_JOBS_MAX_CPUS, job.ncpus[i]);
+	}
+
+	return 0;
+}
+
+/* Test that each CPU runs a job once, including after parking */
+static int lib_test_smp_run_on_cpus(struct unit_test_state *uts)
+{
+	ut_assertok(smp_test_run(uts));
+	ut_assertok(smp_test_run(uts));
+	smp_park_cpus();
+	ut_assertok(smp_test_run(uts));
+
+	return 0;
+}
+DM_TEST(lib_test_smp_run_on_cpus, 0);
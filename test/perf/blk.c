@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Performance tests for block devices
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <dm.h>
+#include <malloc.h>
+#include <dm/device-internal.h>
+#include <test/perf.h>
+#include <test/ut.h>
+
+/* Most blocks to read in each pass, few enough to fit in the block cache */
+#define PERF_BLK_BLOCKS	16
+
+/* Number of passes over the blocks */
+#define PERF_BLK_PASSES	32
+
+/*
+ * Time single-block reads from the sandbox MMC device, both with the block
+ * cache dropped before each pass and with the blocks already in the cache
+ */
+static int perf_test_blk_read(struct unit_test_state *uts)
+{
+#if CONFIG_IS_ENABLED(BLOCK_CACHE)
+	struct block_cache_stats stats;
+#endif
+	struct udevice *dev, *blk;
+	struct blk_desc *desc;
+	ulong start;
+	char *buf;
+	int count, i, j;
+
+	ut_assertok(uclass_get_device_by_seq(UCLASS_MMC, 0, &dev));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_platdata(blk);
+	count = min_t(lbaint_t, desc->lba, PERF_BLK_BLOCKS);
+	ut_assert(count > 0);
+	buf = malloc(desc->blksz);
+	ut_assertnonnull(buf);
+
+	start = timer_get_us();
+	for (j = 0; j < PERF_BLK_PASSES; j++) {
+		blkcache_invalidate(desc->if_type, desc->devnum);
+		for (i = 0; i < count; i++)
+			ut_asserteq(1, blk_dread(desc, i, 1, buf));
+	}
+	ut_assertok(perf_check("blk_read", timer_get_us() - start,
+			       PERF_BLK_PASSES * count));
+
+#if CONFIG_IS_ENABLED(BLOCK_CACHE)
+	blkcache_stats(&stats);
+#endif
+	start = timer_get_us();
+	for (j = 0; j < PERF_BLK_PASSES; j++) {
+		for (i = 0; i < count; i++)
+			ut_asserteq(1, blk_dread(desc, i, 1, buf));
+	}
+	ut_assertok(perf_check("blk_read_cached", timer_get_us() - start,
+			       PERF_BLK_PASSES * count));
+#if CONFIG_IS_ENABLED(BLOCK_CACHE)
+	blkcache_stats(&stats);
+	ut_asserteq(PERF_BLK_PASSES * count, stats.hits);
+#endif
+	free(buf);
+
+	return 0;
+}
+PERF_TEST(perf_test_blk_read, 0);
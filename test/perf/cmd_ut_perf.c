@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Performance tests, with regression checks against stored baselines
+ */
+
+#include <common.h>
+#include <command.h>
+#include <linux/math64.h>
+#include <test/perf.h>
+#include <test/suites.h>
+#include <test/ut.h>
+
+int perf_check(const char *name, ulong us, uint count)
+{
+	ulong ns, base, limit;
+	char var[40];
+
+	ns = count ? div_u64((u64)us * 1000, count) : 0;
+	printf("   %-16s %8u ops %10lu us %8lu ns/op", name, count, us, ns);
+	snprintf(var, sizeof(var), "perf_%s", name);
+	if (env_get_yesno("perf_record") == 1) {
+		printf(", recorded\n");
+		return env_set_ulong(var, ns);
+	}
+
+	base = env_get_ulong(var, 10, 0);
+	if (!base) {
+		printf("\n");
+		return 0;
+	}
+	limit = base * (100 + CONFIG_UT_PERF_MARGIN) / 100;
+	printf(", baseline %lu ns/op\n", base);
+	if (ns > limit) {
+		printf("%s: %lu ns/op is more than %d%% above the baseline\n",
+		       name, ns, CONFIG_UT_PERF_MARGIN);
+		return -ETIME;
+	}
+
+	return 0;
+}
+
+int do_ut_perf(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	struct unit_test *tests = ll_entry_start(struct unit_test, perf_test);
+	const int n_ents = ll_entry_count(struct unit_test, perf_test);
+
+	return cmd_ut_category("performance", tests, n_ents, argc, argv);
+}
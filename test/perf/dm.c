@@ -0,0 +1,314 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Performance tests for driver model
+ *
+ * Each test builds a flat device tree with many devices and runs driver
+ * model on it in place of the control device tree, so that lookups which
+ * walk lists or the tree show up in the timings.
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <fdtdec.h>
+#include <malloc.h>
+#include <dm/device-internal.h>
+#include <dm/root.h>
+#include <dm/uclass-internal.h>
+#include <linux/sizes.h>
+#include <test/perf.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of devices in the generated device tree */
+#define PERF_DEVICES	512
+
+/* Number of times to read each property */
+#define PERF_READS	16
+
+#define PERF_FDT_SIZE	SZ_256K
+
+/**
+ * struct perf_dm - State of a driver model performance test
+ *
+ * @blob:	Generated device tree
+ * @nodes:	Offset of each device's node in @blob
+ * @fdt_blob:	Control device tree, to put back afterwards
+ * @of_root:	Live tree, to put back afterwards
+ * @dm_root:	Root device, to put back afterwards
+ * @uclass_root: List of uclasses, to put back afterwards
+ */
+struct perf_dm {
+	void *blob;
+	int nodes[PERF_DEVICES];
+	const void *fdt_blob;
+	struct device_node *of_root;
+	struct udevice *dm_root;
+	struct list_head uclass_root;
+};
+
+struct perf_test_plat {
+	u32 value;
+};
+
+static int perf_test_ofdata_to_platdata(struct udevice *dev)
+{
+	struct perf_test_plat *plat = dev_get_platdata(dev);
+
+	plat->value = dev_read_u32_default(dev, "perf-value", 0);
+
+	return 0;
+}
+
+static const struct udevice_id perf_test_ids[] = {
+	{ .compatible = "sandbox,perf-test" },
+	{ }
+};
+
+U_BOOT_DRIVER(perf_test_drv) = {
+	.name	= "perf_test_drv",
+	.id	= UCLASS_TEST_DUMMY,
+	.of_match = perf_test_ids,
+	.ofdata_to_platdata = perf_test_ofdata_to_platdata,
+	.platdata_auto_alloc_size = sizeof(struct perf_test_plat),
+};
+
+/*
+ * Create a device tree with PERF_DEVICES devices, each with an alias so that
+ * it gets a sequence number
+ */
+static int perf_make_tree(void *blob)
+{
+	char name[32], path[32];
+	int ret, i;
+
+	ret = fdt_create(blob, PERF_FDT_SIZE);
+	ret |= fdt_finish_reservemap(blob);
+	ret |= fdt_begin_node(blob, "");
+	ret |= fdt_property_u32(blob, "#address-cells", 1);
+	ret |= fdt_property_u32(blob, "#size-cells", 0);
+
+	ret |= fdt_begin_node(blob, "aliases");
+	for (i = 0; i < PERF_DEVICES; i++) {
+		snprintf(name, sizeof(name), "fdt-dummy%d", i);
+		snprintf(path, sizeof(path), "/perf-test@%x", i);
+		ret |= fdt_property_string(blob, name, path);
+	}
+	ret |= fdt_end_node(blob);
+
+	for (i = 0; i < PERF_DEVICES; i++) {
+		snprintf(name, sizeof(name), "perf-test@%x", i);
+		ret |= fdt_begin_node(blob, name);
+		ret |= fdt_property_string(blob, "compatible",
+					   "sandbox,perf-test");
+		ret |= fdt_property_u32(blob, "reg", i);
+		ret |= fdt_property_u32(blob, "perf-value", i);
+		ret |= fdt_end_node(blob);
+	}
+
+	ret |= fdt_end_node(blob);
+	ret |= fdt_finish(blob);
+
+	return ret ? -ENOSPC : 0;
+}
+
+/* Build the device tree and find the device nodes in it */
+static int perf_dm_start(struct unit_test_state *uts, struct perf_dm *pdm)
+{
+	int node, i;
+
+	pdm->blob = malloc(PERF_FDT_SIZE);
+	ut_assertnonnull(pdm->blob);
+	ut_assertok(perf_make_tree(pdm->blob));
+
+	i = 0;
+	fdt_for_each_subnode(node, pdm->blob, 0) {
+		if (!fdt_node_check_compatible(pdm->blob, node,
+					       "sandbox,perf-test"))
+			pdm->nodes[i++] = node;
+	}
+	ut_asserteq(PERF_DEVICES, i);
+
+	return 0;
+}
+
+/* Switch driver model over to the generated device tree */
+static int perf_dm_switch(struct perf_dm *pdm)
+{
+	pdm->fdt_blob = gd->fdt_blob;
+	pdm->dm_root = gd->dm_root;
+	/* Move the uclasses across, so their list links point to the copy */
+	INIT_LIST_HEAD(&pdm->uclass_root);
+	list_splice_init(&gd->uclass_root, &pdm->uclass_root);
+#ifdef CONFIG_OF_LIVE
+	pdm->of_root = gd->of_root;
+	gd->of_root = NULL;
+#endif
+	gd->fdt_blob = pdm->blob;
+	gd->dm_root = NULL;
+
+	return dm_init(false);
+}
+
+/*
+ * Remove the devices from the generated device tree and put back the
+ * original ones. These are left as they were, probed or not.
+ */
+static void perf_dm_finish(struct perf_dm *pdm)
+{
+	struct uclass *uc, *next;
+
+	if (gd->dm_root)
+		dm_uninit();
+	list_for_each_entry_safe(uc, next, &gd->uclass_root, sibling_node)
+		uclass_destroy(uc);
+
+	gd->fdt_blob = pdm->fdt_blob;
+	gd->dm_root = pdm->dm_root;
+	list_splice_init(&pdm->uclass_root, &gd->uclass_root);
+#ifdef CONFIG_OF_LIVE
+	gd->of_root = pdm->of_root;
+#endif
+}
+
+/* Bind, and optionally probe, all devices in the generated tree */
+static int perf_dm_bind(struct unit_test_state *uts, bool probe)
+{
+	struct udevice *dev;
+	int count;
+
+	ut_assertok(dm_scan_fdt(gd->fdt_blob, false));
+	if (!probe)
+		return 0;
+
+	count = 0;
+	for (uclass_first_device(UCLASS_TEST_DUMMY, &dev); dev;
+	     uclass_next_device(&dev))
+		count++;
+	ut_asserteq(PERF_DEVICES, count);
+
+	return 0;
+}
+
+/*
+ * Run a test against the generated device tree. The original driver model
+ * state is put back however the test ends.
+ */
+static int perf_dm_run(struct unit_test_state *uts,
+		       int (*func)(struct unit_test_state *uts,
+				   struct perf_dm *pdm))
+{
+	struct perf_dm *pdm;
+	int ret;
+
+	pdm = calloc(1, sizeof(*pdm));
+	ut_assertnonnull(pdm);
+	ret = perf_dm_start(uts, pdm);
+	if (!ret) {
+		ret = perf_dm_switch(pdm);
+		if (!ret)
+			ret = func(uts, pdm);
+		perf_dm_finish(pdm);
+	}
+	free(pdm->blob);
+	free(pdm);
+
+	return ret;
+}
+
+/* Time binding the devices, then probing them */
+static int perf_dm_bind_probe(struct unit_test_state *uts,
+			      struct perf_dm *pdm)
+{
+	struct udevice *dev;
+	struct uclass *uc;
+	ulong start;
+	int count;
+
+	start = timer_get_us();
+	ut_assertok(perf_dm_bind(uts, false));
+	ut_assertok(perf_check("bind", timer_get_us() - start, PERF_DEVICES));
+
+	ut_assertok(uclass_get(UCLASS_TEST_DUMMY, &uc));
+	count = 0;
+	start = timer_get_us();
+	uclass_foreach_dev(dev, uc) {
+		ut_assertok(device_probe(dev));
+		count++;
+	}
+	ut_assertok(perf_check("probe", timer_get_us() - start, count));
+	ut_asserteq(PERF_DEVICES, count);
+
+	return 0;
+}
+
+static int perf_test_bind_probe(struct unit_test_state *uts)
+{
+	return perf_dm_run(uts, perf_dm_bind_probe);
+}
+PERF_TEST(perf_test_bind_probe, 0);
+
+/* Time looking up every device by sequence number and by device tree node */
+static int perf_dm_lookup(struct unit_test_state *uts, struct perf_dm *pdm)
+{
+	struct udevice *dev;
+	ulong start;
+	int i;
+
+	ut_assertok(perf_dm_bind(uts, true));
+
+	start = timer_get_us();
+	for (i = 0; i < PERF_DEVICES; i++) {
+		ut_assertok(uclass_get_device_by_seq(UCLASS_TEST_DUMMY, i,
+						     &dev));
+	}
+	ut_assertok(perf_check("uclass_seq", timer_get_us() - start,
+			       PERF_DEVICES));
+	ut_asserteq(pdm->nodes[PERF_DEVICES - 1], dev_of_offset(dev));
+
+	start = timer_get_us();
+	for (i = 0; i < PERF_DEVICES; i++) {
+		ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_DUMMY,
+				offset_to_ofnode(pdm->nodes[i]), &dev));
+	}
+	ut_assertok(perf_check("uclass_ofnode", timer_get_us() - start,
+			       PERF_DEVICES));
+	ut_asserteq(pdm->nodes[PERF_DEVICES - 1], dev_of_offset(dev));
+
+	return 0;
+}
+
+static int perf_test_lookup(struct unit_test_state *uts)
+{
+	return perf_dm_run(uts, perf_dm_lookup);
+}
+PERF_TEST(perf_test_lookup, 0);
+
+/* Time reading a property from every node */
+static int perf_dm_ofnode_read(struct unit_test_state *uts,
+			       struct perf_dm *pdm)
+{
+	ulong start;
+	u32 val;
+	int i, j;
+
+	start = timer_get_us();
+	for (j = 0; j < PERF_READS; j++) {
+		for (i = 0; i < PERF_DEVICES; i++) {
+			ut_assertok(ofnode_read_u32(
+					offset_to_ofnode(pdm->nodes[i]),
+					"perf-value", &val));
+		}
+	}
+	ut_assertok(perf_check("ofnode_read", timer_get_us() - start,
+			       PERF_READS * PERF_DEVICES));
+	ut_asserteq(PERF_DEVICES - 1, val);
+
+	return 0;
+}
+
+static int perf_test_ofnode_read(struct unit_test_state *uts)
+{
+	return perf_dm_run(uts, perf_dm_ofnode_read);
+}
+PERF_TEST(perf_test_ofnode_read, 0);
@@ -13,7 +13,11 @@ static data.
 
 import collections
 import copy
+import os
+import re
+import struct
 import sys
+import zlib
 
 import fdt
 import fdt_util
@@ -44,6 +48,27 @@ TYPE_NAMES = {
 STRUCT_PREFIX = 'dtd_'
 VAL_PREFIX = 'dtv_'
 
+# Node names which are not devices but may contain some (see root.c)
+CONTAINER_NODES = ['chosen', 'firmware']
+
+# Properties which mark a node for binding before relocation (see util.c)
+PRE_RELOC_PROPS = ['u-boot,dm-pre-reloc', 'u-boot,dm-spl', 'u-boot,dm-tpl']
+
+# Directories in the source tree which do not hold any drivers
+SCAN_SKIP_DIRS = ['doc', 'scripts', 'tools']
+
+# Maximum number of address cells which U-Boot can translate
+MAX_ADDR_CELLS = 4
+
+# Regular expressions for finding drivers and their compatible strings
+RE_OF_MATCH = re.compile(r'struct\s+udevice_id\s+(\w+)\s*\[\s*\]\s*=\s*'
+                         r'\{(.*?)\};', re.S)
+RE_COMPAT = re.compile(r'\.compatible\s*=\s*"([^"]*)"')
+RE_DRIVER = re.compile(r'U_BOOT_DRIVER\s*\(\s*(\w+)\s*\)\s*=\s*\{(.*?)\n\};',
+                       re.S)
+RE_DRIVER_OF_MATCH = re.compile(
+        r'\.of_match\s*=\s*(?:of_match_ptr\s*\(\s*)?(\w+)')
+
 # This holds information about a property which includes phandles.
 #
 # max_args: integer: Maximum number or arguments that any phandle uses (int).
@@ -125,6 +150,136 @@ def get_compat_name(node):
     return conv_name_to_c(compat), [conv_name_to_c(a) for a in aliases]
 
 
+def scan_driver_source(data, compat_drivers):
+    """Find the drivers in a C source file and the strings they match
+
+    Only of_match tables defined in the same file as the driver are found.
+
+    Args:
+        data: Contents of the source file
+        compat_drivers: Dict to update:
+            key: Compatible string
+            value: Set of names of drivers which match it
+    """
+    if 'U_BOOT_DRIVER' not in data:
+        return
+    of_match = {}
+    for match in RE_OF_MATCH.finditer(data):
+        of_match[match.group(1)] = RE_COMPAT.findall(match.group(2))
+    for match in RE_DRIVER.finditer(data):
+        ref = RE_DRIVER_OF_MATCH.search(match.group(2))
+        if not ref or ref.group(1) not in of_match:
+            continue
+        for compat in of_match[ref.group(1)]:
+            compat_drivers.setdefault(compat, set()).add(match.group(1))
+
+def scan_drivers(srcdir):
+    """Scan the U-Boot source tree for drivers
+
+    Args:
+        srcdir: Top of the source tree
+    Returns:
+        Dict:
+            key: Compatible string
+            value: List of names of drivers which match it, in linker-list
+                (i.e. name) order
+    """
+    compat_drivers = {}
+    for dirpath, dirnames, fnames in os.walk(srcdir):
+        if dirpath == srcdir:
+            dirnames[:] = [d for d in dirnames if d not in SCAN_SKIP_DIRS]
+        dirnames[:] = [d for d in dirnames if not d.startswith('.')]
+        for fname in fnames:
+            if not fname.endswith('.c'):
+                continue
+            with open(os.path.join(dirpath, fname)) as infile:
+                scan_driver_source(infile.read(), compat_drivers)
+    return dict((compat, sorted(drivers))
+                for compat, drivers in compat_drivers.items())
+
+def get_cells(prop):
+    """Get the value of a property as a list of integer cells
+
+    Args:
+        prop: Prop object
+    Returns:
+        List of integers
+    """
+    return list(struct.unpack('>%dI' % (len(prop.bytes) // 4),
+                              prop.bytes[:len(prop.bytes) // 4 * 4]))
+
+def cells_to_int(cells):
+    """Convert a list of cells to an integer as fdt_read_number() does"""
+    val = 0
+    for cell in cells:
+        val = ((val << 32) | cell) & 0xffffffffffffffff
+    return val
+
+def get_bus_cells(node):
+    """Get the address and size cells of a bus node, as the C code does
+
+    Args:
+        node: Node to check
+    Returns:
+        Tuple: (number of address cells, number of size cells), defaulting
+            to 2 and 1 as fdt_support_default_count_cells() does
+    """
+    na_prop = node.props.get('#address-cells')
+    ns_prop = node.props.get('#size-cells')
+    na = get_cells(na_prop)[0] if na_prop else 2
+    ns = get_cells(ns_prop)[0] if ns_prop else 1
+    return na, ns
+
+def translate_reg(node):
+    """Translate a node's first 'reg' address into a CPU address
+
+    This does the same as fdt_translate_address() for the default bus type.
+
+    Args:
+        node: Node to check
+    Returns:
+        CPU address, or None if the node has no 'reg' property or the address
+        cannot be translated here
+    """
+    reg = node.props.get('reg')
+    bus = node.parent
+    if not reg or not bus:
+        return None
+    na, ns = get_bus_cells(bus)
+    cells = get_cells(reg)
+    if not 0 < na <= MAX_ADDR_CELLS or ns <= 0 or len(cells) < na + ns:
+        return None
+    # Leave ISA buses, which have their own translation, to the C code
+    parent = bus
+    while parent:
+        if parent.name == 'isa':
+            return None
+        parent = parent.parent
+    addr = cells_to_int(cells[:na])
+    while bus.parent:
+        pna, pns = get_bus_cells(bus.parent)
+        if not 0 < pna <= MAX_ADDR_CELLS or pns <= 0:
+            return None
+        ranges = bus.props.get('ranges')
+        rcells = get_cells(ranges) if ranges else []
+        if rcells:
+            rone = na + pna + ns
+            for pos in range(0, len(rcells) - rone + 1, rone):
+                child = cells_to_int(rcells[pos:pos + na])
+                size = cells_to_int(rcells[pos + na + pna:pos + rone])
+                if child <= addr < child + size:
+                    addr = (cells_to_int(rcells[pos + na:pos + na + pna]) +
+                            addr - child)
+                    break
+            else:
+                return None
+        if pna == 1:
+            addr &= 0xffffffff
+        addr &= 0xffffffffffffffff
+        na, ns, bus = pna, pns, bus.parent
+    return addr
+
+
 class DtbPlatdata(object):
     """Provide a means to convert device tree binary data to platform data
 
@@ -545,8 +700,121 @@ class DtbPlatdata(object):
             self.output_node(node)
             nodes_to_output.remove(node)
 
+    def get_node_list(self, node, nodes):
+        """Add a node and all its subnodes to a list, in device-tree order
 
-def run_steps(args, dtb_file, include_disabled, output):
+        Args:
+            node: Node to add
+            nodes: List to add to
+        """
+        nodes.append(node)
+        for subnode in node.subnodes:
+            self.get_node_list(subnode, nodes)
+
+    def generate_bind(self, compat_drivers):
+        """Generate a table for binding devices without scanning the tree
+
+        This writes out a struct dm_bind_table listing every node in the
+        device tree with its offset, subnodes, translated address and the
+        drivers which match its compatible strings, along with a phandle
+        table. See include/dm/bind-table.h for the format.
+
+        Args:
+            compat_drivers: Drivers for each compatible string, as returned
+                by scan_drivers()
+        """
+        nodes = []
+        self.get_node_list(self._fdt.GetRoot(), nodes)
+        index = dict((node, i) for i, node in enumerate(nodes))
+        drivers = []
+        node_lines = []
+        for node in nodes:
+            flags = []
+            if any(prop in node.props for prop in PRE_RELOC_PROPS):
+                flags.append('DM_BIND_PRE_RELOC')
+            status = node.props.get('status')
+            if status and status.value != 'okay':
+                flags.append('DM_BIND_DISABLED')
+            if node.name in CONTAINER_NODES:
+                flags.append('DM_BIND_CONTAINER')
+
+            first_driver = len(drivers)
+            compat = node.props.get('compatible')
+            if compat:
+                compats = compat.value
+                if not isinstance(compats, list):
+                    compats = [compats]
+                for compat_idx, compat_str in enumerate(compats):
+                    for drv in compat_drivers.get(compat_str, []):
+                        drivers.append((drv, compat_str, compat_idx))
+            if len(drivers) - first_driver > 0xff or len(drivers) > 0xffff:
+                raise ValueError("Node '%s' has too many drivers" % node.path)
+
+            next_sibling = -1
+            if node.parent:
+                siblings = node.parent.subnodes
+                pos = siblings.index(node) + 1
+                if pos < len(siblings):
+                    next_sibling = index[siblings[pos]]
+            addr = translate_reg(node)
+            node_lines.append('\t/* %d: %s */\n' % (index[node], node.path))
+            node_lines.append('\t{%#x, %s, %d, %d, %d, %d, %s},\n' %
+                              (node.Offset(),
+                               'FDT_ADDR_T_NONE' if addr is None else
+                               '(fdt_addr_t)%#x' % addr,
+                               index[node.subnodes[0]] if node.subnodes
+                               else -1, next_sibling, first_driver,
+                               len(drivers) - first_driver,
+                               ' | '.join(flags) or '0'))
+
+        self.out_header()
+        self.out('#include <common.h>\n')
+        self.out('#include <dm.h>\n')
+        self.out('#include <dm/bind-table.h>\n')
+        self.out('\n')
+        for drv in sorted(set(drv for drv, _, _ in drivers)):
+            self.out('DM_BIND_DRIVER_DECL(%s);\n' % drv)
+        if drivers:
+            self.out('\n')
+
+        self.out('static const struct dm_bind_driver dm_bind_drivers[] = {\n')
+        for drv, compat_str, compat_idx in drivers:
+            self.out('\t{DM_BIND_DRIVER(%s), "%s", %d},\n' %
+                     (drv, compat_str, compat_idx))
+        self.out('};\n\n')
+
+        self.out('static const struct dm_bind_node dm_bind_nodes[] = {\n')
+        self.out(''.join(node_lines))
+        self.out('};\n\n')
+
+        self.out('static const struct dm_bind_phandle dm_bind_phandles[] = {\n')
+        for phandle in sorted(self._fdt.phandle_to_node):
+            self.out('\t{%#x, %#x},\n' %
+                     (phandle, self._fdt.phandle_to_node[phandle].Offset()))
+        self.out('};\n\n')
+
+        fdt_obj = self._fdt.GetFdtObj()
+        data = fdt_obj.as_bytearray()
+        struct_start = fdt_obj.off_dt_struct()
+        strings_start = fdt_obj.off_dt_strings()
+        crc = zlib.crc32(data[struct_start:
+                              struct_start + fdt_obj.size_dt_struct()])
+        crc = zlib.crc32(data[strings_start:
+                              strings_start + fdt_obj.size_dt_strings()], crc)
+        self.out('const struct dm_bind_table dm_bind_table = {\n')
+        self.out('\t.fdt_size\t= %#x,\n' % fdt_obj.totalsize())
+        self.out('\t.struct_size\t= %#x,\n' % fdt_obj.size_dt_struct())
+        self.out('\t.strings_size\t= %#x,\n' % fdt_obj.size_dt_strings())
+        self.out('\t.crc\t\t= %#x,\n' % (crc & 0xffffffff))
+        self.out('\t.nodes\t\t= dm_bind_nodes,\n')
+        self.out('\t.num_nodes\t= ARRAY_SIZE(dm_bind_nodes),\n')
+        self.out('\t.drivers\t= dm_bind_drivers,\n')
+        self.out('\t.phandles\t= dm_bind_phandles,\n')
+        self.out('\t.num_phandles\t= ARRAY_SIZE(dm_bind_phandles),\n')
+        self.out('};\n')
+
+
+def run_steps(args, dtb_file, include_disabled, output, scan_dir=None):
     """Run all the steps of the dtoc tool
 
     Args:
@@ -554,9 +822,11 @@ def run_steps(args, dtb_file, include_disabled, output):
         dtb_file: Filename of dtb file to process
         include_disabled: True to include disabled nodes
         output: Name of output file
+        scan_dir: Top of the source tree to scan for drivers, used by the
+            'bind' command
     """
     if not args:
-        raise ValueError('Please specify a command: struct, platdata')
+        raise ValueError('Please specify a command: struct, platdata, bind')
 
     plat = DtbPlatdata(dtb_file, include_disabled)
     plat.scan_dtb()
@@ -571,6 +841,8 @@ def run_steps(args, dtb_file, include_disabled, output):
             plat.generate_structs(structs)
         elif cmd == 'platdata':
             plat.generate_tables()
+        elif cmd == 'bind':
+            plat.generate_bind(scan_drivers(scan_dir) if scan_dir else {})
         else:
-            raise ValueError("Unknown command '%s': (use: struct, platdata)" %
-                             cmd)
+            raise ValueError("Unknown command '%s': (use: struct, platdata, "
+                             "bind)" % cmd)
@@ -23,6 +23,10 @@ This tool is used in U-Boot to provide device tree data to SPL without
 increasing the code size of SPL. This supports the CONFIG_SPL_OF_PLATDATA
 options. For more information about the use of this options and tool please
 see doc/driver-model/of-plat.txt
+
+With the 'bind' command it instead produces dt-bind.c, a table which lets
+U-Boot proper bind devices without scanning the device tree. This supports
+CONFIG_OF_BIND_TABLE and needs the source tree (-s) to find the drivers.
 """
 
 from optparse import OptionParser
@@ -89,6 +93,8 @@ parser.add_option('--include-disabled', action='store_true',
                   help='Include disabled nodes')
 parser.add_option('-o', '--output', action='store', default='-',
                   help='Select output filename')
+parser.add_option('-s', '--scan-dir', action='store',
+                  help='Source tree to scan for drivers (bind command)')
 parser.add_option('-P', '--processes', type=int,
                   help='set number of processes to use for running tests')
 parser.add_option('-t', '--test', action='store_true', dest='test',
@@ -106,4 +112,4 @@ elif options.test_coverage:
 
 else:
     dtb_platdata.run_steps(args, options.dtb_file, options.include_disabled,
-                           options.output)
+                           options.output, options.scan_dir)
@@ -12,6 +12,7 @@ import collections
 import os
 import struct
 import unittest
+import zlib
 
 import dtb_platdata
 from dtb_platdata import conv_name_to_c
@@ -687,6 +688,68 @@ U_BOOT_DEVICE(spl_test2) = {
 
 ''', data)
 
+    def test_scan_driver_source(self):
+        """Test finding drivers and their compatible strings in C source"""
+        data = '''
+static const struct udevice_id test_ids[] = {
+	{ .compatible = "test1" },
+	{ .compatible = "test2", .data = 2 },
+	{ }
+};
+
+U_BOOT_DRIVER(test_drv) = {
+	.name	= "test_drv",
+	.of_match = of_match_ptr(test_ids),
+};
+
+U_BOOT_DRIVER(no_match) = {
+	.name	= "no_match",
+};
+'''
+        compat_drivers = {}
+        dtb_platdata.scan_driver_source(data, compat_drivers)
+        self.assertEqual({'test1': set(['test_drv']),
+                          'test2': set(['test_drv'])}, compat_drivers)
+
+    def test_bind(self):
+        """Test output of the table for binding devices"""
+        dtb_file = get_dtb_file('dtoc_test_addr32.dts')
+        output = tools.GetOutputFilename('output')
+        scan_dir = tools.GetOutputFilename('src')
+        os.mkdir(scan_dir)
+        tools.WriteFile(os.path.join(scan_dir, 'drv.c'), '''
+static const struct udevice_id test_ids[] = {
+	{ .compatible = "test1" },
+	{ }
+};
+
+U_BOOT_DRIVER(test_drv) = {
+	.of_match = test_ids,
+};
+''')
+        dtb_platdata.run_steps(['bind'], dtb_file, False, output, scan_dir)
+        with open(output) as infile:
+            data = infile.read()
+        self.assertIn('DM_BIND_DRIVER_DECL(test_drv);\n', data)
+        self.assertIn('\t{DM_BIND_DRIVER(test_drv), "test1", 0},\n', data)
+        self.assertIn('\t/* 0: / */\n'
+                      '\t{0x0, FDT_ADDR_T_NONE, 1, -1, 0, 0, 0},', data)
+        self.assertIn('\t/* 1: /test1 */\n', data)
+        self.assertIn(', (fdt_addr_t)0x1234, -1, 2, 0, 1, DM_BIND_PRE_RELOC},',
+                      data)
+        self.assertIn(', (fdt_addr_t)0x12345678, -1, -1, 1, 0, '
+                      'DM_BIND_PRE_RELOC},', data)
+        self.assertIn('\t.num_nodes\t= ARRAY_SIZE(dm_bind_nodes),\n', data)
+
+        # The CRC covers the structure and strings blocks of the tree
+        fdt_obj = fdt.FdtScan(dtb_file).GetFdtObj()
+        blob = fdt_obj.as_bytearray()
+        start = fdt_obj.off_dt_struct()
+        crc = zlib.crc32(blob[start:start + fdt_obj.size_dt_struct()])
+        start = fdt_obj.off_dt_strings()
+        crc = zlib.crc32(blob[start:start + fdt_obj.size_dt_strings()], crc)
+        self.assertIn('\t.crc\t\t= %#x,\n' % (crc & 0xffffffff), data)
+
     def testStdout(self):
         """Test output to stdout"""
         dtb_file = get_dtb_file('dtoc_test_simple.dts')
@@ -697,7 +760,7 @@ U_BOOT_DEVICE(spl_test2) = {
         """Test running dtoc without a command"""
         with self.assertRaises(ValueError) as e:
             dtb_platdata.run_steps([], '', False, '')
-        self.assertIn("Please specify a command: struct, platdata",
+        self.assertIn("Please specify a command: struct, platdata, bind",
                       str(e.exception))
 
     def testBadCommand(self):
@@ -706,5 +769,5 @@ U_BOOT_DEVICE(spl_test2) = {
         output = tools.GetOutputFilename('output')
         with self.assertRaises(ValueError) as e:
             dtb_platdata.run_steps(['invalid-cmd'], dtb_file, False, output)
-        self.assertIn("Unknown command 'invalid-cmd': (use: struct, platdata)",
-                      str(e.exception))
+        self.assertIn("Unknown command 'invalid-cmd': (use: struct, platdata, "
+                      "bind)", str(e.exception))